@@ -0,0 +1,189 @@
+/*
+ * Copyright (c) 2024 The ZMK Contributors
+ *
+ * SPDX-License-Identifier: MIT
+ */
+
+#include <stdlib.h>
+
+#include <zephyr/device.h>
+#include <zephyr/init.h>
+#include <zephyr/kernel.h>
+#include <zephyr/sys/printk.h>
+#include <zephyr/sys/util.h>
+
+#include <dt-bindings/zmk/keys.h>
+#include <zmk/behavior_queue.h>
+#include <zmk/benchmark.h>
+#include <zmk/event_manager.h>
+#include <zmk/events/keycode_state_changed.h>
+
+#define BENCH_ITEMS CONFIG_ZMK_BEHAVIORS_QUEUE_BENCHMARK_ITEMS
+#define BENCH_SEQUENCES CONFIG_ZMK_BEHAVIORS_QUEUE_LANES
+// Behaviors each timed sequence keeps queued, leaving room for the others.
+#define BENCH_QUEUED_PER_SEQUENCE MAX(CONFIG_ZMK_BEHAVIORS_QUEUE_SIZE / BENCH_SEQUENCES - 1, 1)
+
+enum bench_phase {
+    BENCH_PHASE_IDLE,
+    BENCH_PHASE_THROUGHPUT,
+    BENCH_PHASE_TIMING,
+    BENCH_PHASE_DONE,
+};
+
+// A press and release of one key, repeated with varying waits. Each sequence is queued from its own
+// position so it runs in its own lane.
+struct bench_sequence {
+    uint32_t queued;
+    uint32_t ran;
+    int64_t next_deadline;
+};
+
+static enum bench_phase phase;
+static uint32_t throughput_queued;
+static uint32_t throughput_ran;
+static uint64_t throughput_start_ns;
+static struct bench_sequence sequences[BENCH_SEQUENCES];
+static uint32_t timed_items;
+static uint32_t late_items;
+static int64_t max_lateness;
+static int64_t timing_start;
+
+static struct zmk_behavior_binding bench_binding(int sequence) {
+    return (struct zmk_behavior_binding){
+        .behavior_dev = DEVICE_DT_NAME(DT_NODELABEL(kp)),
+        .param1 = A + sequence,
+    };
+}
+
+static uint32_t bench_wait(uint32_t item) { return 1 + item % 3; }
+
+static int bench_queue(int sequence, bool press, uint32_t wait) {
+    const struct zmk_behavior_binding_event event = {.position = sequence,
+                                                     .timestamp = k_uptime_get()};
+
+    return zmk_behavior_queue_add(&event, bench_binding(sequence), press, wait);
+}
+
+static void bench_queue_throughput(void) {
+    if (throughput_queued == BENCH_ITEMS) {
+        return;
+    }
+
+    if (bench_queue(0, throughput_queued++ % 2 == 0, 0) < 0) {
+        printk("benchmark: behavior queue full\n");
+        exit(1);
+    }
+}
+
+static void bench_queue_timed(int sequence) {
+    struct bench_sequence *seq = &sequences[sequence];
+
+    if (seq->queued == BENCH_ITEMS / BENCH_SEQUENCES) {
+        return;
+    }
+
+    const uint32_t item = seq->queued++;
+    if (bench_queue(sequence, item % 2 == 0, bench_wait(item)) < 0) {
+        printk("benchmark: behavior queue full\n");
+        exit(1);
+    }
+}
+
+static void bench_finish(void) {
+    printk("benchmark: %u timed behaviors in %u lanes over %u ms, %u late, max %u ms late\n",
+           timed_items, BENCH_SEQUENCES, (uint32_t)(k_uptime_get() - timing_start), late_items,
+           (uint32_t)max_lateness);
+
+    exit(0);
+}
+
+static struct k_work bench_work;
+
+static void bench_throughput_ran(void) {
+    if (++throughput_ran < BENCH_ITEMS) {
+        // Keep the queue topped up from the lane's own loop.
+        bench_queue_throughput();
+        return;
+    }
+
+    const uint64_t elapsed_ns = zmk_benchmark_host_ns() - throughput_start_ns;
+
+    printk("benchmark: %u queued behaviors in %u us, %u ns each, %u behaviors/s\n", BENCH_ITEMS,
+           (uint32_t)(elapsed_ns / NSEC_PER_USEC), (uint32_t)(elapsed_ns / BENCH_ITEMS),
+           (uint32_t)((uint64_t)BENCH_ITEMS * NSEC_PER_SEC / elapsed_ns));
+
+    // Start the timed sequences once the lane has finished running.
+    k_work_submit(&bench_work);
+}
+
+static int bench_listener_cb(const zmk_event_t *eh) {
+    const struct zmk_keycode_state_changed *ev = as_zmk_keycode_state_changed(eh);
+    const int sequence = ev->keycode - ZMK_HID_USAGE_ID(A);
+
+    if (phase == BENCH_PHASE_THROUGHPUT && sequence == 0 && throughput_ran < BENCH_ITEMS) {
+        bench_throughput_ran();
+        return ZMK_EV_EVENT_BUBBLE;
+    }
+
+    if (phase != BENCH_PHASE_TIMING || sequence < 0 || sequence >= BENCH_SEQUENCES) {
+        return ZMK_EV_EVENT_BUBBLE;
+    }
+
+    struct bench_sequence *seq = &sequences[sequence];
+    const int64_t lateness = k_uptime_get() - seq->next_deadline;
+
+    if (lateness > 0) {
+        late_items++;
+        max_lateness = MAX(max_lateness, lateness);
+    }
+
+    seq->next_deadline += bench_wait(seq->ran++);
+    timed_items++;
+
+    bench_queue_timed(sequence);
+
+    if (timed_items == BENCH_ITEMS / BENCH_SEQUENCES * BENCH_SEQUENCES) {
+        phase = BENCH_PHASE_DONE;
+        bench_finish();
+    }
+
+    return ZMK_EV_EVENT_BUBBLE;
+}
+
+ZMK_LISTENER(behavior_queue_benchmark, bench_listener_cb);
+ZMK_SUBSCRIPTION(behavior_queue_benchmark, zmk_keycode_state_changed);
+
+static void bench_work_cb(struct k_work *work) {
+    if (phase == BENCH_PHASE_IDLE) {
+        // Queued behaviors run from the work queue, so this times queueing and invoking them as
+        // the listener refills the queue.
+        phase = BENCH_PHASE_THROUGHPUT;
+        throughput_start_ns = zmk_benchmark_host_ns();
+
+        for (int i = 0; i < CONFIG_ZMK_BEHAVIORS_QUEUE_SIZE; i++) {
+            bench_queue_throughput();
+        }
+        return;
+    }
+
+    phase = BENCH_PHASE_TIMING;
+    timing_start = k_uptime_get();
+
+    for (int i = 0; i < BENCH_SEQUENCES; i++) {
+        sequences[i].next_deadline = timing_start;
+    }
+
+    for (int n = 0; n < BENCH_QUEUED_PER_SEQUENCE; n++) {
+        for (int i = 0; i < BENCH_SEQUENCES; i++) {
+            bench_queue_timed(i);
+        }
+    }
+}
+
+static int behavior_queue_benchmark_init(void) {
+    k_work_init(&bench_work, bench_work_cb);
+    k_work_submit(&bench_work);
+    return 0;
+}
+
+SYS_INIT(behavior_queue_benchmark_init, APPLICATION, CONFIG_APPLICATION_INIT_PRIORITY);
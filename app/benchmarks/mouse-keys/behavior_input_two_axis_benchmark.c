@@ -0,0 +1,173 @@
+/*
+ * Copyright (c) 2024 The ZMK Contributors
+ *
+ * SPDX-License-Identifier: MIT
+ */
+
+#include <stdlib.h>
+
+#include <zephyr/init.h>
+#include <zephyr/kernel.h>
+#include <zephyr/sys/printk.h>
+#include <zephyr/sys/util.h>
+
+#include <zmk/benchmark.h>
+
+#include "behavior_input_two_axis.h"
+
+// Each profile is moved for this long, then timed over this many repeats of the same movement.
+#define BENCH_MOVE_MS 2000
+#define BENCH_REPEATS 1000
+
+struct bench_profile {
+    const char *name;
+    const struct input_two_axis_curve *curve;
+    uint16_t time_to_max_speed_ms;
+    uint8_t acceleration_exponent;
+    uint8_t trigger_period_ms;
+    int16_t speed;
+};
+
+static const struct input_two_axis_curve curve_uniform = INPUT_TWO_AXIS_CURVE_INIT(300, 0);
+static const struct input_two_axis_curve curve_linear = INPUT_TWO_AXIS_CURVE_INIT(300, 1);
+static const struct input_two_axis_curve curve_quadratic = INPUT_TWO_AXIS_CURVE_INIT(300, 2);
+static const struct input_two_axis_curve curve_cubic = INPUT_TWO_AXIS_CURVE_INIT(1000, 3);
+
+static const struct bench_profile profiles[] = {
+    {"mouse move", &curve_linear, 300, 1, 16, 600},
+    {"mouse move at 1 kHz", &curve_linear, 300, 1, 1, 600},
+    {"mouse scroll", &curve_uniform, 300, 0, 16, 10},
+    {"exponent 2 at 125 Hz", &curve_quadratic, 300, 2, 8, 600},
+    {"exponent 3 at 1 kHz", &curve_cubic, 1000, 3, 1, -1200},
+};
+
+// Written to so the timed loops aren't optimized away.
+static volatile int32_t bench_sink;
+
+// The floating point implementation the fixed point curves replaced, for comparison.
+
+#if CONFIG_MINIMAL_LIBC
+static float powf(float base, float exponent) {
+    // poor man's power implementation rounds the exponent down to the nearest integer.
+    float power = 1.0f;
+    for (; exponent >= 1.0f; exponent--) {
+        power = power * base;
+    }
+    return power;
+}
+#else
+#include <math.h>
+#endif
+
+static float float_speed(const struct bench_profile *profile, float max_speed, int64_t ms) {
+    if (ms > profile->time_to_max_speed_ms || profile->time_to_max_speed_ms == 0 ||
+        profile->acceleration_exponent == 0) {
+        return max_speed;
+    }
+
+    if (ms == 0) {
+        return 0;
+    }
+
+    float time_fraction = (float)ms / profile->time_to_max_speed_ms;
+    return max_speed * powf(time_fraction, profile->acceleration_exponent);
+}
+
+static int32_t float_move(const struct bench_profile *profile, int64_t ms, float *remainder) {
+    float move = float_speed(profile, profile->speed, ms) * profile->trigger_period_ms / 1000;
+    float new_move = move + *remainder;
+
+    *remainder = new_move - (int)new_move;
+    return (int)new_move;
+}
+
+static int32_t fixed_move(const struct bench_profile *profile, int64_t ms, int32_t *remainder) {
+    return input_two_axis_move(profile->speed, input_two_axis_curve_speed(profile->curve, ms),
+                               profile->trigger_period_ms, remainder);
+}
+
+static uint64_t bench_time_float(const struct bench_profile *profile) {
+    const uint64_t start_ns = zmk_benchmark_host_ns();
+
+    for (int r = 0; r < BENCH_REPEATS; r++) {
+        float remainder = 0;
+        int32_t position = 0;
+
+        for (int64_t ms = profile->trigger_period_ms; ms <= BENCH_MOVE_MS;
+             ms += profile->trigger_period_ms) {
+            position += float_move(profile, ms, &remainder);
+        }
+
+        bench_sink = position;
+    }
+
+    return zmk_benchmark_host_ns() - start_ns;
+}
+
+static uint64_t bench_time_fixed(const struct bench_profile *profile) {
+    const uint64_t start_ns = zmk_benchmark_host_ns();
+
+    for (int r = 0; r < BENCH_REPEATS; r++) {
+        int32_t remainder = 0;
+        int32_t position = 0;
+
+        for (int64_t ms = profile->trigger_period_ms; ms <= BENCH_MOVE_MS;
+             ms += profile->trigger_period_ms) {
+            position += fixed_move(profile, ms, &remainder);
+        }
+
+        bench_sink = position;
+    }
+
+    return zmk_benchmark_host_ns() - start_ns;
+}
+
+static void bench_profile(const struct bench_profile *profile) {
+    const uint32_t ticks = BENCH_MOVE_MS / profile->trigger_period_ms;
+    float float_remainder = 0;
+    int32_t fixed_remainder = 0;
+    int32_t float_position = 0;
+    int32_t fixed_position = 0;
+    uint32_t max_error = 0;
+    uint32_t differing_ticks = 0;
+
+    // Compare the cursor paths tick by tick.
+    for (int64_t ms = profile->trigger_period_ms; ms <= BENCH_MOVE_MS;
+         ms += profile->trigger_period_ms) {
+        float_position += float_move(profile, ms, &float_remainder);
+        fixed_position += fixed_move(profile, ms, &fixed_remainder);
+
+        const uint32_t error = abs(fixed_position - float_position);
+        if (error > 0) {
+            differing_ticks++;
+        }
+        max_error = MAX(max_error, error);
+    }
+
+    const uint64_t float_ns = bench_time_float(profile);
+    const uint64_t fixed_ns = bench_time_fixed(profile);
+    const uint64_t tick_count = (uint64_t)ticks * BENCH_REPEATS;
+
+    printk("benchmark: %s: %u ticks, float %u ns/tick, fixed point %u ns/tick\n", profile->name,
+           ticks, (uint32_t)(float_ns / tick_count), (uint32_t)(fixed_ns / tick_count));
+    printk("benchmark: %s: moved %d px, float moved %d px, paths differ by up to %u px on %u "
+           "ticks\n",
+           profile->name, fixed_position, float_position, max_error, differing_ticks);
+}
+
+static void bench_work_cb(struct k_work *work) {
+    for (int i = 0; i < ARRAY_SIZE(profiles); i++) {
+        bench_profile(&profiles[i]);
+    }
+
+    exit(0);
+}
+
+static K_WORK_DEFINE(bench_work, bench_work_cb);
+
+static int behavior_input_two_axis_benchmark_init(void) {
+    k_work_submit(&bench_work);
+    return 0;
+}
+
+SYS_INIT(behavior_input_two_axis_benchmark_init, APPLICATION, CONFIG_APPLICATION_INIT_PRIORITY);
@@ -0,0 +1,162 @@
+/*
+ * Copyright (c) 2024 The ZMK Contributors
+ *
+ * SPDX-License-Identifier: MIT
+ */
+
+#include <stdlib.h>
+#include <string.h>
+
+#include <zephyr/init.h>
+#include <zephyr/kernel.h>
+#include <zephyr/sys/printk.h>
+#include <zephyr/sys/util.h>
+
+#include <zmk/benchmark.h>
+
+#include "wired.h"
+
+#define BENCH_PINGS CONFIG_ZMK_SPLIT_WIRED_BENCHMARK_PINGS
+// Pings in flight at once while measuring throughput, kept small enough that the frames fit in the
+// receive buffers on both sides.
+#define BENCH_WINDOW 4
+#define BENCH_CONNECT_PERIOD_MS 100
+#define BENCH_CONNECT_TIMEOUT_MS 10000
+#define BENCH_PONG_TIMEOUT_MS 1000
+
+enum bench_phase {
+    BENCH_PHASE_CONNECT,
+    BENCH_PHASE_ROUND_TRIP,
+    BENCH_PHASE_PIPELINED,
+};
+
+// Sent while waiting for the peripheral, so late answers aren't counted as measured pings.
+#define BENCH_CONNECT_SEQ UINT32_MAX
+
+// Sized like a key position event, the most common frame.
+struct bench_ping {
+    uint32_t seq;
+    uint8_t padding[3];
+} __packed;
+
+static enum bench_phase phase;
+static uint32_t sent;
+static uint32_t received;
+static uint64_t phase_start_ns;
+static uint64_t ping_sent_ns;
+static uint64_t rtt_min_ns = UINT64_MAX;
+static uint64_t rtt_max_ns;
+static uint64_t rtt_total_ns;
+static int64_t connect_deadline;
+
+static void bench_timeout_work_cb(struct k_work *work);
+
+static K_WORK_DELAYABLE_DEFINE(bench_timeout_work, bench_timeout_work_cb);
+
+static void bench_send_ping(uint32_t seq) {
+    struct bench_ping ping = {.seq = seq};
+
+    ping_sent_ns = zmk_benchmark_host_ns();
+    zmk_split_wired_send(ZMK_SPLIT_WIRED_FRAME_KIND_PING, &ping, sizeof(ping));
+}
+
+static void bench_finish(void) {
+    const uint64_t elapsed_ns = zmk_benchmark_host_ns() - phase_start_ns;
+    // Each ping and pong is a start byte, header, payload and CRC.
+    const uint32_t frame_len = 1 + sizeof(struct zmk_split_wired_frame_header) +
+                               sizeof(struct bench_ping) + sizeof(uint16_t);
+
+    printk("benchmark: %u round trips, min %u us, avg %u us, max %u us\n", BENCH_PINGS,
+           (uint32_t)(rtt_min_ns / NSEC_PER_USEC),
+           (uint32_t)(rtt_total_ns / BENCH_PINGS / NSEC_PER_USEC),
+           (uint32_t)(rtt_max_ns / NSEC_PER_USEC));
+    printk("benchmark: %u pipelined pings in %u ms, %u frames/s, %u bytes/s\n", BENCH_PINGS,
+           (uint32_t)(elapsed_ns / NSEC_PER_MSEC),
+           (uint32_t)(2ULL * BENCH_PINGS * NSEC_PER_SEC / elapsed_ns),
+           (uint32_t)(2ULL * BENCH_PINGS * frame_len * NSEC_PER_SEC / elapsed_ns));
+
+    exit(0);
+}
+
+void zmk_split_wired_benchmark_handle_pong(const uint8_t *payload, uint8_t len) {
+    const uint64_t now_ns = zmk_benchmark_host_ns();
+    struct bench_ping pong;
+
+    if (len != sizeof(pong)) {
+        return;
+    }
+
+    memcpy(&pong, payload, sizeof(pong));
+
+    if (phase != BENCH_PHASE_CONNECT && pong.seq == BENCH_CONNECT_SEQ) {
+        return;
+    }
+
+    switch (phase) {
+    case BENCH_PHASE_CONNECT:
+        phase = BENCH_PHASE_ROUND_TRIP;
+        bench_send_ping(sent++);
+        break;
+    case BENCH_PHASE_ROUND_TRIP: {
+        if (pong.seq != sent - 1) {
+            return;
+        }
+
+        const uint64_t rtt_ns = now_ns - ping_sent_ns;
+        rtt_min_ns = MIN(rtt_min_ns, rtt_ns);
+        rtt_max_ns = MAX(rtt_max_ns, rtt_ns);
+        rtt_total_ns += rtt_ns;
+
+        if (sent < BENCH_PINGS) {
+            bench_send_ping(sent++);
+            break;
+        }
+
+        phase = BENCH_PHASE_PIPELINED;
+        sent = 0;
+        received = 0;
+        phase_start_ns = zmk_benchmark_host_ns();
+        while (sent < BENCH_WINDOW) {
+            bench_send_ping(sent++);
+        }
+        break;
+    }
+    case BENCH_PHASE_PIPELINED:
+        if (++received == BENCH_PINGS) {
+            bench_finish();
+        }
+
+        if (sent < BENCH_PINGS) {
+            bench_send_ping(sent++);
+        }
+        break;
+    }
+
+    k_work_reschedule(&bench_timeout_work, K_MSEC(BENCH_PONG_TIMEOUT_MS));
+}
+
+static void bench_timeout_work_cb(struct k_work *work) {
+    if (phase != BENCH_PHASE_CONNECT) {
+        printk("benchmark: timed out waiting for pong %u\n", phase == BENCH_PHASE_PIPELINED
+                                                                  ? received
+                                                                  : sent - 1);
+        exit(1);
+    }
+
+    if (k_uptime_get() > connect_deadline) {
+        printk("benchmark: peripheral did not answer\n");
+        exit(1);
+    }
+
+    // Keep pinging until the peripheral is up and linked to this UART.
+    bench_send_ping(BENCH_CONNECT_SEQ);
+    k_work_reschedule(&bench_timeout_work, K_MSEC(BENCH_CONNECT_PERIOD_MS));
+}
+
+static int split_wired_benchmark_init(void) {
+    connect_deadline = k_uptime_get() + BENCH_CONNECT_TIMEOUT_MS;
+    k_work_reschedule(&bench_timeout_work, K_NO_WAIT);
+    return 0;
+}
+
+SYS_INIT(split_wired_benchmark_init, APPLICATION, CONFIG_APPLICATION_INIT_PRIORITY);
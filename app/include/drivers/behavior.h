@@ -248,7 +248,7 @@ __syscall int behavior_keymap_binding_convert_central_state_dependent_params(
 
 static inline int z_impl_behavior_keymap_binding_convert_central_state_dependent_params(
     struct zmk_behavior_binding *binding, struct zmk_behavior_binding_event event) {
-    const struct device *dev = zmk_behavior_get_binding(binding->behavior_dev);
+    const struct device *dev = zmk_behavior_get_binding_device(binding);
     const struct behavior_driver_api *api = (const struct behavior_driver_api *)dev->api;
 
     if (api->binding_convert_central_state_dependent_params == NULL) {
@@ -328,7 +328,7 @@ __syscall int behavior_keymap_binding_pressed(struct zmk_behavior_binding *bindi
 
 static inline int z_impl_behavior_keymap_binding_pressed(struct zmk_behavior_binding *binding,
                                                          struct zmk_behavior_binding_event event) {
-    const struct device *dev = zmk_behavior_get_binding(binding->behavior_dev);
+    const struct device *dev = zmk_behavior_get_binding_device(binding);
 
     if (dev == NULL) {
         return -EINVAL;
@@ -356,7 +356,7 @@ __syscall int behavior_keymap_binding_released(struct zmk_behavior_binding *bind
 
 static inline int z_impl_behavior_keymap_binding_released(struct zmk_behavior_binding *binding,
                                                           struct zmk_behavior_binding_event event) {
-    const struct device *dev = zmk_behavior_get_binding(binding->behavior_dev);
+    const struct device *dev = zmk_behavior_get_binding_device(binding);
 
     if (dev == NULL) {
         return -EINVAL;
@@ -390,7 +390,7 @@ static inline int z_impl_behavior_sensor_keymap_binding_accept_data(
     struct zmk_behavior_binding *binding, struct zmk_behavior_binding_event event,
     const struct zmk_sensor_config *sensor_config, size_t channel_data_size,
     const struct zmk_sensor_channel_data *channel_data) {
-    const struct device *dev = zmk_behavior_get_binding(binding->behavior_dev);
+    const struct device *dev = zmk_behavior_get_binding_device(binding);
 
     if (dev == NULL) {
         return -EINVAL;
@@ -426,7 +426,7 @@ static inline int
 z_impl_behavior_sensor_keymap_binding_process(struct zmk_behavior_binding *binding,
                                               struct zmk_behavior_binding_event event,
                                               enum behavior_sensor_binding_process_mode mode) {
-    const struct device *dev = zmk_behavior_get_binding(binding->behavior_dev);
+    const struct device *dev = zmk_behavior_get_binding_device(binding);
 
     if (dev == NULL) {
         return -EINVAL;
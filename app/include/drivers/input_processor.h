@@ -40,14 +40,83 @@ struct zmk_input_processor_state {
     int16_t *remainder;
 };
 
+/**
+ * Relative movement axes that listeners collect into a frame between sync events, so processors
+ * can handle them together instead of one event at a time.
+ */
+enum zmk_input_frame_axis {
+    ZMK_INPUT_FRAME_X,
+    ZMK_INPUT_FRAME_Y,
+    ZMK_INPUT_FRAME_WHEEL,
+    ZMK_INPUT_FRAME_HWHEEL,
+    ZMK_INPUT_FRAME_AXES,
+};
+
+/**
+ * The frame axis for an INPUT_EV_REL code, or -1 if the code isn't collected into frames. Usable
+ * in constant expressions, so processors can work out which axes they handle at build time.
+ */
+#define ZMK_INPUT_FRAME_AXIS_FOR_REL(code)                                                         \
+    ((code) == INPUT_REL_X        ? ZMK_INPUT_FRAME_X                                              \
+     : (code) == INPUT_REL_Y      ? ZMK_INPUT_FRAME_Y                                              \
+     : (code) == INPUT_REL_WHEEL  ? ZMK_INPUT_FRAME_WHEEL                                          \
+     : (code) == INPUT_REL_HWHEEL ? ZMK_INPUT_FRAME_HWHEEL                                         \
+                                  : -1)
+
+/**
+ * Bit for the frame axis of an INPUT_EV_REL code in a frame axis mask, or 0 if the code isn't
+ * collected into frames.
+ */
+#define ZMK_INPUT_FRAME_AXIS_BIT_FOR_REL(code)                                                     \
+    (ZMK_INPUT_FRAME_AXIS_FOR_REL(code) >= 0 ? BIT(ZMK_INPUT_FRAME_AXIS_FOR_REL(code)) : 0)
+
+static inline int zmk_input_frame_axis(uint8_t type, uint16_t code) {
+    return type == INPUT_EV_REL ? ZMK_INPUT_FRAME_AXIS_FOR_REL(code) : -1;
+}
+
+static inline uint16_t zmk_input_frame_axis_code(enum zmk_input_frame_axis axis) {
+    static const uint16_t codes[ZMK_INPUT_FRAME_AXES] = {
+        [ZMK_INPUT_FRAME_X] = INPUT_REL_X,
+        [ZMK_INPUT_FRAME_Y] = INPUT_REL_Y,
+        [ZMK_INPUT_FRAME_WHEEL] = INPUT_REL_WHEEL,
+        [ZMK_INPUT_FRAME_HWHEEL] = INPUT_REL_HWHEEL,
+    };
+
+    return codes[axis];
+}
+
+/**
+ * The relative movement reported by an input device between two sync events.
+ */
+struct zmk_input_processor_frame {
+    int32_t values[ZMK_INPUT_FRAME_AXES];
+    // Mask of the axes with an event in this frame. An axis can be present with a value of 0.
+    uint8_t axes;
+};
+
+struct zmk_input_processor_frame_state {
+    uint8_t input_device_index;
+    // Remainders indexed by frame axis, or NULL if the processor doesn't track remainders.
+    int16_t *remainders;
+};
+
 // TODO: Need the ability to store remainders? Some data passed in?
 typedef int (*zmk_input_processor_handle_event_callback_t)(const struct device *dev,
                                                            struct input_event *event,
                                                            uint32_t param1, uint32_t param2,
                                                            struct zmk_input_processor_state *state);
 
+/**
+ * Optional callback to process a whole frame at once. Processors that need to see each event, or
+ * that can't handle a particular frame, return -ENOTSUP and get one event per axis instead.
+ */
+typedef int (*zmk_input_processor_handle_frame_callback_t)(
+    const struct device *dev, struct zmk_input_processor_frame *frame, uint32_t param1,
+    uint32_t param2, struct zmk_input_processor_frame_state *state);
+
 __subsystem struct zmk_input_processor_driver_api {
     zmk_input_processor_handle_event_callback_t handle_event;
+    zmk_input_processor_handle_frame_callback_t handle_frame;
 };
 
 __syscall int zmk_input_processor_handle_event(const struct device *dev, struct input_event *event,
@@ -68,4 +137,24 @@ static inline int z_impl_zmk_input_processor_handle_event(const struct device *d
     return api->handle_event(dev, event, param1, param2, state);
 }
 
+__syscall int zmk_input_processor_handle_frame(const struct device *dev,
+                                               struct zmk_input_processor_frame *frame,
+                                               uint32_t param1, uint32_t param2,
+                                               struct zmk_input_processor_frame_state *state);
+
+static inline int
+z_impl_zmk_input_processor_handle_frame(const struct device *dev,
+                                        struct zmk_input_processor_frame *frame, uint32_t param1,
+                                        uint32_t param2,
+                                        struct zmk_input_processor_frame_state *state) {
+    const struct zmk_input_processor_driver_api *api =
+        (const struct zmk_input_processor_driver_api *)dev->api;
+
+    if (api->handle_frame == NULL) {
+        return -ENOTSUP;
+    }
+
+    return api->handle_frame(dev, frame, param1, param2, state);
+}
+
 #include <syscalls/input_processor.h>
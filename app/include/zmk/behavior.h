@@ -20,8 +20,20 @@ struct zmk_behavior_binding {
     const char *behavior_dev;
     uint32_t param1;
     uint32_t param2;
+#if IS_ENABLED(CONFIG_ZMK_BEHAVIOR_DEVICES_IN_BINDINGS)
+    const struct device *device;
+#endif // IS_ENABLED(CONFIG_ZMK_BEHAVIOR_DEVICES_IN_BINDINGS)
 };
 
+/**
+ * @brief Initialize the device of a binding to the behavior @p node_id at build time.
+ *
+ * Expands to nothing unless CONFIG_ZMK_BEHAVIOR_DEVICES_IN_BINDINGS is enabled.
+ */
+#define ZMK_BEHAVIOR_BINDING_DEVICE_INIT(node_id)                                                  \
+    IF_ENABLED(CONFIG_ZMK_BEHAVIOR_DEVICES_IN_BINDINGS,                                            \
+               (.device = DEVICE_DT_GET_OR_NULL(node_id), ))
+
 struct zmk_behavior_binding_event {
     int layer;
     uint32_t position;
@@ -45,6 +57,32 @@ struct zmk_behavior_binding_event {
  */
 const struct device *zmk_behavior_get_binding(const char *name);
 
+/**
+ * @brief Get a const struct device* for the behavior referenced by a @p binding.
+ *
+ * @param binding Behavior binding to get the device for.
+ *
+ * @retval Pointer to the device structure for the binding's behavior.
+ * @retval NULL if the behavior is not found or its initialization function failed.
+ *
+ * @note If the binding's device was set at build time with ZMK_BEHAVIOR_BINDING_DEVICE_INIT() or
+ * resolved with zmk_behavior_resolve_binding(), this returns the stored device without searching
+ * for the behavior by name.
+ */
+const struct device *zmk_behavior_get_binding_device(const struct zmk_behavior_binding *binding);
+
+/**
+ * @brief Look up the behavior device for a @p binding by name and store it in the binding.
+ *
+ * This must be called again whenever the binding's @p behavior_dev field changes.
+ *
+ * @param binding Behavior binding to resolve.
+ *
+ * @retval 0 If successful.
+ * @retval -ENODEV if the behavior is not found or its initialization function failed.
+ */
+int zmk_behavior_resolve_binding(struct zmk_behavior_binding *binding);
+
 /**
  * @brief Invoke a behavior given its binding and invoking event details.
  *
@@ -77,3 +115,13 @@ zmk_behavior_local_id_t zmk_behavior_get_local_id(const char *name);
  * @retval NULL if the behavior is not found or its initialization function failed.
  */
 const char *zmk_behavior_find_behavior_name_from_local_id(zmk_behavior_local_id_t local_id);
+
+/**
+ * @brief Get the behavior device for a behavior from its @p local_id .
+ *
+ * @param local_id Behavior local ID used to search for the behavior
+ *
+ * @retval The behavior device that is associated with that local ID.
+ * @retval NULL if the behavior is not found or its initialization function failed.
+ */
+const struct device *zmk_behavior_get_device_from_local_id(zmk_behavior_local_id_t local_id);
@@ -10,5 +10,62 @@
 #include <stdint.h>
 #include <zmk/behavior.h>
 
+/**
+ * @brief Queue a behavior to be pressed or released after the behaviors queued before it from the
+ * same position. Queued behaviors are always invoked from the system work queue.
+ *
+ * @param event The event that caused the behavior to be queued.
+ * @param behavior The binding to invoke.
+ * @param press Whether to press or release the binding.
+ * @param wait Milliseconds to wait after invoking the binding before the next queued behavior.
+ *
+ * @retval 0 if the behavior was queued.
+ * @retval -ENOMEM if the queue is full.
+ */
 int zmk_behavior_queue_add(const struct zmk_behavior_binding_event *event,
                            const struct zmk_behavior_binding behavior, bool press, uint32_t wait);
+
+/**
+ * @brief Get one step of a sequence queued with zmk_behavior_queue_add_sequence().
+ *
+ * Called with the queue locked, so it must only look up the step and not block or queue behaviors.
+ *
+ * @param sequence The sequence passed to zmk_behavior_queue_add_sequence().
+ * @param index Index of the step.
+ * @param params The binding passed to zmk_behavior_queue_add_sequence(), with the parameters the
+ * step may use.
+ * @param binding Set to the binding to invoke.
+ * @param press Set to whether to press or release the binding.
+ *
+ * @return Milliseconds to wait after invoking the binding before the next step.
+ */
+typedef uint32_t (*zmk_behavior_queue_step_cb)(const void *sequence, uint16_t index,
+                                               const struct zmk_behavior_binding *params,
+                                               struct zmk_behavior_binding *binding, bool *press);
+
+/**
+ * @brief Queue a sequence of behaviors to be invoked after the behaviors queued before it from the
+ * same position.
+ *
+ * The whole sequence takes a single entry in the queue. Each step is only looked up with @p step
+ * once the step before it has run, so @p sequence must stay valid until the sequence is done.
+ *
+ * @param event The event that caused the sequence to be queued.
+ * @param step Callback to get each step of the sequence.
+ * @param sequence Pointer passed to @p step.
+ * @param count Number of steps in the sequence.
+ * @param params Binding passed to @p step, with the parameters the steps may use.
+ *
+ * @retval 0 if the sequence was queued.
+ * @retval -ENOMEM if the queue is full.
+ */
+int zmk_behavior_queue_add_sequence(const struct zmk_behavior_binding_event *event,
+                                    zmk_behavior_queue_step_cb step, const void *sequence,
+                                    uint16_t count, const struct zmk_behavior_binding params);
+
+/**
+ * @brief Get the number of behaviors that can be queued before the queue is full.
+ *
+ * Behaviors that queue a sequence should check this first, so they don't queue only part of it.
+ */
+uint32_t zmk_behavior_queue_free_count(void);
@@ -68,8 +68,43 @@ int zmk_endpoints_toggle_transport(void);
  */
 struct zmk_endpoint_instance zmk_endpoints_selected(void);
 
+/**
+ * Sends the current keyboard or consumer report to the selected endpoint. Inside a report
+ * transaction, the report may be held back and merged with later ones, as long as the host can't
+ * tell the difference.
+ */
 int zmk_endpoints_send_report(uint16_t usage_page);
 
+#if IS_ENABLED(CONFIG_ZMK_ENDPOINTS_REPORT_TRANSACTIONS)
+
+/**
+ * Starts a report transaction on the current thread. Transactions may be nested, and any reports
+ * held back are sent when the outermost transaction ends.
+ */
+void zmk_endpoints_report_transaction_begin(void);
+
+/**
+ * Ends a report transaction started by zmk_endpoints_report_transaction_begin(). Ending the
+ * outermost transaction sends any report held back by it.
+ *
+ * @return 0 on success, or the error from sending the held back report.
+ */
+int zmk_endpoints_report_transaction_end(void);
+
+/**
+ * Sends any report held back by the current transaction, so the host sees the state before the
+ * next change as a separate report.
+ */
+int zmk_endpoints_report_barrier(void);
+
+#else
+
+static inline void zmk_endpoints_report_transaction_begin(void) {}
+static inline int zmk_endpoints_report_transaction_end(void) { return 0; }
+static inline int zmk_endpoints_report_barrier(void) { return 0; }
+
+#endif // IS_ENABLED(CONFIG_ZMK_ENDPOINTS_REPORT_TRANSACTIONS)
+
 #if IS_ENABLED(CONFIG_ZMK_POINTING)
 int zmk_endpoints_send_mouse_report();
 #endif // IS_ENABLED(CONFIG_ZMK_POINTING)
@@ -0,0 +1,105 @@
+/*
+ * Copyright (c) 2024 The ZMK Contributors
+ *
+ * SPDX-License-Identifier: MIT
+ */
+
+#pragma once
+
+#include <zephyr/kernel.h>
+#include <zephyr/sys/slist.h>
+
+#include <zmk/event_manager.h>
+#include <zmk/events/keycode_state_changed.h>
+#include <zmk/events/position_state_changed.h>
+
+/**
+ * Storage for one captured event. Add an event type here to allow capturing it.
+ */
+union zmk_event_capture_payload {
+    zmk_event_t header;
+    struct zmk_position_state_changed_event position;
+    struct zmk_keycode_state_changed_event keycode;
+};
+
+struct zmk_event_capture_slot {
+    sys_snode_t node;
+    union zmk_event_capture_payload event;
+};
+
+/**
+ * Events captured by a listener, in the order they were captured. The events are held in a pool
+ * shared by every capture, so a capture only uses memory while it holds events.
+ */
+struct zmk_event_capture {
+    // Events captured since the last call to zmk_event_capture_begin_release().
+    sys_slist_t events;
+    // Events waiting to be raised again.
+    sys_slist_t releasing;
+    // Number of events in both lists.
+    uint16_t count;
+    // Maximum number of events this capture may hold at once.
+    uint16_t limit;
+    // Most events held at once, for tuning the limit and pool size.
+    uint16_t high_water;
+    // Number of events that couldn't be captured because the capture or pool was full.
+    uint32_t overflows;
+};
+
+#define ZMK_EVENT_CAPTURE_DEFINE(name, max_events)                                                 \
+    struct zmk_event_capture name = {                                                              \
+        .events = SYS_SLIST_STATIC_INIT(&name.events),                                             \
+        .releasing = SYS_SLIST_STATIC_INIT(&name.releasing),                                       \
+        .limit = max_events,                                                                       \
+    }
+
+/**
+ * Iterate over the events captured since the last release began, oldest first.
+ *
+ * @param capture The capture to iterate over.
+ * @param slot A `struct zmk_event_capture_slot *` set to each slot in turn. The event is in
+ *             `slot->event.header`.
+ */
+#define ZMK_EVENT_CAPTURE_FOR_EACH(capture, slot)                                                  \
+    SYS_SLIST_FOR_EACH_CONTAINER(&(capture)->events, slot, node)
+
+/**
+ * @brief Copy an event into a capture, to be raised again later.
+ *
+ * Must be called from the listener that captures the event, which then returns
+ * ZMK_EV_EVENT_CAPTURED.
+ *
+ * @retval 0 if the event was captured.
+ * @retval -ENOMEM if the capture or the shared pool is full.
+ * @retval -EINVAL if the event is too large to capture.
+ */
+int zmk_event_capture_add(struct zmk_event_capture *capture, const zmk_event_t *event);
+
+/**
+ * @brief Queue the captured events to be raised again by zmk_event_capture_release_next().
+ *
+ * The events go ahead of any events still waiting from an earlier release. Those were captured
+ * later, if the events being queued now were captured again while an earlier release raised them.
+ */
+void zmk_event_capture_begin_release(struct zmk_event_capture *capture);
+
+/**
+ * @brief Raise the next event waiting to be released, starting with the listener that captured it.
+ *
+ * @retval -ENOENT if no events are waiting to be released.
+ * @return The result of raising the event otherwise.
+ */
+int zmk_event_capture_release_next(struct zmk_event_capture *capture);
+
+/**
+ * @brief Raise every captured event again, in order.
+ */
+void zmk_event_capture_release(struct zmk_event_capture *capture);
+
+static inline bool zmk_event_capture_is_releasing(const struct zmk_event_capture *capture) {
+    return !sys_slist_is_empty(&capture->releasing);
+}
+
+static inline uint16_t zmk_event_capture_count(const struct zmk_event_capture *capture) {
+    return capture->count;
+}
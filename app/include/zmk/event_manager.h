@@ -10,8 +10,14 @@
 #include <zephyr/kernel.h>
 #include <zephyr/types.h>
 
+struct zmk_event_subscription;
+
 struct zmk_event_type {
     const char *name;
+    // Size of the raised event, including its header.
+    size_t size;
+    const struct zmk_event_subscription *subscriptions_start;
+    const struct zmk_event_subscription *subscriptions_end;
 };
 
 typedef struct {
@@ -26,6 +32,12 @@ typedef struct {
 typedef int (*zmk_listener_callback_t)(const zmk_event_t *eh);
 struct zmk_listener {
     zmk_listener_callback_t callback;
+    // The listener's own subscriptions, one for each event type it is subscribed to.
+    const struct zmk_event_subscription *const *subscriptions_start;
+    const struct zmk_event_subscription *const *subscriptions_end;
+#if IS_ENABLED(CONFIG_ZMK_LATENCY_TRACE)
+    const char *name;
+#endif // IS_ENABLED(CONFIG_ZMK_LATENCY_TRACE)
 };
 
 struct zmk_event_subscription {
@@ -43,8 +55,34 @@ struct zmk_event_subscription {
     struct event_type *as_##event_type(const zmk_event_t *eh);                                     \
     extern const struct zmk_event_type zmk_event_##event_type;
 
+/*
+ * Subscriptions are placed in per-event-type input sections, which the linker sorts by name so
+ * that every listener for a given event type ends up in one contiguous range, bracketed by the
+ * zero-length start/end markers emitted by ZMK_EVENT_IMPL. Link order is preserved within a range.
+ */
+#define ZMK_EVENT_SUBSCRIPTION_SECTION(event_type, part)                                           \
+    __attribute__((__section__(".event_subscription." STRINGIFY(event_type) "." part)))
+
+/*
+ * Each subscription is also listed in a per-listener range, built the same way, so raise_after and
+ * raise_at find a listener's index in an event type's range from the listener's own subscriptions.
+ */
+#define ZMK_LISTENER_SUBSCRIPTION_SECTION(mod, part)                                               \
+    __attribute__((__section__(".event_listener_subscription." STRINGIFY(mod) "." part)))
+
 #define ZMK_EVENT_IMPL(event_type)                                                                 \
-    const struct zmk_event_type zmk_event_##event_type = {.name = STRINGIFY(event_type)};          \
+    const Z_DECL_ALIGN(struct zmk_event_subscription)                                              \
+        zmk_event_subs_start_##event_type[0] __used                                                \
+        ZMK_EVENT_SUBSCRIPTION_SECTION(event_type, "0") = {};                                      \
+    const Z_DECL_ALIGN(struct zmk_event_subscription)                                              \
+        zmk_event_subs_end_##event_type[0] __used                                                  \
+        ZMK_EVENT_SUBSCRIPTION_SECTION(event_type, "2") = {};                                      \
+    const struct zmk_event_type zmk_event_##event_type = {                                         \
+        .name = STRINGIFY(event_type),                                                             \
+        .size = sizeof(struct event_type##_event),                                                 \
+        .subscriptions_start = zmk_event_subs_start_##event_type,                                  \
+        .subscriptions_end = zmk_event_subs_end_##event_type,                                      \
+    };                                                                                             \
     const struct zmk_event_type *zmk_event_ref_##event_type __used                                 \
         __attribute__((__section__(".event_type"))) = &zmk_event_##event_type;                     \
     struct event_type##_event copy_raised_##event_type(const struct event_type *ev) {              \
@@ -61,16 +99,29 @@ struct zmk_event_subscription {
                                                       : NULL;                                      \
     };
 
-#define ZMK_LISTENER(mod, cb) const struct zmk_listener zmk_listener_##mod = {.callback = cb};
+#define ZMK_LISTENER(mod, cb)                                                                      \
+    const Z_DECL_ALIGN(struct zmk_event_subscription *const)                                       \
+        zmk_listener_subs_start_##mod[0] __used ZMK_LISTENER_SUBSCRIPTION_SECTION(mod, "0") = {};  \
+    const Z_DECL_ALIGN(struct zmk_event_subscription *const)                                       \
+        zmk_listener_subs_end_##mod[0] __used ZMK_LISTENER_SUBSCRIPTION_SECTION(mod, "2") = {};    \
+    const struct zmk_listener zmk_listener_##mod = {                                               \
+        .callback = cb,                                                                            \
+        .subscriptions_start = zmk_listener_subs_start_##mod,                                      \
+        .subscriptions_end = zmk_listener_subs_end_##mod,                                          \
+        IF_ENABLED(CONFIG_ZMK_LATENCY_TRACE, (.name = STRINGIFY(mod), ))};
 
 #define ZMK_SUBSCRIPTION(mod, ev_type)                                                             \
     extern const struct zmk_listener zmk_listener_##mod;                                           \
     const Z_DECL_ALIGN(struct zmk_event_subscription)                                              \
         _CONCAT(_CONCAT(zmk_event_sub_, mod), ev_type) __used                                      \
-        __attribute__((__section__(".event_subscription"))) = {                                    \
+        ZMK_EVENT_SUBSCRIPTION_SECTION(ev_type, "1") = {                                           \
             .event_type = &zmk_event_##ev_type,                                                    \
             .listener = &zmk_listener_##mod,                                                       \
-    };
+    };                                                                                             \
+    const Z_DECL_ALIGN(struct zmk_event_subscription *const)                                       \
+        _CONCAT(_CONCAT(zmk_listener_sub_, mod), ev_type) __used                                   \
+        ZMK_LISTENER_SUBSCRIPTION_SECTION(mod, "1") =                                              \
+            &_CONCAT(_CONCAT(zmk_event_sub_, mod), ev_type);
 
 #define ZMK_EVENT_RAISE(ev) zmk_event_manager_raise(&(ev).header)
 
@@ -81,6 +132,7 @@ struct zmk_event_subscription {
 
 #define ZMK_EVENT_RELEASE(ev) zmk_event_manager_release(&(ev).header)
 
+int zmk_event_manager_handle_from(zmk_event_t *event, uint8_t start_index);
 int zmk_event_manager_raise(zmk_event_t *event);
 int zmk_event_manager_raise_after(zmk_event_t *event, const struct zmk_listener *listener);
 int zmk_event_manager_raise_at(zmk_event_t *event, const struct zmk_listener *listener);
@@ -384,6 +384,19 @@ void zmk_hid_mouse_clear(void);
 
 #endif // IS_ENABLED(CONFIG_ZMK_POINTING)
 
+/**
+ * Checks whether a report that hasn't been sent yet (pending) can be replaced by the one that
+ * follows it (next) without the host noticing. This is the case when the host would see the same
+ * presses and releases in the same order from the single report as from the two, given that it last
+ * saw prev.
+ */
+bool zmk_hid_keyboard_report_can_merge(const struct zmk_hid_keyboard_report_body *prev,
+                                       const struct zmk_hid_keyboard_report_body *pending,
+                                       const struct zmk_hid_keyboard_report_body *next);
+bool zmk_hid_consumer_report_can_merge(const struct zmk_hid_consumer_report_body *prev,
+                                       const struct zmk_hid_consumer_report_body *pending,
+                                       const struct zmk_hid_consumer_report_body *next);
+
 struct zmk_hid_keyboard_report *zmk_hid_get_keyboard_report(void);
 struct zmk_hid_consumer_report *zmk_hid_get_consumer_report(void);
 
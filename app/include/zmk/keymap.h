@@ -6,6 +6,7 @@
 
 #pragma once
 
+#include <zmk/behavior.h>
 #include <zmk/events/position_state_changed.h>
 
 #define ZMK_LAYER_CHILD_LEN_PLUS_ONE(node) 1 +
@@ -76,6 +77,7 @@ int zmk_keymap_position_state_changed(uint8_t source, uint32_t position, bool pr
 #define ZMK_KEYMAP_EXTRACT_BINDING(idx, drv_inst)                                                  \
     {                                                                                              \
         .behavior_dev = DEVICE_DT_NAME(DT_PHANDLE_BY_IDX(drv_inst, bindings, idx)),                \
+        ZMK_BEHAVIOR_BINDING_DEVICE_INIT(DT_PHANDLE_BY_IDX(drv_inst, bindings, idx))               \
         .param1 = COND_CODE_0(DT_PHA_HAS_CELL_AT_IDX(drv_inst, bindings, idx, param1), (0),        \
                               (DT_PHA_BY_IDX(drv_inst, bindings, idx, param1))),                   \
         .param2 = COND_CODE_0(DT_PHA_HAS_CELL_AT_IDX(drv_inst, bindings, idx, param2), (0),        \
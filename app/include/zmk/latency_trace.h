@@ -0,0 +1,77 @@
+/*
+ * Copyright (c) 2024 The ZMK Contributors
+ *
+ * SPDX-License-Identifier: MIT
+ */
+
+#pragma once
+
+#include <zephyr/kernel.h>
+
+enum zmk_latency_trace_stage {
+    ZMK_LATENCY_TRACE_STAGE_KSCAN,
+    ZMK_LATENCY_TRACE_STAGE_KSCAN_PROCESS,
+    ZMK_LATENCY_TRACE_STAGE_LISTENER,
+    ZMK_LATENCY_TRACE_STAGE_BEHAVIOR,
+    ZMK_LATENCY_TRACE_STAGE_ENDPOINT,
+    ZMK_LATENCY_TRACE_STAGE_TRANSPORT,
+};
+
+struct zmk_latency_trace_record {
+    uint32_t id;
+    uint32_t cycles;
+    const char *label;
+    uint8_t stage;
+};
+
+#if IS_ENABLED(CONFIG_ZMK_LATENCY_TRACE)
+
+/**
+ * @brief Start tracing a new input event, recording the key scan stage for it.
+ *
+ * Safe to call from ISR context.
+ *
+ * @retval The new trace ID, to be passed to zmk_latency_trace_set_current() when the event is
+ * processed.
+ */
+uint32_t zmk_latency_trace_begin(void);
+
+/**
+ * @brief Set the trace ID that subsequent records are attributed to.
+ */
+void zmk_latency_trace_set_current(uint32_t id);
+
+/**
+ * @brief Record that the current trace reached @p stage.
+ *
+ * Safe to call from ISR context.
+ *
+ * @param stage The pipeline stage reached.
+ * @param label Static string describing the stage instance, e.g. a listener or behavior name.
+ */
+void zmk_latency_trace_record(enum zmk_latency_trace_stage stage, const char *label);
+
+/**
+ * @brief Copy the records that have not been read yet, oldest first.
+ *
+ * @param records Buffer to copy the records to.
+ * @param len Number of records that fit in @p records.
+ *
+ * @retval The number of records copied.
+ */
+size_t zmk_latency_trace_read(struct zmk_latency_trace_record *records, size_t len);
+
+#else
+
+static inline uint32_t zmk_latency_trace_begin(void) { return 0; }
+
+static inline void zmk_latency_trace_set_current(uint32_t id) {}
+
+static inline void zmk_latency_trace_record(enum zmk_latency_trace_stage stage,
+                                            const char *label) {}
+
+static inline size_t zmk_latency_trace_read(struct zmk_latency_trace_record *records, size_t len) {
+    return 0;
+}
+
+#endif // IS_ENABLED(CONFIG_ZMK_LATENCY_TRACE)
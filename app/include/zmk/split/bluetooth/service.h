@@ -31,6 +31,19 @@ struct zmk_split_run_behavior_payload {
     char behavior_dev[ZMK_SPLIT_RUN_BEHAVIOR_DEV_LEN];
 } __packed;
 
+// Runs the behavior with the given local ID on the peripheral, as listed in the peripheral's
+// behavior ID table.
+struct zmk_split_run_behavior_id_payload {
+    struct zmk_split_run_behavior_data data;
+    uint16_t behavior_id;
+} __packed;
+
+// The behavior ID table is a list of these entries, each followed by the NUL terminated name of
+// the behavior device.
+struct zmk_split_behavior_id_entry {
+    uint16_t behavior_id;
+} __packed;
+
 struct zmk_split_input_event_payload {
     uint8_t type;
     uint16_t code;
@@ -38,8 +51,35 @@ struct zmk_split_input_event_payload {
     uint8_t sync;
 } __packed;
 
-int zmk_split_bt_position_pressed(uint8_t position);
-int zmk_split_bt_position_released(uint8_t position);
+#define ZMK_SPLIT_POSITION_STATE_LEN 16
+
+struct zmk_split_position_state_payload {
+    uint8_t position_state[ZMK_SPLIT_POSITION_STATE_LEN];
+    // Peripheral uptime in milliseconds when the position state last changed.
+    uint32_t timestamp;
+} __packed;
+
+#define ZMK_SPLIT_POSITION_EDGE_PRESSED BIT(7)
+
+struct zmk_split_position_edge {
+    // Key position in the low seven bits, with ZMK_SPLIT_POSITION_EDGE_PRESSED set for a press.
+    uint8_t position_state;
+    // Milliseconds since the previous edge in the batch, saturating at UINT8_MAX.
+    uint8_t delta_ms;
+} __packed;
+
+// Sized so a full batch fits in one notification with the default ATT MTU of 23.
+#define ZMK_SPLIT_POSITION_BATCH_MAX_EDGES 8
+
+struct zmk_split_position_batch {
+    // Peripheral uptime in milliseconds when the last edge happened.
+    uint32_t timestamp;
+    // Only as many edges as fit in the notification length are sent.
+    struct zmk_split_position_edge edges[ZMK_SPLIT_POSITION_BATCH_MAX_EDGES];
+} __packed;
+
+int zmk_split_bt_position_pressed(uint8_t position, int64_t timestamp);
+int zmk_split_bt_position_released(uint8_t position, int64_t timestamp);
 int zmk_split_bt_sensor_triggered(uint8_t sensor_index,
                                   const struct zmk_sensor_channel_data channel_data[],
                                   size_t channel_data_size);
@@ -0,0 +1,27 @@
+/*
+ * Copyright (c) 2024 The ZMK Contributors
+ *
+ * SPDX-License-Identifier: MIT
+ */
+
+#pragma once
+
+#include <zmk/behavior.h>
+#include <zmk/hid_indicators_types.h>
+
+#if IS_ENABLED(CONFIG_ZMK_SPLIT_BLE)
+#define ZMK_SPLIT_CENTRAL_PERIPHERAL_COUNT CONFIG_ZMK_SPLIT_BLE_CENTRAL_PERIPHERALS
+#else
+#define ZMK_SPLIT_CENTRAL_PERIPHERAL_COUNT 1
+#endif
+
+/**
+ * @brief Run a behavior on a peripheral, using whichever split transport connects to it.
+ */
+int zmk_split_central_invoke_behavior(uint8_t source, struct zmk_behavior_binding *binding,
+                                      struct zmk_behavior_binding_event event, bool state);
+
+/**
+ * @brief Send the HID indicator state to all peripherals.
+ */
+int zmk_split_central_update_hid_indicator(zmk_hid_indicators_t indicators);
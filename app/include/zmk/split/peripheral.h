@@ -0,0 +1,15 @@
+/*
+ * Copyright (c) 2024 The ZMK Contributors
+ *
+ * SPDX-License-Identifier: MIT
+ */
+
+#pragma once
+
+#include <zephyr/types.h>
+
+/**
+ * @brief Send an input event from one of the peripheral's input splits to the central.
+ */
+int zmk_split_peripheral_report_input(uint8_t reg, uint8_t type, uint16_t code, int32_t value,
+                                      bool sync);
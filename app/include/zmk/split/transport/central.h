@@ -0,0 +1,45 @@
+/*
+ * Copyright (c) 2024 The ZMK Contributors
+ *
+ * SPDX-License-Identifier: MIT
+ */
+
+#pragma once
+
+#include <zephyr/sys/iterable_sections.h>
+
+#include <zmk/split/transport/types.h>
+
+struct zmk_split_transport_central_api {
+    /**
+     * @brief Send a command to the peripheral with the given source index.
+     *
+     * May be called from any thread, so transports should queue the command rather than block.
+     */
+    int (*send_command)(uint8_t source, struct zmk_split_transport_central_command cmd);
+};
+
+struct zmk_split_transport_central {
+    const struct zmk_split_transport_central_api *api;
+};
+
+/**
+ * @brief Register a transport the central uses to talk to its peripherals.
+ */
+#define ZMK_SPLIT_TRANSPORT_CENTRAL_REGISTER(name, _api)                                           \
+    STRUCT_SECTION_ITERABLE(zmk_split_transport_central, name) = {                                 \
+        .api = _api,                                                                               \
+    }
+
+/**
+ * @brief Handle an event received from a peripheral.
+ *
+ * Events are queued and raised from the system work queue, so this may be called from any thread.
+ *
+ * @param transport The transport the event was received on.
+ * @param source Index of the peripheral the event came from.
+ * @param ev The received event.
+ */
+int zmk_split_transport_central_peripheral_event_handler(
+    const struct zmk_split_transport_central *transport, uint8_t source,
+    struct zmk_split_transport_peripheral_event ev);
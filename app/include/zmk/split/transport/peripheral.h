@@ -0,0 +1,45 @@
+/*
+ * Copyright (c) 2024 The ZMK Contributors
+ *
+ * SPDX-License-Identifier: MIT
+ */
+
+#pragma once
+
+#include <zephyr/sys/iterable_sections.h>
+
+#include <zmk/split/transport/types.h>
+
+struct zmk_split_transport_peripheral_api {
+    /**
+     * @brief Send an event to the central.
+     *
+     * Called from the thread that raised the key position, sensor or input event.
+     */
+    int (*report_event)(const struct zmk_split_transport_peripheral_event *event);
+};
+
+struct zmk_split_transport_peripheral {
+    const struct zmk_split_transport_peripheral_api *api;
+};
+
+/**
+ * @brief Register a transport the peripheral uses to talk to the central.
+ */
+#define ZMK_SPLIT_TRANSPORT_PERIPHERAL_REGISTER(name, _api)                                        \
+    STRUCT_SECTION_ITERABLE(zmk_split_transport_peripheral, name) = {                              \
+        .api = _api,                                                                               \
+    }
+
+/**
+ * @brief Handle a command received from the central.
+ *
+ * Commands are run immediately, so this must be called from a thread that can raise events and
+ * invoke behaviors, such as the system work queue.
+ *
+ * @param transport The transport the command was received on.
+ * @param cmd The received command.
+ */
+int zmk_split_transport_peripheral_command_handler(
+    const struct zmk_split_transport_peripheral *transport,
+    struct zmk_split_transport_central_command cmd);
@@ -0,0 +1,80 @@
+/*
+ * Copyright (c) 2024 The ZMK Contributors
+ *
+ * SPDX-License-Identifier: MIT
+ */
+
+#pragma once
+
+#include <zephyr/types.h>
+
+#include <zmk/events/sensor_event.h>
+#include <zmk/hid_indicators_types.h>
+#include <zmk/sensors.h>
+
+#define ZMK_SPLIT_TRANSPORT_BEHAVIOR_DEV_LEN 9
+
+enum zmk_split_transport_peripheral_event_type {
+    ZMK_SPLIT_TRANSPORT_PERIPHERAL_EVENT_TYPE_KEY_POSITION_EVENT,
+    ZMK_SPLIT_TRANSPORT_PERIPHERAL_EVENT_TYPE_SENSOR_EVENT,
+    ZMK_SPLIT_TRANSPORT_PERIPHERAL_EVENT_TYPE_INPUT_EVENT,
+};
+
+// Events are packed so transports that send them as raw bytes get the same layout on both halves.
+struct zmk_split_transport_peripheral_event {
+    // One of enum zmk_split_transport_peripheral_event_type.
+    uint8_t type;
+
+    union {
+        struct {
+            uint8_t position;
+            uint8_t pressed;
+            // Peripheral uptime in milliseconds when the position changed, for transports that
+            // track the peripheral clock. Other transports timestamp the event when it arrives.
+            uint32_t timestamp;
+        } __packed key_position_event;
+
+        struct {
+            uint8_t sensor_index;
+            uint8_t channel_data_size;
+            struct zmk_sensor_channel_data channel_data[ZMK_SENSOR_EVENT_MAX_CHANNELS];
+        } __packed sensor_event;
+
+        struct {
+            uint8_t reg;
+            uint8_t type;
+            uint16_t code;
+            int32_t value;
+            uint8_t sync;
+        } __packed input_event;
+    } data;
+} __packed;
+
+enum zmk_split_transport_central_command_type {
+    ZMK_SPLIT_TRANSPORT_CENTRAL_CMD_TYPE_INVOKE_BEHAVIOR,
+    ZMK_SPLIT_TRANSPORT_CENTRAL_CMD_TYPE_SET_PHYSICAL_LAYOUT,
+    ZMK_SPLIT_TRANSPORT_CENTRAL_CMD_TYPE_SET_HID_INDICATORS,
+};
+
+struct zmk_split_transport_central_command {
+    // One of enum zmk_split_transport_central_command_type.
+    uint8_t type;
+
+    union {
+        struct {
+            uint32_t param1;
+            uint32_t param2;
+            uint8_t position;
+            uint8_t state;
+            char behavior_dev[ZMK_SPLIT_TRANSPORT_BEHAVIOR_DEV_LEN];
+        } __packed invoke_behavior;
+
+        struct {
+            uint8_t layout_idx;
+        } __packed set_physical_layout;
+
+        struct {
+            zmk_hid_indicators_t indicators;
+        } __packed set_hid_indicators;
+    } data;
+} __packed;
@@ -0,0 +1,67 @@
+/*
+ * Copyright (c) 2024 The ZMK Contributors
+ *
+ * SPDX-License-Identifier: MIT
+ */
+
+#pragma once
+
+#include <zephyr/kernel.h>
+#include <zephyr/sys/dlist.h>
+
+struct zmk_timer;
+
+typedef void (*zmk_timer_handler_t)(struct zmk_timer *timer);
+
+/**
+ * A deadline registered with the shared timer wheel. All timers are serviced by a single work item
+ * on the system work queue, so timers that expire in the same tick are handled in one wakeup.
+ */
+struct zmk_timer {
+    sys_dnode_t node;
+    int64_t deadline;
+    zmk_timer_handler_t handler;
+};
+
+/**
+ * @brief Initialize a timer. Must be called before any other function on the timer.
+ *
+ * @param timer The timer to initialize.
+ * @param handler Function called from the system work queue when the timer expires.
+ */
+void zmk_timer_init(struct zmk_timer *timer, zmk_timer_handler_t handler);
+
+/**
+ * @brief Start the timer so it expires at an absolute time, replacing any pending deadline.
+ *
+ * A deadline in the past expires as soon as possible.
+ *
+ * @param timer The timer to start.
+ * @param deadline The system uptime in milliseconds at which the timer should expire.
+ */
+void zmk_timer_start_at(struct zmk_timer *timer, int64_t deadline);
+
+/**
+ * @brief Start the timer so it expires after a delay, replacing any pending deadline.
+ *
+ * @param timer The timer to start.
+ * @param ms Milliseconds from now at which the timer should expire.
+ */
+static inline void zmk_timer_start(struct zmk_timer *timer, int32_t ms) {
+    zmk_timer_start_at(timer, k_uptime_get() + ms);
+}
+
+/**
+ * @brief Stop a pending timer. This is O(1).
+ *
+ * Once this returns, the timer's handler will not be called for the stopped deadline, even if it
+ * expired in the same tick as the timer whose handler is currently running.
+ *
+ * @retval true if the timer was pending.
+ */
+bool zmk_timer_stop(struct zmk_timer *timer);
+
+/**
+ * @brief Check whether a timer is waiting to expire.
+ */
+bool zmk_timer_is_pending(const struct zmk_timer *timer);
@@ -0,0 +1,42 @@
+/*
+ * Copyright (c) 2024 The ZMK Contributors
+ *
+ * SPDX-License-Identifier: MIT
+ */
+
+#pragma once
+
+#include <stddef.h>
+#include <stdint.h>
+
+/**
+ * Starts writing a report to the HID interrupt IN endpoint.
+ *
+ * @return 0 once the transfer has started, -EAGAIN or -EBUSY if the endpoint can't take the
+ * report yet, or another negative error if the report can't be sent.
+ */
+typedef int (*zmk_usb_hid_queue_write_t)(const uint8_t *report, size_t len);
+
+/**
+ * Sets the function used to write reports from the queue.
+ */
+void zmk_usb_hid_queue_init(zmk_usb_hid_queue_write_t write);
+
+/**
+ * Adds a report to the queue, and starts sending it if no other transfer is in progress. A
+ * keyboard or consumer report that hasn't started sending yet is replaced by the next one of the
+ * same type when the host would see the same presses and releases.
+ *
+ * @param report_id Report ID, or 0 for a boot protocol keyboard report.
+ */
+int zmk_usb_hid_queue_add(uint8_t report_id, const uint8_t *report, size_t len);
+
+/**
+ * Called once the host has read the report in flight, to start sending the next one.
+ */
+void zmk_usb_hid_queue_transfer_done(void);
+
+/**
+ * Drops all queued reports, for when transfers in progress won't complete.
+ */
+void zmk_usb_hid_queue_reset(void);
@@ -0,0 +1,84 @@
+/*
+ * Copyright (c) 2024 The ZMK Contributors
+ *
+ * SPDX-License-Identifier: MIT
+ */
+
+#define DT_DRV_COMPAT zmk_input_mock
+
+#include <stdlib.h>
+#include <zephyr/device.h>
+#include <zephyr/input/input.h>
+#include <zephyr/kernel.h>
+#include <zephyr/logging/log.h>
+
+LOG_MODULE_DECLARE(zmk, CONFIG_ZMK_LOG_LEVEL);
+
+#define EVENT_CELLS 3
+
+struct input_mock_config {
+    uint16_t startup_delay;
+    uint16_t event_period;
+    uint32_t repeat;
+    bool exit_after;
+    const int32_t *events;
+    size_t events_len;
+};
+
+struct input_mock_data {
+    uint32_t frame_index;
+    struct k_work_delayable work;
+    const struct device *dev;
+};
+
+static void input_mock_work_cb(struct k_work *work) {
+    struct k_work_delayable *dwork = CONTAINER_OF(work, struct k_work_delayable, work);
+    struct input_mock_data *data = CONTAINER_OF(dwork, struct input_mock_data, work);
+    const struct device *dev = data->dev;
+    const struct input_mock_config *cfg = dev->config;
+
+    for (size_t i = 0; i < cfg->events_len; i += EVENT_CELLS) {
+        input_report(dev, cfg->events[i], cfg->events[i + 1], cfg->events[i + 2],
+                     i + EVENT_CELLS >= cfg->events_len, K_FOREVER);
+    }
+
+    if (++data->frame_index < cfg->repeat) {
+        k_work_schedule(&data->work, K_MSEC(cfg->event_period));
+    } else {
+        LOG_DBG("Generated %d input frames", data->frame_index);
+
+        if (cfg->exit_after) {
+            exit(0);
+        }
+    }
+}
+
+static int input_mock_init(const struct device *dev) {
+    struct input_mock_data *data = dev->data;
+    const struct input_mock_config *cfg = dev->config;
+
+    data->dev = dev;
+
+    k_work_init_delayable(&data->work, input_mock_work_cb);
+    k_work_schedule(&data->work, K_MSEC(cfg->startup_delay));
+
+    return 0;
+}
+
+#define INPUT_MOCK_INST(n)                                                                         \
+    BUILD_ASSERT(DT_INST_PROP_LEN(n, events) % EVENT_CELLS == 0,                                   \
+                 "Mock input events must be (type code value) triples");                           \
+    static struct input_mock_data input_mock_data_##n = {};                                        \
+    static const int32_t input_mock_events_##n[] = DT_INST_PROP(n, events);                        \
+    static const struct input_mock_config input_mock_cfg_##n = {                                   \
+        .events = input_mock_events_##n,                                                           \
+        .events_len = DT_INST_PROP_LEN(n, events),                                                 \
+        .startup_delay = DT_INST_PROP(n, event_startup_delay),                                     \
+        .event_period = DT_INST_PROP(n, event_period),                                             \
+        .repeat = DT_INST_PROP(n, repeat),                                                         \
+        .exit_after = DT_INST_PROP(n, exit_after),                                                 \
+    };                                                                                             \
+    DEVICE_DT_INST_DEFINE(n, input_mock_init, NULL, &input_mock_data_##n, &input_mock_cfg_##n,     \
+                          POST_KERNEL, CONFIG_INPUT_INIT_PRIORITY, NULL);
+
+DT_INST_FOREACH_STATUS_OKAY(INPUT_MOCK_INST)
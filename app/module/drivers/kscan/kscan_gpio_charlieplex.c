@@ -21,7 +21,6 @@ LOG_MODULE_DECLARE(zmk, CONFIG_ZMK_LOG_LEVEL);
 #define DT_DRV_COMPAT zmk_kscan_gpio_charlieplex
 
 #define INST_LEN(n) DT_INST_PROP_LEN(n, gpios)
-#define INST_CHARLIEPLEX_LEN(n) (INST_LEN(n) * INST_LEN(n))
 
 #if CONFIG_ZMK_KSCAN_DEBOUNCE_PRESS_MS >= 0
 #define INST_DEBOUNCE_PRESS_MS(n) CONFIG_ZMK_KSCAN_DEBOUNCE_PRESS_MS
@@ -37,6 +36,11 @@ LOG_MODULE_DECLARE(zmk, CONFIG_ZMK_LOG_LEVEL);
     DT_INST_PROP_OR(n, debounce_period, DT_INST_PROP(n, debounce_release_ms))
 #endif
 
+#define INST_DEBOUNCE_PRESS_SCANS(n)                                                               \
+    DIV_ROUND_UP(INST_DEBOUNCE_PRESS_MS(n), DT_INST_PROP(n, debounce_scan_period_ms))
+#define INST_DEBOUNCE_RELEASE_SCANS(n)                                                             \
+    DIV_ROUND_UP(INST_DEBOUNCE_RELEASE_MS(n), DT_INST_PROP(n, debounce_scan_period_ms))
+
 #define KSCAN_GPIO_CFG_INIT(idx, inst_idx)                                                         \
     GPIO_DT_SPEC_GET_BY_IDX(DT_DRV_INST(inst_idx), gpios, idx)
 
@@ -60,10 +64,9 @@ struct kscan_charlieplex_data {
     int64_t scan_time; /* Timestamp of the current or scheduled scan. */
     struct gpio_callback irq_callback;
     /**
-     * Current state of the matrix as a flattened 2D array of length
-     * (config->cells.length ^2)
+     * Debounce state of each row, with one bit per column. Array of length config->cells.len.
      */
-    struct zmk_debounce_state *charlieplex_state;
+    struct zmk_debounce_group_state *debounce;
 };
 
 struct kscan_gpio_list {
@@ -77,27 +80,13 @@ struct kscan_gpio_list {
 
 struct kscan_charlieplex_config {
     struct kscan_gpio_list cells;
-    struct zmk_debounce_config debounce_config;
+    struct zmk_debounce_group_config debounce_config;
     int32_t debounce_scan_period_ms;
     int32_t poll_period_ms;
     bool use_interrupt;
     const struct gpio_dt_spec interrupt;
 };
 
-/**
- * Get the index into a matrix state array from a row and column.
- * There are effectively (n) cols and (n-1) rows, but we use the full col x row space
- * as a safety measure against someone accidentally defining a transform RC at (p,p)
- */
-static int state_index(const struct kscan_charlieplex_config *config, const int row,
-                       const int col) {
-    __ASSERT(row < config->cells.len, "Invalid row %i", row);
-    __ASSERT(col < config->cells.len, "Invalid column %i", col);
-    __ASSERT(col != row, "Invalid column row pair %i, %i", col, row);
-
-    return (col * config->cells.len) + row;
-}
-
 static int kscan_charlieplex_set_as_input(const struct gpio_dt_spec *gpio) {
     if (!device_is_ready(gpio->port)) {
         LOG_ERR("GPIO is not ready: %s", gpio->port->name);
@@ -266,28 +255,35 @@ static int kscan_charlieplex_read(const struct device *dev) {
         k_busy_wait(CONFIG_ZMK_KSCAN_CHARLIEPLEX_WAIT_BEFORE_INPUTS);
 #endif
 
+        zmk_debounce_mask_t active = 0;
+
         for (int col = 0; col < config->cells.len; col++) {
             if (col == row) {
                 continue; // pin can't drive itself
             }
             const struct gpio_dt_spec *in_gpio = &config->cells.gpios[col];
-            const int index = state_index(config, row, col);
 
-            struct zmk_debounce_state *state = &data->charlieplex_state[index];
-            zmk_debounce_update(state, gpio_pin_get_dt(in_gpio), config->debounce_scan_period_ms,
-                                &config->debounce_config);
+            if (gpio_pin_get_dt(in_gpio) > 0) {
+                active |= BIT(col);
+            }
+        }
 
-            // NOTE: RR vs MATRIX: because we don't need an input/output => row/column
-            // setup, we can update in the same loop.
-            if (zmk_debounce_get_changed(state)) {
-                const bool pressed = zmk_debounce_is_pressed(state);
+        // NOTE: RR vs MATRIX: because we don't need an input/output => row/column
+        // mapping, we can send the changes as soon as each row is debounced.
+        struct zmk_debounce_group_state *state = &data->debounce[row];
+        zmk_debounce_mask_t changed =
+            zmk_debounce_group_update(state, active, &config->debounce_config);
 
-                LOG_DBG("Sending event at %i,%i state %s", row, col, pressed ? "on" : "off");
-                data->callback(dev, row, col, pressed);
-            }
-            continue_scan = continue_scan || zmk_debounce_is_active(state);
+        for (; changed; changed &= changed - 1) {
+            const int col = find_lsb_set(changed) - 1;
+            const bool pressed = state->pressed & BIT(col);
+
+            LOG_DBG("Sending event at %i,%i state %s", row, col, pressed ? "on" : "off");
+            data->callback(dev, row, col, pressed);
         }
 
+        continue_scan = continue_scan || zmk_debounce_group_active(state);
+
         err = kscan_charlieplex_set_as_input(out_gpio);
         if (err) {
             return err;
@@ -433,25 +429,24 @@ static const struct kscan_driver_api kscan_charlieplex_api = {
 };
 
 #define KSCAN_CHARLIEPLEX_INIT(n)                                                                  \
-    BUILD_ASSERT(INST_DEBOUNCE_PRESS_MS(n) <= DEBOUNCE_COUNTER_MAX,                                \
+    BUILD_ASSERT(INST_DEBOUNCE_PRESS_SCANS(n) <= ZMK_DEBOUNCE_GROUP_MAX_SCANS,                     \
                  "ZMK_KSCAN_DEBOUNCE_PRESS_MS or debounce-press-ms is too large");                 \
-    BUILD_ASSERT(INST_DEBOUNCE_RELEASE_MS(n) <= DEBOUNCE_COUNTER_MAX,                              \
+    BUILD_ASSERT(INST_DEBOUNCE_RELEASE_SCANS(n) <= ZMK_DEBOUNCE_GROUP_MAX_SCANS,                   \
                  "ZMK_KSCAN_DEBOUNCE_RELEASE_MS or debounce-release-ms is too large");             \
+    BUILD_ASSERT(INST_LEN(n) <= ZMK_DEBOUNCE_GROUP_SIZE, "Too many charlieplex GPIOs");            \
                                                                                                    \
-    static struct zmk_debounce_state kscan_charlieplex_state_##n[INST_CHARLIEPLEX_LEN(n)];         \
+    static struct zmk_debounce_group_state kscan_charlieplex_debounce_##n[INST_LEN(n)];            \
     static const struct gpio_dt_spec kscan_charlieplex_cells_##n[] = {                             \
         LISTIFY(INST_LEN(n), KSCAN_GPIO_CFG_INIT, (, ), n)};                                       \
     static struct kscan_charlieplex_data kscan_charlieplex_data_##n = {                            \
-        .charlieplex_state = kscan_charlieplex_state_##n,                                          \
+        .debounce = kscan_charlieplex_debounce_##n,                                                \
     };                                                                                             \
                                                                                                    \
     static struct kscan_charlieplex_config kscan_charlieplex_config_##n = {                        \
         .cells = KSCAN_GPIO_LIST(kscan_charlieplex_cells_##n),                                     \
-        .debounce_config =                                                                         \
-            {                                                                                      \
-                .debounce_press_ms = INST_DEBOUNCE_PRESS_MS(n),                                    \
-                .debounce_release_ms = INST_DEBOUNCE_RELEASE_MS(n),                                \
-            },                                                                                     \
+        .debounce_config = ZMK_DEBOUNCE_GROUP_CONFIG(INST_DEBOUNCE_PRESS_MS(n),                    \
+                                                     INST_DEBOUNCE_RELEASE_MS(n),                  \
+                                                     DT_INST_PROP(n, debounce_scan_period_ms)),    \
         .debounce_scan_period_ms = DT_INST_PROP(n, debounce_scan_period_ms),                       \
         COND_ANY_POLLING((.poll_period_ms = DT_INST_PROP(n, poll_period_ms), ))                    \
             COND_THIS_INTERRUPT(n, (.use_interrupt = INST_INTR_DEFINED(n), ))                      \
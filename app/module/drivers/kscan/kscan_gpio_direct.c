@@ -6,6 +6,8 @@
 
 #include "kscan_gpio.h"
 
+#include <string.h>
+
 #include <zephyr/device.h>
 #include <zephyr/devicetree.h>
 #include <zephyr/drivers/gpio.h>
@@ -45,6 +47,15 @@ LOG_MODULE_DECLARE(zmk, CONFIG_ZMK_LOG_LEVEL);
 #define INST_INPUTS_LEN(n)                                                                         \
     COND_CODE_1(DT_INST_NODE_HAS_PROP(n, input_gpios), (DT_INST_PROP_LEN(n, input_gpios)),         \
                 (DT_INST_PROP_LEN(n, input_keys)))
+#define INST_GROUPS_LEN(n) DIV_ROUND_UP(INST_INPUTS_LEN(n), ZMK_DEBOUNCE_GROUP_SIZE)
+
+#define INST_DEBOUNCE_PRESS_SCANS(n)                                                               \
+    DIV_ROUND_UP(INST_DEBOUNCE_PRESS_MS(n), DT_INST_PROP(n, debounce_scan_period_ms))
+#define INST_DEBOUNCE_RELEASE_SCANS(n)                                                             \
+    DIV_ROUND_UP(INST_DEBOUNCE_RELEASE_MS(n), DT_INST_PROP(n, debounce_scan_period_ms))
+
+#define GROUP_INDEX(index) ((index) / ZMK_DEBOUNCE_GROUP_SIZE)
+#define GROUP_BIT(index) BIT((index) % ZMK_DEBOUNCE_GROUP_SIZE)
 
 #define KSCAN_GPIO_DIRECT_INPUT_CFG_INIT(idx, inst_idx)                                            \
     KSCAN_GPIO_GET_BY_IDX(DT_DRV_INST(inst_idx), input_gpios, idx)
@@ -67,12 +78,20 @@ struct kscan_direct_data {
 #endif
     /** Timestamp of the current or scheduled scan. */
     int64_t scan_time;
-    /** Current state of the inputs as an array of length config->inputs.len */
-    struct zmk_debounce_state *pin_state;
+    /**
+     * Debounce state of the inputs, in groups of ZMK_DEBOUNCE_GROUP_SIZE indexed by the input's
+     * index in the devicetree. Array of length config->groups_len.
+     */
+    struct zmk_debounce_group_state *debounce;
+    /** Inputs read as active in the latest scan. Array of length config->groups_len. */
+    zmk_debounce_mask_t *active;
+    /** Inputs which changed state in the latest scan. Array of length config->groups_len. */
+    zmk_debounce_mask_t *changed;
 };
 
 struct kscan_direct_config {
-    struct zmk_debounce_config debounce_config;
+    struct zmk_debounce_group_config debounce_config;
+    size_t groups_len;
     int32_t debounce_scan_period_ms;
     int32_t poll_period_ms;
     bool toggle_mode;
@@ -180,6 +199,8 @@ static int kscan_direct_read(const struct device *dev) {
     // Read the inputs.
     struct kscan_gpio_port_state state = {0};
 
+    memset(data->active, 0, config->groups_len * sizeof(zmk_debounce_mask_t));
+
     for (int i = 0; i < data->inputs.len; i++) {
         const struct kscan_gpio *gpio = &data->inputs.gpios[i];
 
@@ -189,19 +210,28 @@ static int kscan_direct_read(const struct device *dev) {
             return active;
         }
 
-        zmk_debounce_update(&data->pin_state[gpio->index], active, config->debounce_scan_period_ms,
-                            &config->debounce_config);
+        if (active) {
+            data->active[GROUP_INDEX(gpio->index)] |= GROUP_BIT(gpio->index);
+        }
     }
 
-    // Process the new state.
+    // Debounce all inputs of a group at once.
     bool continue_scan = false;
 
+    for (int i = 0; i < config->groups_len; i++) {
+        data->changed[i] = zmk_debounce_group_update(&data->debounce[i], data->active[i],
+                                                     &config->debounce_config);
+
+        continue_scan = continue_scan || zmk_debounce_group_active(&data->debounce[i]);
+    }
+
+    // Process the new state.
     for (int i = 0; i < data->inputs.len; i++) {
         const struct kscan_gpio *gpio = &data->inputs.gpios[i];
-        struct zmk_debounce_state *deb_state = &data->pin_state[gpio->index];
+        const int group = GROUP_INDEX(gpio->index);
 
-        if (zmk_debounce_get_changed(deb_state)) {
-            const bool pressed = zmk_debounce_is_pressed(deb_state);
+        if (data->changed[group] & GROUP_BIT(gpio->index)) {
+            const bool pressed = data->debounce[group].pressed & GROUP_BIT(gpio->index);
 
             LOG_DBG("Sending event at 0,%i state %s", gpio->index, pressed ? "on" : "off");
             data->callback(dev, 0, gpio->index, pressed);
@@ -209,8 +239,6 @@ static int kscan_direct_read(const struct device *dev) {
                 kscan_inputs_set_flags(&data->inputs, &gpio->spec);
             }
         }
-
-        continue_scan = continue_scan || zmk_debounce_is_active(deb_state);
     }
 
     if (continue_scan) {
@@ -377,9 +405,9 @@ static const struct kscan_driver_api kscan_direct_api = {
 };
 
 #define KSCAN_DIRECT_INIT(n)                                                                       \
-    BUILD_ASSERT(INST_DEBOUNCE_PRESS_MS(n) <= DEBOUNCE_COUNTER_MAX,                                \
+    BUILD_ASSERT(INST_DEBOUNCE_PRESS_SCANS(n) <= ZMK_DEBOUNCE_GROUP_MAX_SCANS,                     \
                  "ZMK_KSCAN_DEBOUNCE_PRESS_MS or debounce-press-ms is too large");                 \
-    BUILD_ASSERT(INST_DEBOUNCE_RELEASE_MS(n) <= DEBOUNCE_COUNTER_MAX,                              \
+    BUILD_ASSERT(INST_DEBOUNCE_RELEASE_SCANS(n) <= ZMK_DEBOUNCE_GROUP_MAX_SCANS,                   \
                  "ZMK_KSCAN_DEBOUNCE_RELEASE_MS or debounce-release-ms is too large");             \
                                                                                                    \
     static struct kscan_gpio kscan_direct_inputs_##n[] = {                                         \
@@ -387,22 +415,25 @@ static const struct kscan_driver_api kscan_direct_api = {
                     (LISTIFY(INST_INPUTS_LEN(n), KSCAN_GPIO_DIRECT_INPUT_CFG_INIT, (, ), n)),      \
                     (LISTIFY(INST_INPUTS_LEN(n), KSCAN_KEY_DIRECT_INPUT_CFG_INIT, (, ), n)))};     \
                                                                                                    \
-    static struct zmk_debounce_state kscan_direct_state_##n[INST_INPUTS_LEN(n)];                   \
+    static struct zmk_debounce_group_state kscan_direct_debounce_##n[INST_GROUPS_LEN(n)];          \
+    static zmk_debounce_mask_t kscan_direct_active_##n[INST_GROUPS_LEN(n)];                        \
+    static zmk_debounce_mask_t kscan_direct_changed_##n[INST_GROUPS_LEN(n)];                       \
                                                                                                    \
     COND_INTERRUPTS(                                                                               \
         (static struct kscan_direct_irq_callback kscan_direct_irqs_##n[INST_INPUTS_LEN(n)];))      \
                                                                                                    \
     static struct kscan_direct_data kscan_direct_data_##n = {                                      \
         .inputs = KSCAN_GPIO_LIST(kscan_direct_inputs_##n),                                        \
-        .pin_state = kscan_direct_state_##n,                                                       \
+        .debounce = kscan_direct_debounce_##n,                                                     \
+        .active = kscan_direct_active_##n,                                                         \
+        .changed = kscan_direct_changed_##n,                                                       \
         COND_INTERRUPTS((.irqs = kscan_direct_irqs_##n, ))};                                       \
                                                                                                    \
     static struct kscan_direct_config kscan_direct_config_##n = {                                  \
-        .debounce_config =                                                                         \
-            {                                                                                      \
-                .debounce_press_ms = INST_DEBOUNCE_PRESS_MS(n),                                    \
-                .debounce_release_ms = INST_DEBOUNCE_RELEASE_MS(n),                                \
-            },                                                                                     \
+        .debounce_config = ZMK_DEBOUNCE_GROUP_CONFIG(INST_DEBOUNCE_PRESS_MS(n),                    \
+                                                     INST_DEBOUNCE_RELEASE_MS(n),                  \
+                                                     DT_INST_PROP(n, debounce_scan_period_ms)),    \
+        .groups_len = INST_GROUPS_LEN(n),                                                          \
         .debounce_scan_period_ms = DT_INST_PROP(n, debounce_scan_period_ms),                       \
         .poll_period_ms = DT_INST_PROP(n, poll_period_ms),                                         \
         .toggle_mode = DT_INST_PROP(n, toggle_mode),                                               \
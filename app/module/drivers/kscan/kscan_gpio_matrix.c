@@ -5,6 +5,9 @@
  */
 
 #include "kscan_gpio.h"
+#include "kscan_gpio_matrix_benchmark.h"
+
+#include <string.h>
 
 #include <zephyr/device.h>
 #include <zephyr/devicetree.h>
@@ -28,8 +31,17 @@ LOG_MODULE_DECLARE(zmk, CONFIG_ZMK_LOG_LEVEL);
 
 #define INST_ROWS_LEN(n) DT_INST_PROP_LEN(n, row_gpios)
 #define INST_COLS_LEN(n) DT_INST_PROP_LEN(n, col_gpios)
-#define INST_MATRIX_LEN(n) (INST_ROWS_LEN(n) * INST_COLS_LEN(n))
 #define INST_INPUTS_LEN(n) COND_DIODE_DIR(n, (INST_COLS_LEN(n)), (INST_ROWS_LEN(n)))
+#define INST_OUTPUTS_LEN(n) COND_DIODE_DIR(n, (INST_ROWS_LEN(n)), (INST_COLS_LEN(n)))
+
+/**
+ * A bitmap of up to ZMK_DEBOUNCE_GROUP_SIZE inputs. Matrices with more inputs than that split them
+ * into several groups, where input n is bit n % ZMK_DEBOUNCE_GROUP_SIZE of group
+ * n / ZMK_DEBOUNCE_GROUP_SIZE.
+ */
+typedef zmk_debounce_mask_t kscan_matrix_inputs_t;
+
+#define INST_INPUT_GROUPS(n) DIV_ROUND_UP(INST_INPUTS_LEN(n), ZMK_DEBOUNCE_GROUP_SIZE)
 
 #if CONFIG_ZMK_KSCAN_DEBOUNCE_PRESS_MS >= 0
 #define INST_DEBOUNCE_PRESS_MS(n) CONFIG_ZMK_KSCAN_DEBOUNCE_PRESS_MS
@@ -45,6 +57,11 @@ LOG_MODULE_DECLARE(zmk, CONFIG_ZMK_LOG_LEVEL);
     DT_INST_PROP_OR(n, debounce_period, DT_INST_PROP(n, debounce_release_ms))
 #endif
 
+#define INST_DEBOUNCE_PRESS_SCANS(n)                                                               \
+    DIV_ROUND_UP(INST_DEBOUNCE_PRESS_MS(n), DT_INST_PROP(n, debounce_scan_period_ms))
+#define INST_DEBOUNCE_RELEASE_SCANS(n)                                                             \
+    DIV_ROUND_UP(INST_DEBOUNCE_RELEASE_MS(n), DT_INST_PROP(n, debounce_scan_period_ms))
+
 #define USE_POLLING IS_ENABLED(CONFIG_ZMK_KSCAN_MATRIX_POLLING)
 #define USE_INTERRUPTS (!USE_POLLING)
 
@@ -67,9 +84,21 @@ struct kscan_matrix_irq_callback {
     struct gpio_callback callback;
 };
 
+/** The inputs on one GPIO port, so they can be read together. */
+struct kscan_matrix_port {
+    const struct device *port;
+    /** Pins on the port which are inputs. */
+    gpio_port_pins_t pins;
+    /** Index of the input for each pin in pins, indexed by pin number. */
+    uint8_t input_bit[GPIO_MAX_PINS_PER_PORT];
+};
+
 struct kscan_matrix_data {
     const struct device *dev;
     struct kscan_gpio_list inputs;
+    /** Array of length config->inputs.len, of which ports_len are used. */
+    struct kscan_matrix_port *ports;
+    size_t ports_len;
     kscan_callback_t callback;
     struct k_work_delayable work;
 #if USE_INTERRUPTS
@@ -79,40 +108,39 @@ struct kscan_matrix_data {
     /** Timestamp of the current or scheduled scan. */
     int64_t scan_time;
     /**
-     * Current state of the matrix as a flattened 2D array of length
-     * (config->rows * config->cols)
+     * Debounce state of each group of inputs for each output. Array of length
+     * config->outputs.len * config->input_groups, indexed by output * input_groups + group.
      */
-    struct zmk_debounce_state *matrix_state;
+    struct zmk_debounce_group_state *debounce;
+    /** Inputs which changed state in the latest scan. Indexed the same as debounce. */
+    kscan_matrix_inputs_t *changed;
+    /** Inputs which are active on the current output. Array of length config->input_groups. */
+    kscan_matrix_inputs_t *active;
 };
 
 struct kscan_matrix_config {
     struct kscan_gpio_list outputs;
-    struct zmk_debounce_config debounce_config;
+    struct zmk_debounce_group_config debounce_config;
     size_t rows;
     size_t cols;
+    size_t input_groups;
     int32_t debounce_scan_period_ms;
     int32_t poll_period_ms;
     enum kscan_diode_direction diode_direction;
 };
 
 /**
- * Get the index into a matrix state array from a row and column.
+ * Get the row and column of the key at input/output pin indices.
  */
-static int state_index_rc(const struct kscan_matrix_config *config, const int row, const int col) {
-    __ASSERT(row < config->rows, "Invalid row %i", row);
-    __ASSERT(col < config->cols, "Invalid column %i", col);
-
-    return (col * config->rows) + row;
-}
-
-/**
- * Get the index into a matrix state array from input/output pin indices.
- */
-static int state_index_io(const struct kscan_matrix_config *config, const int input_idx,
-                          const int output_idx) {
-    return (config->diode_direction == KSCAN_ROW2COL)
-               ? state_index_rc(config, output_idx, input_idx)
-               : state_index_rc(config, input_idx, output_idx);
+static void rc_from_io(const struct kscan_matrix_config *config, const int input_idx,
+                       const int output_idx, int *row, int *col) {
+    if (config->diode_direction == KSCAN_ROW2COL) {
+        *row = output_idx;
+        *col = input_idx;
+    } else {
+        *row = input_idx;
+        *col = output_idx;
+    }
 }
 
 static int kscan_matrix_set_all_outputs(const struct device *dev, const int value) {
@@ -215,6 +243,36 @@ static void kscan_matrix_read_end(const struct device *dev) {
 #endif
 }
 
+/**
+ * Read all inputs into data->active, reading each port once.
+ */
+static int kscan_matrix_read_inputs(const struct device *dev) {
+    const struct kscan_matrix_config *config = dev->config;
+    const struct kscan_matrix_data *data = dev->data;
+
+    memset(data->active, 0, config->input_groups * sizeof(data->active[0]));
+
+    for (int i = 0; i < data->ports_len; i++) {
+        const struct kscan_matrix_port *port = &data->ports[i];
+        gpio_port_value_t value;
+
+        const int err = gpio_port_get(port->port, &value);
+        if (err) {
+            LOG_ERR("Failed to read port %s: %i", port->port->name, err);
+            return err;
+        }
+
+        // Only active pins need to be looked up, and most of the time there are none.
+        for (value &= port->pins; value; value &= value - 1) {
+            const int input = port->input_bit[find_lsb_set(value) - 1];
+
+            data->active[input / ZMK_DEBOUNCE_GROUP_SIZE] |= BIT(input % ZMK_DEBOUNCE_GROUP_SIZE);
+        }
+    }
+
+    return 0;
+}
+
 static int kscan_matrix_read(const struct device *dev) {
     struct kscan_matrix_data *data = dev->data;
     const struct kscan_matrix_config *config = dev->config;
@@ -223,6 +281,8 @@ static int kscan_matrix_read(const struct device *dev) {
     for (int i = 0; i < config->outputs.len; i++) {
         const struct kscan_gpio *out_gpio = &config->outputs.gpios[i];
 
+        kscan_matrix_benchmark_strobe_start();
+
         int err = gpio_pin_set_dt(&out_gpio->spec, 1);
         if (err) {
             LOG_ERR("Failed to set output %i active: %i", out_gpio->index, err);
@@ -232,20 +292,9 @@ static int kscan_matrix_read(const struct device *dev) {
 #if CONFIG_ZMK_KSCAN_MATRIX_WAIT_BEFORE_INPUTS > 0
         k_busy_wait(CONFIG_ZMK_KSCAN_MATRIX_WAIT_BEFORE_INPUTS);
 #endif
-        struct kscan_gpio_port_state state = {0};
-
-        for (int j = 0; j < data->inputs.len; j++) {
-            const struct kscan_gpio *in_gpio = &data->inputs.gpios[j];
-
-            const int index = state_index_io(config, in_gpio->index, out_gpio->index);
-            const int active = kscan_gpio_pin_get(in_gpio, &state);
-            if (active < 0) {
-                LOG_ERR("Failed to read port %s: %i", in_gpio->spec.port->name, active);
-                return active;
-            }
-
-            zmk_debounce_update(&data->matrix_state[index], active, config->debounce_scan_period_ms,
-                                &config->debounce_config);
+        err = kscan_matrix_read_inputs(dev);
+        if (err) {
+            return err;
         }
 
         err = gpio_pin_set_dt(&out_gpio->spec, 0);
@@ -254,6 +303,15 @@ static int kscan_matrix_read(const struct device *dev) {
             return err;
         }
 
+        for (int g = 0; g < config->input_groups; g++) {
+            const int idx = i * config->input_groups + g;
+
+            data->changed[idx] = zmk_debounce_group_update(&data->debounce[idx], data->active[g],
+                                                           &config->debounce_config);
+        }
+
+        kscan_matrix_benchmark_strobe_end();
+
 #if CONFIG_ZMK_KSCAN_MATRIX_WAIT_BETWEEN_OUTPUTS > 0
         k_busy_wait(CONFIG_ZMK_KSCAN_MATRIX_WAIT_BETWEEN_OUTPUTS);
 #endif
@@ -262,22 +320,31 @@ static int kscan_matrix_read(const struct device *dev) {
     // Process the new state.
     bool continue_scan = false;
 
-    for (int r = 0; r < config->rows; r++) {
-        for (int c = 0; c < config->cols; c++) {
-            const int index = state_index_rc(config, r, c);
-            struct zmk_debounce_state *state = &data->matrix_state[index];
+    for (int i = 0; i < config->outputs.len; i++) {
+        const struct kscan_gpio *out_gpio = &config->outputs.gpios[i];
+
+        for (int g = 0; g < config->input_groups; g++) {
+            const int idx = i * config->input_groups + g;
+            const struct zmk_debounce_group_state *debounce = &data->debounce[idx];
+
+            for (kscan_matrix_inputs_t changed = data->changed[idx]; changed;
+                 changed &= changed - 1) {
+                const int bit = find_lsb_set(changed) - 1;
+                const bool pressed = debounce->pressed & BIT(bit);
+                int r, c;
 
-            if (zmk_debounce_get_changed(state)) {
-                const bool pressed = zmk_debounce_is_pressed(state);
+                rc_from_io(config, g * ZMK_DEBOUNCE_GROUP_SIZE + bit, out_gpio->index, &r, &c);
 
                 LOG_DBG("Sending event at %i,%i state %s", r, c, pressed ? "on" : "off");
                 data->callback(dev, r, c, pressed);
             }
 
-            continue_scan = continue_scan || zmk_debounce_is_active(state);
+            continue_scan = continue_scan || zmk_debounce_group_active(debounce);
         }
     }
 
+    kscan_matrix_benchmark_scan_done(&data->inputs);
+
     if (continue_scan) {
         // At least one key is pressed or the debouncer has not yet decided if
         // it is pressed. Poll quickly until everything is released.
@@ -443,13 +510,33 @@ static void kscan_matrix_setup_pins(const struct device *dev) {
     kscan_matrix_set_all_outputs(dev, 0);
 }
 
+static void kscan_matrix_init_ports(const struct device *dev) {
+    struct kscan_matrix_data *data = dev->data;
+
+    data->ports_len = 0;
+
+    for (int i = 0; i < data->inputs.len; i++) {
+        const struct kscan_gpio *gpio = &data->inputs.gpios[i];
+
+        if (data->ports_len == 0 || data->ports[data->ports_len - 1].port != gpio->spec.port) {
+            data->ports[data->ports_len++] = (struct kscan_matrix_port){.port = gpio->spec.port};
+        }
+
+        struct kscan_matrix_port *port = &data->ports[data->ports_len - 1];
+
+        port->pins |= BIT(gpio->spec.pin);
+        port->input_bit[gpio->spec.pin] = gpio->index;
+    }
+}
+
 static int kscan_matrix_init(const struct device *dev) {
     struct kscan_matrix_data *data = dev->data;
 
     data->dev = dev;
 
-    // Sort inputs by port so we can read each port just once per scan.
+    // Sort inputs by port and group them so we can read each port just once per scan.
     kscan_gpio_list_sort_by_port(&data->inputs);
+    kscan_matrix_init_ports(dev);
 
     k_work_init_delayable(&data->work, kscan_matrix_work_handler);
 
@@ -493,10 +580,11 @@ static const struct kscan_driver_api kscan_matrix_api = {
 };
 
 #define KSCAN_MATRIX_INIT(n)                                                                       \
-    BUILD_ASSERT(INST_DEBOUNCE_PRESS_MS(n) <= DEBOUNCE_COUNTER_MAX,                                \
+    BUILD_ASSERT(INST_DEBOUNCE_PRESS_SCANS(n) <= ZMK_DEBOUNCE_GROUP_MAX_SCANS,                     \
                  "ZMK_KSCAN_DEBOUNCE_PRESS_MS or debounce-press-ms is too large");                 \
-    BUILD_ASSERT(INST_DEBOUNCE_RELEASE_MS(n) <= DEBOUNCE_COUNTER_MAX,                              \
+    BUILD_ASSERT(INST_DEBOUNCE_RELEASE_SCANS(n) <= ZMK_DEBOUNCE_GROUP_MAX_SCANS,                   \
                  "ZMK_KSCAN_DEBOUNCE_RELEASE_MS or debounce-release-ms is too large");             \
+    BUILD_ASSERT(INST_INPUTS_LEN(n) <= UINT8_MAX + 1, "Too many matrix inputs");                   \
                                                                                                    \
     static struct kscan_gpio kscan_matrix_rows_##n[] = {                                           \
         LISTIFY(INST_ROWS_LEN(n), KSCAN_GPIO_ROW_CFG_INIT, (, ), n)};                              \
@@ -504,7 +592,12 @@ static const struct kscan_driver_api kscan_matrix_api = {
     static struct kscan_gpio kscan_matrix_cols_##n[] = {                                           \
         LISTIFY(INST_COLS_LEN(n), KSCAN_GPIO_COL_CFG_INIT, (, ), n)};                              \
                                                                                                    \
-    static struct zmk_debounce_state kscan_matrix_state_##n[INST_MATRIX_LEN(n)];                   \
+    static struct zmk_debounce_group_state                                                         \
+        kscan_matrix_debounce_##n[INST_OUTPUTS_LEN(n) * INST_INPUT_GROUPS(n)];                     \
+    static kscan_matrix_inputs_t                                                                   \
+        kscan_matrix_changed_##n[INST_OUTPUTS_LEN(n) * INST_INPUT_GROUPS(n)];                      \
+    static kscan_matrix_inputs_t kscan_matrix_active_##n[INST_INPUT_GROUPS(n)];                    \
+    static struct kscan_matrix_port kscan_matrix_ports_##n[INST_INPUTS_LEN(n)];                    \
                                                                                                    \
     COND_INTERRUPTS(                                                                               \
         (static struct kscan_matrix_irq_callback kscan_matrix_irqs_##n[INST_INPUTS_LEN(n)];))      \
@@ -512,19 +605,21 @@ static const struct kscan_driver_api kscan_matrix_api = {
     static struct kscan_matrix_data kscan_matrix_data_##n = {                                      \
         .inputs =                                                                                  \
             KSCAN_GPIO_LIST(COND_DIODE_DIR(n, (kscan_matrix_cols_##n), (kscan_matrix_rows_##n))),  \
-        .matrix_state = kscan_matrix_state_##n,                                                    \
+        .ports = kscan_matrix_ports_##n,                                                           \
+        .debounce = kscan_matrix_debounce_##n,                                                     \
+        .changed = kscan_matrix_changed_##n,                                                       \
+        .active = kscan_matrix_active_##n,                                                         \
         COND_INTERRUPTS((.irqs = kscan_matrix_irqs_##n, ))};                                       \
                                                                                                    \
     static struct kscan_matrix_config kscan_matrix_config_##n = {                                  \
         .rows = ARRAY_SIZE(kscan_matrix_rows_##n),                                                 \
         .cols = ARRAY_SIZE(kscan_matrix_cols_##n),                                                 \
+        .input_groups = INST_INPUT_GROUPS(n),                                                      \
         .outputs =                                                                                 \
             KSCAN_GPIO_LIST(COND_DIODE_DIR(n, (kscan_matrix_rows_##n), (kscan_matrix_cols_##n))),  \
-        .debounce_config =                                                                         \
-            {                                                                                      \
-                .debounce_press_ms = INST_DEBOUNCE_PRESS_MS(n),                                    \
-                .debounce_release_ms = INST_DEBOUNCE_RELEASE_MS(n),                                \
-            },                                                                                     \
+        .debounce_config = ZMK_DEBOUNCE_GROUP_CONFIG(INST_DEBOUNCE_PRESS_MS(n),                    \
+                                                     INST_DEBOUNCE_RELEASE_MS(n),                  \
+                                                     DT_INST_PROP(n, debounce_scan_period_ms)),    \
         .debounce_scan_period_ms = DT_INST_PROP(n, debounce_scan_period_ms),                       \
         .poll_period_ms = DT_INST_PROP(n, poll_period_ms),                                         \
         .diode_direction = INST_DIODE_DIR(n),                                                      \
@@ -0,0 +1,74 @@
+/*
+ * Copyright (c) 2024 The ZMK Contributors
+ *
+ * SPDX-License-Identifier: MIT
+ */
+
+#include "kscan_gpio_matrix_benchmark.h"
+
+#include <stdlib.h>
+
+#include <zephyr/kernel.h>
+#include <zephyr/sys/printk.h>
+#include <zephyr/sys/util.h>
+
+#if IS_ENABLED(CONFIG_GPIO_EMUL)
+#include <zephyr/drivers/gpio/gpio_emul.h>
+
+// Toggle one emulated input this often, so presses, releases and debouncing are measured as well
+// as idle scans.
+#define BENCH_TOGGLE_SCANS 20
+#endif
+
+#include <zmk/benchmark.h>
+
+static uint32_t strobe_ns[CONFIG_ZMK_KSCAN_MATRIX_BENCHMARK_MAX_SAMPLES];
+static uint32_t strobe_count;
+static uint32_t scan_count;
+static uint64_t strobe_start_ns;
+
+void kscan_matrix_benchmark_strobe_start(void) { strobe_start_ns = zmk_benchmark_host_ns(); }
+
+void kscan_matrix_benchmark_strobe_end(void) {
+    if (strobe_count < ARRAY_SIZE(strobe_ns)) {
+        strobe_ns[strobe_count++] =
+            (uint32_t)MIN(zmk_benchmark_host_ns() - strobe_start_ns, UINT32_MAX);
+    }
+}
+
+static void report(void) {
+    uint64_t total_ns = 0;
+
+    if (strobe_count == 0) {
+        return;
+    }
+
+    for (int i = 0; i < strobe_count; i++) {
+        total_ns += strobe_ns[i];
+    }
+
+    zmk_benchmark_sort_samples(strobe_ns, strobe_count);
+
+    printk("benchmark: scans %u strobes %u\n", scan_count, strobe_count);
+    printk("benchmark: strobe mean %u ns p50 %u ns p99 %u ns max %u ns\n",
+           (uint32_t)(total_ns / strobe_count), strobe_ns[strobe_count / 2],
+           strobe_ns[strobe_count * 99 / 100], strobe_ns[strobe_count - 1]);
+}
+
+void kscan_matrix_benchmark_scan_done(const struct kscan_gpio_list *inputs) {
+    if (++scan_count == CONFIG_ZMK_KSCAN_MATRIX_BENCHMARK_SCANS) {
+        report();
+        exit(0);
+    }
+
+#if IS_ENABLED(CONFIG_GPIO_EMUL)
+    if (scan_count % BENCH_TOGGLE_SCANS == 0) {
+        // Raise each input in turn, then lower each in turn on the next pass.
+        const uint32_t toggle = scan_count / BENCH_TOGGLE_SCANS;
+        const struct kscan_gpio *gpio = &inputs->gpios[toggle % inputs->len];
+        const bool raise = (toggle / inputs->len) % 2 == 0;
+
+        gpio_emul_input_set(gpio->spec.port, gpio->spec.pin, raise);
+    }
+#endif
+}
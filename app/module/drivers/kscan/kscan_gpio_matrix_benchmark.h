@@ -0,0 +1,31 @@
+/*
+ * Copyright (c) 2024 The ZMK Contributors
+ *
+ * SPDX-License-Identifier: MIT
+ */
+
+#pragma once
+
+#include "kscan_gpio.h"
+
+#if IS_ENABLED(CONFIG_ZMK_KSCAN_MATRIX_BENCHMARK)
+
+/** Called before an output is strobed. */
+void kscan_matrix_benchmark_strobe_start(void);
+
+/** Called once an output's inputs have been read and debounced. */
+void kscan_matrix_benchmark_strobe_end(void);
+
+/**
+ * Called after each scan of the matrix. Prints the results and exits once enough scans have been
+ * measured.
+ */
+void kscan_matrix_benchmark_scan_done(const struct kscan_gpio_list *inputs);
+
+#else
+
+static inline void kscan_matrix_benchmark_strobe_start(void) {}
+static inline void kscan_matrix_benchmark_strobe_end(void) {}
+static inline void kscan_matrix_benchmark_scan_done(const struct kscan_gpio_list *inputs) {}
+
+#endif // IS_ENABLED(CONFIG_ZMK_KSCAN_MATRIX_BENCHMARK)
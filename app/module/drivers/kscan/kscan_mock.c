@@ -20,6 +20,7 @@ struct kscan_mock_data {
     kscan_callback_t callback;
 
     uint32_t event_index;
+    uint32_t repeat_index;
     struct k_work_delayable work;
     const struct device *dev;
 };
@@ -39,15 +40,113 @@ static int kscan_mock_configure(const struct device *dev, kscan_callback_t callb
     }
 
     data->event_index = 0;
+    data->repeat_index = 0;
     data->callback = callback;
 
     return 0;
 }
 
+#if IS_ENABLED(CONFIG_ZMK_KSCAN_MOCK_BENCHMARK)
+
+#include <zmk/benchmark.h>
+
+#define BENCH_STACK_PAINT 0xAA
+#define BENCH_STACK_PAINT_SIZE CONFIG_ZMK_KSCAN_MOCK_BENCHMARK_STACK_PAINT_SIZE
+
+#if CONFIG_HEAP_MEM_POOL_SIZE > 0 && IS_ENABLED(CONFIG_SYS_HEAP_RUNTIME_STATS)
+extern struct k_heap _system_heap;
+#endif
+
+static uint32_t bench_latencies[CONFIG_ZMK_KSCAN_MOCK_BENCHMARK_MAX_SAMPLES];
+static uint32_t bench_latency_count;
+static uint32_t bench_event_count;
+static uint64_t bench_start_ns;
+static uint64_t bench_last_ns;
+static size_t bench_peak_stack;
+
+// native_posix threads run on host stacks that Zephyr's stack analysis can't see, so paint the
+// stack below the mock's work handler and check how much of it the following work items used.
+static void __noinline bench_paint_stack(void) {
+    volatile uint8_t buf[BENCH_STACK_PAINT_SIZE];
+
+    for (size_t i = 0; i < sizeof(buf); i++) {
+        buf[i] = BENCH_STACK_PAINT;
+    }
+}
+
+static size_t __noinline bench_stack_used(void) {
+    volatile uint8_t buf[BENCH_STACK_PAINT_SIZE];
+    size_t i = 0;
+
+    while (i < sizeof(buf) && buf[i] == BENCH_STACK_PAINT) {
+        i++;
+    }
+
+    return sizeof(buf) - i;
+}
+
+// Called at the start of each mock event. Time passes on the host only while the CPU is busy, so
+// the time since the previous mock event is the time spent processing it, including any timers
+// that expired in between.
+static void bench_event(void) {
+    uint64_t now = zmk_benchmark_host_ns();
+
+    if (bench_event_count == 0) {
+        bench_start_ns = now;
+    } else {
+        bench_peak_stack = MAX(bench_peak_stack, bench_stack_used());
+
+        if (bench_latency_count < ARRAY_SIZE(bench_latencies)) {
+            bench_latencies[bench_latency_count++] = (uint32_t)MIN(now - bench_last_ns, UINT32_MAX);
+        }
+    }
+
+    bench_paint_stack();
+    bench_event_count++;
+
+    // Exclude the stack analysis from the measurements.
+    uint64_t after = zmk_benchmark_host_ns();
+    bench_start_ns += after - now;
+    bench_last_ns = after;
+}
+
+static void bench_report(void) {
+    if (bench_latency_count == 0) {
+        return;
+    }
+
+    uint32_t elapsed_us = (uint32_t)((bench_last_ns - bench_start_ns) / NSEC_PER_USEC);
+
+    zmk_benchmark_sort_samples(bench_latencies, bench_latency_count);
+
+    printk("benchmark: events %u elapsed %u us events/sec %u\n", bench_latency_count, elapsed_us,
+           (uint32_t)((uint64_t)bench_latency_count * USEC_PER_SEC / MAX(elapsed_us, 1)));
+    printk("benchmark: latency p50 %u ns p99 %u ns max %u ns\n",
+           bench_latencies[bench_latency_count / 2],
+           bench_latencies[bench_latency_count * 99 / 100],
+           bench_latencies[bench_latency_count - 1]);
+    printk("benchmark: peak stack %zu bytes\n", bench_peak_stack);
+
+#if CONFIG_HEAP_MEM_POOL_SIZE > 0 && IS_ENABLED(CONFIG_SYS_HEAP_RUNTIME_STATS)
+    struct sys_memory_stats stats;
+
+    sys_heap_runtime_stats_get(&_system_heap.heap, &stats);
+    printk("benchmark: peak heap %zu bytes\n", stats.max_allocated_bytes);
+#endif
+}
+
+#else
+
+static inline void bench_event(void) {}
+static inline void bench_report(void) {}
+
+#endif // IS_ENABLED(CONFIG_ZMK_KSCAN_MOCK_BENCHMARK)
+
 #define MOCK_INST_INIT(n)                                                                          \
     struct kscan_mock_config_##n {                                                                 \
         uint32_t events[DT_INST_PROP_LEN(n, events)];                                              \
         bool exit_after;                                                                           \
+        uint32_t repeat;                                                                           \
     };                                                                                             \
     static void kscan_mock_schedule_next_event_##n(const struct device *dev) {                     \
         struct kscan_mock_data *data = dev->data;                                                  \
@@ -58,6 +157,7 @@ static int kscan_mock_configure(const struct device *dev, kscan_callback_t callb
             k_work_schedule(&data->work, K_MSEC(ZMK_MOCK_MSEC(ev)));                               \
         } else if (cfg->exit_after) {                                                              \
             LOG_DBG("Exiting");                                                                    \
+            bench_report();                                                                        \
             exit(0);                                                                               \
         }                                                                                          \
     }                                                                                              \
@@ -66,11 +166,16 @@ static int kscan_mock_configure(const struct device *dev, kscan_callback_t callb
         struct kscan_mock_data *data = CONTAINER_OF(d_work, struct kscan_mock_data, work);         \
         const struct kscan_mock_config_##n *cfg = data->dev->config;                               \
         uint32_t ev = cfg->events[data->event_index];                                              \
+        bench_event();                                                                             \
         LOG_DBG("ev %u row %d column %d state %d\n", ev, ZMK_MOCK_ROW(ev), ZMK_MOCK_COL(ev),       \
                 ZMK_MOCK_IS_PRESS(ev));                                                            \
         data->callback(data->dev, ZMK_MOCK_ROW(ev), ZMK_MOCK_COL(ev), ZMK_MOCK_IS_PRESS(ev));      \
         kscan_mock_schedule_next_event_##n(data->dev);                                             \
         data->event_index++;                                                                       \
+        if (data->event_index == DT_INST_PROP_LEN(n, events) &&                                    \
+            ++data->repeat_index < cfg->repeat) {                                                  \
+            data->event_index = 0;                                                                 \
+        }                                                                                          \
     }                                                                                              \
     static int kscan_mock_init_##n(const struct device *dev) {                                     \
         struct kscan_mock_data *data = dev->data;                                                  \
@@ -89,7 +194,9 @@ static int kscan_mock_configure(const struct device *dev, kscan_callback_t callb
     };                                                                                             \
     static struct kscan_mock_data kscan_mock_data_##n;                                             \
     static const struct kscan_mock_config_##n kscan_mock_config_##n = {                            \
-        .events = DT_INST_PROP(n, events), .exit_after = DT_INST_PROP(n, exit_after)};             \
+        .events = DT_INST_PROP(n, events),                                                         \
+        .exit_after = DT_INST_PROP(n, exit_after),                                                 \
+        .repeat = DT_INST_PROP(n, repeat)};                                                        \
     DEVICE_DT_INST_DEFINE(n, kscan_mock_init_##n, NULL, &kscan_mock_data_##n,                      \
                           &kscan_mock_config_##n, POST_KERNEL, CONFIG_KSCAN_INIT_PRIORITY,         \
                           &mock_driver_api_##n);
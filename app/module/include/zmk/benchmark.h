@@ -0,0 +1,23 @@
+/*
+ * Copyright (c) 2024 The ZMK Contributors
+ *
+ * SPDX-License-Identifier: MIT
+ */
+
+#pragma once
+
+#include <stddef.h>
+#include <stdint.h>
+
+/**
+ * @brief Get the host's monotonic time in nanoseconds.
+ *
+ * Simulated time on native_posix only advances while the CPU is idle, so benchmarks time their
+ * work with the host clock instead.
+ */
+uint64_t zmk_benchmark_host_ns(void);
+
+/**
+ * @brief Sort timing samples in ascending order, so percentiles can be read by index.
+ */
+void zmk_benchmark_sort_samples(uint32_t *samples, size_t count);
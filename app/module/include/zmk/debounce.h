@@ -54,3 +54,65 @@ bool zmk_debounce_is_pressed(const struct zmk_debounce_state *state);
  * debounce_update.
  */
 bool zmk_debounce_get_changed(const struct zmk_debounce_state *state);
+
+/**
+ * Number of bits in the per-switch counters of a zmk_debounce_group_state. Debounce thresholds can
+ * be at most ZMK_DEBOUNCE_GROUP_MAX_SCANS scans long.
+ */
+#define ZMK_DEBOUNCE_GROUP_COUNTER_BITS 8
+#define ZMK_DEBOUNCE_GROUP_MAX_SCANS BIT_MASK(ZMK_DEBOUNCE_GROUP_COUNTER_BITS)
+
+/** A bitmap of switches in a zmk_debounce_group_state. */
+typedef uint32_t zmk_debounce_mask_t;
+
+#define ZMK_DEBOUNCE_GROUP_SIZE (sizeof(zmk_debounce_mask_t) * 8)
+
+/**
+ * State for debouncing up to ZMK_DEBOUNCE_GROUP_SIZE switches at once. Bit n of each field belongs
+ * to switch n. The counters are stored bit-sliced, so counter[b] holds bit b of every switch's
+ * counter and all switches can be updated with a few operations per counter bit.
+ */
+struct zmk_debounce_group_state {
+    zmk_debounce_mask_t pressed;
+    zmk_debounce_mask_t counter[ZMK_DEBOUNCE_GROUP_COUNTER_BITS];
+};
+
+/**
+ * Debounce settings for zmk_debounce_group_update(), in numbers of scans.
+ */
+struct zmk_debounce_group_config {
+    /** Number of scans a switch must be pressed to latch as pressed. */
+    uint16_t debounce_press_scans;
+    /** Number of scans a switch must be released to latch as released. */
+    uint16_t debounce_release_scans;
+};
+
+/**
+ * Initializer for a zmk_debounce_group_config from times in milliseconds. This debounces the same
+ * as zmk_debounce_update() with a constant elapsed_ms of scan_period_ms.
+ */
+#define ZMK_DEBOUNCE_GROUP_CONFIG(press_ms, release_ms, scan_period_ms)                            \
+    {                                                                                              \
+        .debounce_press_scans = DIV_ROUND_UP(press_ms, scan_period_ms),                            \
+        .debounce_release_scans = DIV_ROUND_UP(release_ms, scan_period_ms),                        \
+    }
+
+/**
+ * Debounces a group of switches.
+ *
+ * @param state The state for the switches to debounce.
+ * @param active Bitmap of the switches which are currently pressed.
+ * @param config Debounce settings.
+ *
+ * @returns a bitmap of the switches whose pressed state changed.
+ */
+zmk_debounce_mask_t zmk_debounce_group_update(struct zmk_debounce_group_state *state,
+                                              zmk_debounce_mask_t active,
+                                              const struct zmk_debounce_group_config *config);
+
+/**
+ * @returns a bitmap of the switches which are either latched as pressed or potentially pressed
+ * with the debouncer not yet having made a decision. If this is non-zero, the kscan driver should
+ * continue to poll quickly.
+ */
+zmk_debounce_mask_t zmk_debounce_group_active(const struct zmk_debounce_group_state *state);
@@ -0,0 +1,30 @@
+/*
+ * Copyright (c) 2024 The ZMK Contributors
+ *
+ * SPDX-License-Identifier: MIT
+ */
+
+#include <stdlib.h>
+#include <time.h>
+
+#include <zephyr/sys_clock.h>
+
+#include <zmk/benchmark.h>
+
+uint64_t zmk_benchmark_host_ns(void) {
+    struct timespec ts;
+
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (uint64_t)ts.tv_sec * NSEC_PER_SEC + ts.tv_nsec;
+}
+
+static int sample_cmp(const void *a, const void *b) {
+    uint32_t x = *(const uint32_t *)a;
+    uint32_t y = *(const uint32_t *)b;
+
+    return (x > y) - (x < y);
+}
+
+void zmk_benchmark_sort_samples(uint32_t *samples, size_t count) {
+    qsort(samples, count, sizeof(samples[0]), sample_cmp);
+}
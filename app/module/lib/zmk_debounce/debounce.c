@@ -59,4 +59,86 @@ bool zmk_debounce_is_active(const struct zmk_debounce_state *state) {
 
 bool zmk_debounce_is_pressed(const struct zmk_debounce_state *state) { return state->pressed; }
 
-bool zmk_debounce_get_changed(const struct zmk_debounce_state *state) { return state->changed; }
\ No newline at end of file
+bool zmk_debounce_get_changed(const struct zmk_debounce_state *state) { return state->changed; }
+
+// The group debouncer implements the same integrator as zmk_debounce_update(), but counting scans
+// instead of milliseconds so the counters can be stored as bit-sliced vertical counters.
+
+static zmk_debounce_mask_t group_counting(const struct zmk_debounce_group_state *state) {
+    zmk_debounce_mask_t counting = 0;
+
+    for (int b = 0; b < ZMK_DEBOUNCE_GROUP_COUNTER_BITS; b++) {
+        counting |= state->counter[b];
+    }
+
+    return counting;
+}
+
+static zmk_debounce_mask_t group_counter_at_least(const struct zmk_debounce_group_state *state,
+                                                  const uint16_t threshold) {
+    // Compare from the most significant bit down. A counter is greater than the threshold once it
+    // has a 1 where the threshold has a 0 and all higher bits are equal.
+    zmk_debounce_mask_t greater = 0;
+    zmk_debounce_mask_t equal = ~(zmk_debounce_mask_t)0;
+
+    for (int b = ZMK_DEBOUNCE_GROUP_COUNTER_BITS - 1; b >= 0; b--) {
+        if (threshold & BIT(b)) {
+            equal &= state->counter[b];
+        } else {
+            greater |= equal & state->counter[b];
+            equal &= ~state->counter[b];
+        }
+    }
+
+    return greater | equal;
+}
+
+static void group_increment(struct zmk_debounce_group_state *state, zmk_debounce_mask_t mask) {
+    for (int b = 0; b < ZMK_DEBOUNCE_GROUP_COUNTER_BITS && mask; b++) {
+        const zmk_debounce_mask_t carry = state->counter[b] & mask;
+        state->counter[b] ^= mask;
+        mask = carry;
+    }
+}
+
+static void group_decrement(struct zmk_debounce_group_state *state, zmk_debounce_mask_t mask) {
+    for (int b = 0; b < ZMK_DEBOUNCE_GROUP_COUNTER_BITS && mask; b++) {
+        const zmk_debounce_mask_t borrow = ~state->counter[b] & mask;
+        state->counter[b] ^= mask;
+        mask = borrow;
+    }
+}
+
+zmk_debounce_mask_t zmk_debounce_group_update(struct zmk_debounce_group_state *state,
+                                              const zmk_debounce_mask_t active,
+                                              const struct zmk_debounce_group_config *config) {
+    const zmk_debounce_mask_t mismatched = active ^ state->pressed;
+    const zmk_debounce_mask_t counting = group_counting(state);
+
+    if (!(mismatched | counting)) {
+        return 0;
+    }
+
+    // Pressed switches flip at the release threshold, and released switches at the press one.
+    const zmk_debounce_mask_t at_threshold =
+        (state->pressed & group_counter_at_least(state, config->debounce_release_scans)) |
+        (~state->pressed & group_counter_at_least(state, config->debounce_press_scans));
+
+    const zmk_debounce_mask_t flipped = mismatched & at_threshold;
+
+    // Counters below their threshold never exceed it, so they can't overflow.
+    group_increment(state, mismatched & ~at_threshold);
+    group_decrement(state, ~mismatched & counting);
+
+    for (int b = 0; b < ZMK_DEBOUNCE_GROUP_COUNTER_BITS; b++) {
+        state->counter[b] &= ~flipped;
+    }
+
+    state->pressed ^= flipped;
+
+    return flipped;
+}
+
+zmk_debounce_mask_t zmk_debounce_group_active(const struct zmk_debounce_group_state *state) {
+    return state->pressed | group_counting(state);
+}
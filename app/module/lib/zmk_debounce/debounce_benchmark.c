@@ -0,0 +1,141 @@
+/*
+ * Copyright (c) 2024 The ZMK Contributors
+ *
+ * SPDX-License-Identifier: MIT
+ */
+
+#include <stdlib.h>
+
+#include <zephyr/init.h>
+#include <zephyr/kernel.h>
+#include <zephyr/sys/printk.h>
+#include <zephyr/sys/util.h>
+
+#include <zmk/benchmark.h>
+#include <zmk/debounce.h>
+
+#define BENCH_GROUPS 4
+#define BENCH_SWITCHES (BENCH_GROUPS * ZMK_DEBOUNCE_GROUP_SIZE)
+
+#define BENCH_SCAN_PERIOD_MS 1
+#define BENCH_PRESS_MS 5
+#define BENCH_RELEASE_MS 10
+
+// Each scan, a switch starts a new press or release with probability 1/BENCH_TOGGLE_ODDS, then
+// reads a random level for BENCH_BOUNCE_SCANS scans before settling.
+#define BENCH_TOGGLE_ODDS 64
+#define BENCH_BOUNCE_SCANS 3
+
+static const struct zmk_debounce_config key_config = {
+    .debounce_press_ms = BENCH_PRESS_MS,
+    .debounce_release_ms = BENCH_RELEASE_MS,
+};
+
+static const struct zmk_debounce_group_config group_config =
+    ZMK_DEBOUNCE_GROUP_CONFIG(BENCH_PRESS_MS, BENCH_RELEASE_MS, BENCH_SCAN_PERIOD_MS);
+
+static struct zmk_debounce_state key_state[BENCH_SWITCHES];
+static struct zmk_debounce_group_state group_state[BENCH_GROUPS];
+
+static bool level[BENCH_SWITCHES];
+static uint8_t bouncing[BENCH_SWITCHES];
+
+static uint32_t rng_state = 0x2545f491;
+
+static uint32_t bench_rand(void) {
+    // xorshift32, so every run simulates the same input.
+    rng_state ^= rng_state << 13;
+    rng_state ^= rng_state >> 17;
+    rng_state ^= rng_state << 5;
+    return rng_state;
+}
+
+static void bench_read_inputs(zmk_debounce_mask_t active[BENCH_GROUPS]) {
+    for (int i = 0; i < BENCH_GROUPS; i++) {
+        active[i] = 0;
+    }
+
+    for (int i = 0; i < BENCH_SWITCHES; i++) {
+        if (bouncing[i] == 0 && bench_rand() % BENCH_TOGGLE_ODDS == 0) {
+            level[i] = !level[i];
+            bouncing[i] = BENCH_BOUNCE_SCANS;
+        }
+
+        bool active_now = level[i];
+        if (bouncing[i] > 0) {
+            bouncing[i]--;
+            active_now = bench_rand() & 1;
+        }
+
+        if (active_now) {
+            active[i / ZMK_DEBOUNCE_GROUP_SIZE] |= BIT(i % ZMK_DEBOUNCE_GROUP_SIZE);
+        }
+    }
+}
+
+static int debounce_benchmark(void) {
+    uint64_t key_ns = 0;
+    uint64_t group_ns = 0;
+    uint32_t changes = 0;
+    uint32_t mismatches = 0;
+
+    for (int scan = 0; scan < CONFIG_ZMK_DEBOUNCE_BENCHMARK_SCANS; scan++) {
+        zmk_debounce_mask_t active[BENCH_GROUPS];
+        zmk_debounce_mask_t key_changed[BENCH_GROUPS] = {0};
+        zmk_debounce_mask_t group_changed[BENCH_GROUPS];
+
+        bench_read_inputs(active);
+
+        uint64_t start = zmk_benchmark_host_ns();
+
+        for (int i = 0; i < BENCH_SWITCHES; i++) {
+            const int group = i / ZMK_DEBOUNCE_GROUP_SIZE;
+            const zmk_debounce_mask_t bit = BIT(i % ZMK_DEBOUNCE_GROUP_SIZE);
+
+            zmk_debounce_update(&key_state[i], active[group] & bit, BENCH_SCAN_PERIOD_MS,
+                                &key_config);
+            if (zmk_debounce_get_changed(&key_state[i])) {
+                key_changed[group] |= bit;
+            }
+        }
+
+        uint64_t mid = zmk_benchmark_host_ns();
+
+        for (int i = 0; i < BENCH_GROUPS; i++) {
+            group_changed[i] = zmk_debounce_group_update(&group_state[i], active[i], &group_config);
+        }
+
+        uint64_t end = zmk_benchmark_host_ns();
+
+        key_ns += mid - start;
+        group_ns += end - mid;
+
+        for (int i = 0; i < BENCH_SWITCHES; i++) {
+            const int group = i / ZMK_DEBOUNCE_GROUP_SIZE;
+            const zmk_debounce_mask_t bit = BIT(i % ZMK_DEBOUNCE_GROUP_SIZE);
+
+            const bool changed = key_changed[group] & bit;
+            const bool pressed = zmk_debounce_is_pressed(&key_state[i]);
+            const bool active = zmk_debounce_is_active(&key_state[i]);
+
+            changes += changed;
+            if (changed != ((group_changed[group] & bit) != 0) ||
+                pressed != ((group_state[group].pressed & bit) != 0) ||
+                active != ((zmk_debounce_group_active(&group_state[group]) & bit) != 0)) {
+                mismatches++;
+            }
+        }
+    }
+
+    printk("benchmark: %u switches, %u scans, %u changes\n", (uint32_t)BENCH_SWITCHES,
+           CONFIG_ZMK_DEBOUNCE_BENCHMARK_SCANS, changes);
+    printk("benchmark: per-switch %u ns/scan\n",
+           (uint32_t)(key_ns / CONFIG_ZMK_DEBOUNCE_BENCHMARK_SCANS));
+    printk("benchmark: grouped %u ns/scan\n",
+           (uint32_t)(group_ns / CONFIG_ZMK_DEBOUNCE_BENCHMARK_SCANS));
+    printk("benchmark: mismatches %u\n", mismatches);
+
+    exit(mismatches > 0);
+}
+
+SYS_INIT(debounce_benchmark, APPLICATION, CONFIG_APPLICATION_INIT_PRIORITY);
@@ -0,0 +1,106 @@
+#!/bin/sh
+
+# Copyright (c) 2024 The ZMK Contributors
+# SPDX-License-Identifier: MIT
+
+##
+# Optional environment variables, paths can be absolute or relative to $(pwd):
+#  ZMK_SRC_DIR:             Path to zmk/app (default is ./)
+#  ZMK_BUILD_DIR:           Path to build directory (default is $ZMK_SRC_DIR/build)
+#  ZMK_EXTRA_MODULES:       Path to at most one module (in addition to any in west.yml)
+#  ZMK_BENCHMARKS_VERBOSE:  Be more verbose
+
+if [ -z "$1" ]; then
+    echo "Usage: ./run-benchmark.sh <path to benchmark>"
+    exit 1
+fi
+
+path="$1"
+if [ $path = "all" ]; then
+    path="${ZMK_SRC_DIR-.}/benchmarks"
+fi
+
+ZMK_BUILD_DIR=${ZMK_BUILD_DIR:-${ZMK_SRC_DIR:-.}/build}
+mkdir -p ${ZMK_BUILD_DIR}/benchmarks
+
+# Benchmarks are run one at a time so they don't compete for the CPU. Split benchmarks keep the
+# config of each half in central/ and peripheral/ subdirectories.
+benchmarks=$(find $path -name native_posix_64.keymap -exec dirname \{\} \; |
+    sed -E -e "s#/(central|peripheral)/?\$##" | sort -u)
+num_benchmarks=$(echo "$benchmarks" | wc -l)
+if [ $num_benchmarks -gt 1 ] || [ "$benchmarks" != "$path" ]; then
+    err=0
+    for benchmark in $benchmarks; do
+        ${0} $benchmark || err=1
+    done
+    exit $err
+fi
+
+benchmark=$(realpath $path | sed -n -e "s|.*/benchmarks/||p")
+echo "Running $benchmark:"
+
+build() {
+    build_cmd="west build ${ZMK_SRC_DIR:+-s $ZMK_SRC_DIR} -d $2 \
+        -b native_posix_64 -p -- -DZMK_CONFIG="$(realpath $1)" \
+        -DCONFIG_ZMK_KSCAN_MOCK_BENCHMARK=y -DCONFIG_SYS_HEAP_RUNTIME_STATS=y -DCONFIG_LOG=n \
+        ${ZMK_EXTRA_MODULES:+-DZMK_EXTRA_MODULES="$(realpath ${ZMK_EXTRA_MODULES})"}"
+
+    if [ -z ${ZMK_BENCHMARKS_VERBOSE} ]; then
+        $build_cmd >/dev/null 2>&1
+    else
+        $build_cmd
+    fi
+
+    if [ $? -gt 0 ]; then
+        echo "FAILED: $benchmark did not build"
+        exit 1
+    fi
+}
+
+# Prints the pseudo-terminal a native_posix process connected its second UART to.
+uart_1_pty() {
+    for i in $(seq 50); do
+        pty=$(sed -n -e "s/^UART_1 connected to pseudotty: //p" $1)
+        if [ -n "$pty" ]; then
+            echo $pty
+            return
+        fi
+        sleep 0.1
+    done
+}
+
+build_dir=${ZMK_BUILD_DIR}/benchmarks/$benchmark
+
+if [ ! -d $path/central ]; then
+    build $path $build_dir
+
+    $build_dir/zephyr/zmk.exe |
+        tee $build_dir/benchmark_full.log |
+        sed -n -e "s/^benchmark: /  /p"
+    exit
+fi
+
+# The halves run as two processes, with their split UARTs linked by socat.
+if ! command -v socat >/dev/null; then
+    echo "FAILED: $benchmark needs socat to link the split halves"
+    exit 1
+fi
+
+build $path/central $build_dir/central
+build $path/peripheral $build_dir/peripheral
+
+$build_dir/peripheral/zephyr/zmk.exe >$build_dir/peripheral.log 2>&1 &
+peripheral_pid=$!
+$build_dir/central/zephyr/zmk.exe >$build_dir/benchmark_full.log 2>&1 &
+central_pid=$!
+
+socat $(uart_1_pty $build_dir/peripheral.log),raw,echo=0 \
+    $(uart_1_pty $build_dir/benchmark_full.log),raw,echo=0 &
+socat_pid=$!
+
+wait $central_pid
+status=$?
+kill $peripheral_pid $socat_pid 2>/dev/null
+
+sed -n -e "s/^benchmark: /  /p" $build_dir/benchmark_full.log
+exit $status
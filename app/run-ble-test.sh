@@ -140,4 +140,8 @@ if [ $? -gt 0 ]; then
 fi
 
 echo "PASS: $testcase" | tee -a ./build/tests/pass-fail.log
+
+# Report how long split peripherals took to become usable after connecting to the central.
+sed -E -n -e "s/^d_00: .*: (Peripheral [0-9]+ .* ms after connecting.*)$/  \1/p" build/$testcase/output.log
+
 exit 0
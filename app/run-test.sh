@@ -10,6 +10,7 @@
 #  ZMK_EXTRA_MODULES:       Path to at most one module (in addition to any in west.yml)
 #  ZMK_TESTS_VERBOSE:       Be more verbose
 #  ZMK_TESTS_AUTO_ACCEPT:   Replace snapshot files with new key events
+#  ZMK_TESTS_LATENCY_TRACE: Enable latency tracing and print per-stage latency histograms
 #  J:                       Number of parallel jobs (default is 4)
 
 if [ -z "$1" ]; then
@@ -40,7 +41,8 @@ echo "Running $testcase:"
 
 build_cmd="west build ${ZMK_SRC_DIR:+-s $ZMK_SRC_DIR} -d ${ZMK_BUILD_DIR}/tests/$testcase \
     -b native_posix_64 -p -- -DCONFIG_ASSERT=y -DZMK_CONFIG="$(realpath $path)" \
-    ${ZMK_EXTRA_MODULES:+-DZMK_EXTRA_MODULES="$(realpath ${ZMK_EXTRA_MODULES})"}"
+    ${ZMK_EXTRA_MODULES:+-DZMK_EXTRA_MODULES="$(realpath ${ZMK_EXTRA_MODULES})"} \
+    ${ZMK_TESTS_LATENCY_TRACE:+-DCONFIG_ZMK_LATENCY_TRACE=y -DCONFIG_ZMK_LATENCY_TRACE_LOG_DELAY_MS=1}"
 
 if [ -z ${ZMK_TESTS_VERBOSE} ]; then
     $build_cmd >/dev/null 2>&1
@@ -60,6 +62,11 @@ ${ZMK_BUILD_DIR}/tests/$testcase/zephyr/zmk.exe |
     tee ${ZMK_BUILD_DIR}/tests/$testcase/keycode_events_full.log |
     sed -n -f $path/events.patterns >${ZMK_BUILD_DIR}/tests/$testcase/keycode_events.log
 
+if [ -n "${ZMK_TESTS_LATENCY_TRACE}" ]; then
+    python3 ${ZMK_SRC_DIR:-.}/scripts/latency_histogram.py \
+        ${ZMK_BUILD_DIR}/tests/$testcase/keycode_events_full.log
+fi
+
 diff -auZ $path/keycode_events.snapshot ${ZMK_BUILD_DIR}/tests/$testcase/keycode_events.log
 if [ $? -gt 0 ]; then
     if [ -f $path/pending ]; then
@@ -0,0 +1,81 @@
+# Copyright (c) 2024 The ZMK Contributors
+# SPDX-License-Identifier: MIT
+"""Print per-stage latency histograms from CONFIG_ZMK_LATENCY_TRACE_LOG output."""
+
+import argparse
+import re
+import sys
+from collections import defaultdict
+
+TRACE_RE = re.compile(r"trace (\d+) (\w+) (\S+) \+(\d+) ns")
+
+# Upper bounds of the histogram buckets, in microseconds.
+BUCKETS_US = [10, 50, 100, 250, 500, 1000, 2000, 5000, 10000]
+
+
+def bucket_label(i):
+    if i == len(BUCKETS_US):
+        return f">{BUCKETS_US[-1]} us"
+    return f"<={BUCKETS_US[i]} us"
+
+
+def bucket_index(us):
+    for i, bound in enumerate(BUCKETS_US):
+        if us <= bound:
+            return i
+    return len(BUCKETS_US)
+
+
+def parse(lines):
+    """Return a dict of stage name to a list of latencies in microseconds since the key scan."""
+    stages = defaultdict(list)
+    for line in lines:
+        match = TRACE_RE.search(line)
+        if not match:
+            continue
+
+        _, stage, label, ns = match.groups()
+        name = stage if label == "-" else f"{stage}:{label}"
+        stages[name].append(int(ns) / 1000)
+
+    return stages
+
+
+def print_histograms(stages):
+    for name, values in sorted(stages.items(), key=lambda kv: min(kv[1])):
+        values.sort()
+        print(
+            f"{name}: n={len(values)} min={values[0]:.1f} us "
+            f"p50={values[len(values) // 2]:.1f} us max={values[-1]:.1f} us"
+        )
+
+        counts = [0] * (len(BUCKETS_US) + 1)
+        for us in values:
+            counts[bucket_index(us)] += 1
+
+        for i, count in enumerate(counts):
+            if count:
+                print(f"  {bucket_label(i):>10} {count:6} {'#' * min(count, 60)}")
+
+
+def main():
+    parser = argparse.ArgumentParser(description=__doc__)
+    parser.add_argument(
+        "log",
+        nargs="?",
+        type=argparse.FileType("r"),
+        default=sys.stdin,
+        help="log file to read (default is stdin)",
+    )
+    args = parser.parse_args()
+
+    stages = parse(args.log)
+    if not stages:
+        print("No latency trace records found", file=sys.stderr)
+        sys.exit(1)
+
+    print_histograms(stages)
+
+
+if __name__ == "__main__":
+    main()
@@ -17,15 +17,15 @@
 
 #endif
 
-#include <zmk/ble.h>
-#if ZMK_BLE_IS_CENTRAL
-#include <zmk/split/bluetooth/central.h>
+#if IS_ENABLED(CONFIG_ZMK_SPLIT_ROLE_CENTRAL)
+#include <zmk/split/central.h>
 #endif
 
 #include <drivers/behavior.h>
 #include <zmk/behavior.h>
 #include <zmk/hid.h>
 #include <zmk/matrix.h>
+#include <zmk/latency_trace.h>
 
 #include <zmk/events/position_state_changed.h>
 
@@ -56,6 +56,26 @@ const struct device *z_impl_behavior_get_binding(const char *name) {
     return NULL;
 }
 
+const struct device *zmk_behavior_get_binding_device(const struct zmk_behavior_binding *binding) {
+#if IS_ENABLED(CONFIG_ZMK_BEHAVIOR_DEVICES_IN_BINDINGS)
+    if (binding->device) {
+        return device_is_ready(binding->device) ? binding->device : NULL;
+    }
+#endif // IS_ENABLED(CONFIG_ZMK_BEHAVIOR_DEVICES_IN_BINDINGS)
+
+    return zmk_behavior_get_binding(binding->behavior_dev);
+}
+
+int zmk_behavior_resolve_binding(struct zmk_behavior_binding *binding) {
+    const struct device *behavior = zmk_behavior_get_binding(binding->behavior_dev);
+
+#if IS_ENABLED(CONFIG_ZMK_BEHAVIOR_DEVICES_IN_BINDINGS)
+    binding->device = behavior;
+#endif // IS_ENABLED(CONFIG_ZMK_BEHAVIOR_DEVICES_IN_BINDINGS)
+
+    return behavior ? 0 : -ENODEV;
+}
+
 static int invoke_locally(struct zmk_behavior_binding *binding,
                           struct zmk_behavior_binding_event event, bool pressed) {
     if (pressed) {
@@ -71,7 +91,9 @@ int zmk_behavior_invoke_binding(const struct zmk_behavior_binding *src_binding,
     // relative to absolute before being invoked
     struct zmk_behavior_binding binding = *src_binding;
 
-    const struct device *behavior = zmk_behavior_get_binding(binding.behavior_dev);
+    zmk_latency_trace_record(ZMK_LATENCY_TRACE_STAGE_BEHAVIOR, binding.behavior_dev);
+
+    const struct device *behavior = zmk_behavior_get_binding_device(&binding);
 
     if (!behavior) {
         LOG_WRN("No behavior assigned to %d on layer %d", event.position, event.layer);
@@ -95,19 +117,19 @@ int zmk_behavior_invoke_binding(const struct zmk_behavior_binding *src_binding,
     case BEHAVIOR_LOCALITY_CENTRAL:
         return invoke_locally(&binding, event, pressed);
     case BEHAVIOR_LOCALITY_EVENT_SOURCE:
-#if ZMK_BLE_IS_CENTRAL // source is a member of event because CONFIG_ZMK_SPLIT is enabled
+#if IS_ENABLED(CONFIG_ZMK_SPLIT_ROLE_CENTRAL) // source is a member of event on split centrals
         if (event.source == ZMK_POSITION_STATE_CHANGE_SOURCE_LOCAL) {
             return invoke_locally(&binding, event, pressed);
         } else {
-            return zmk_split_bt_invoke_behavior(event.source, &binding, event, pressed);
+            return zmk_split_central_invoke_behavior(event.source, &binding, event, pressed);
         }
 #else
         return invoke_locally(&binding, event, pressed);
 #endif
     case BEHAVIOR_LOCALITY_GLOBAL:
-#if ZMK_BLE_IS_CENTRAL
-        for (int i = 0; i < ZMK_SPLIT_BLE_PERIPHERAL_COUNT; i++) {
-            zmk_split_bt_invoke_behavior(i, &binding, event, pressed);
+#if IS_ENABLED(CONFIG_ZMK_SPLIT_ROLE_CENTRAL)
+        for (int i = 0; i < ZMK_SPLIT_CENTRAL_PERIPHERAL_COUNT; i++) {
+            zmk_split_central_invoke_behavior(i, &binding, event, pressed);
         }
 #endif
         return invoke_locally(&binding, event, pressed);
@@ -240,7 +262,7 @@ int zmk_behavior_check_params_match_metadata(const struct behavior_parameter_met
 
 int zmk_behavior_validate_binding(const struct zmk_behavior_binding *binding) {
 #if IS_ENABLED(CONFIG_ZMK_BEHAVIOR_METADATA)
-    const struct device *behavior = zmk_behavior_get_binding(binding->behavior_dev);
+    const struct device *behavior = zmk_behavior_get_binding_device(binding);
 
     if (!behavior) {
         return -ENODEV;
@@ -286,6 +308,71 @@ const char *zmk_behavior_find_behavior_name_from_local_id(zmk_behavior_local_id_
     return NULL;
 }
 
+// Once every behavior has its local ID, the map is sorted by ID so behaviors can be found from
+// their ID with a binary search.
+static bool local_id_map_sorted;
+
+static void sort_local_id_map(void) {
+    struct zmk_behavior_local_id_map *map;
+    int count;
+
+    STRUCT_SECTION_GET(zmk_behavior_local_id_map, 0, &map);
+    STRUCT_SECTION_COUNT(zmk_behavior_local_id_map, &count);
+
+    for (int i = 1; i < count; i++) {
+        struct zmk_behavior_local_id_map item = map[i];
+        int j = i;
+
+        for (; j > 0 && map[j - 1].local_id > item.local_id; j--) {
+            map[j] = map[j - 1];
+        }
+
+        map[j] = item;
+    }
+
+    local_id_map_sorted = true;
+}
+
+const struct device *zmk_behavior_get_device_from_local_id(zmk_behavior_local_id_t local_id) {
+    if (!local_id_map_sorted) {
+        STRUCT_SECTION_FOREACH(zmk_behavior_local_id_map, item) {
+            if (item->local_id == local_id && z_device_is_ready(item->device)) {
+                return item->device;
+            }
+        }
+
+        return NULL;
+    }
+
+    struct zmk_behavior_local_id_map *map;
+    int count;
+
+    STRUCT_SECTION_GET(zmk_behavior_local_id_map, 0, &map);
+    STRUCT_SECTION_COUNT(zmk_behavior_local_id_map, &count);
+
+    int low = 0;
+    int high = count;
+
+    while (low < high) {
+        int mid = low + (high - low) / 2;
+
+        if (map[mid].local_id < local_id) {
+            low = mid + 1;
+        } else {
+            high = mid;
+        }
+    }
+
+    // CRC16 IDs can collide, so check every behavior with the ID.
+    for (int i = low; i < count && map[i].local_id == local_id; i++) {
+        if (z_device_is_ready(map[i].device)) {
+            return map[i].device;
+        }
+    }
+
+    return NULL;
+}
+
 #if IS_ENABLED(CONFIG_ZMK_BEHAVIOR_LOCAL_ID_TYPE_CRC16)
 
 static int behavior_local_id_init(void) {
@@ -293,6 +380,8 @@ static int behavior_local_id_init(void) {
         item->local_id = crc16_ansi(item->device->name, strlen(item->device->name));
     }
 
+    sort_local_id_map();
+
     return 0;
 }
 
@@ -365,6 +454,8 @@ static int behavior_handle_commit(void) {
         settings_save_one(setting_name, device_name, strlen(device_name));
     }
 
+    sort_local_id_map();
+
     return 0;
 }
 
@@ -6,77 +6,232 @@
 
 #include <zmk/behavior_queue.h>
 #include <zmk/behavior.h>
+#include <zmk/endpoints.h>
+#include <zmk/timer.h>
 
+#include <zephyr/init.h>
 #include <zephyr/kernel.h>
 #include <zephyr/logging/log.h>
+#include <zephyr/sys/slist.h>
 #include <drivers/behavior.h>
 
 LOG_MODULE_DECLARE(zmk, CONFIG_ZMK_LOG_LEVEL);
 
 struct q_item {
+    sys_snode_t node;
     uint32_t position;
 #if IS_ENABLED(CONFIG_ZMK_SPLIT)
     uint8_t source;
 #endif
+    // The binding to invoke, or the one with the parameters for the steps of a sequence.
     struct zmk_behavior_binding binding;
     bool press : 1;
     uint32_t wait : 31;
+    // Set for sequences, which stay at the head of their lane until all of their steps have run.
+    zmk_behavior_queue_step_cb step;
+    const void *sequence;
+    uint16_t next_step;
+    uint16_t steps_count;
 };
 
-K_MSGQ_DEFINE(zmk_behavior_queue_msgq, sizeof(struct q_item), CONFIG_ZMK_BEHAVIORS_QUEUE_SIZE, 4);
+// Items in a lane run in order, but separate lanes run independently of each other.
+struct q_lane {
+    sys_slist_t items;
+    uint32_t count;
+    // Position of the event that queued the items, so later items from it go in the same lane.
+    uint32_t position;
+    // Time the item at the head of the lane is due.
+    int64_t deadline;
+    struct zmk_timer timer;
+    // Set while running items, so items queued by a behavior being invoked are run by the loop
+    // that invoked it instead of restarting the timer.
+    bool busy;
+};
+
+static struct q_item items[CONFIG_ZMK_BEHAVIORS_QUEUE_SIZE];
+static sys_slist_t free_items;
+static uint32_t free_count;
+
+static struct q_lane lanes[CONFIG_ZMK_BEHAVIORS_QUEUE_LANES];
+
+// Guards the free list and the lanes, which are changed by the callers queueing items and by the
+// timer work queue running them.
+static struct k_spinlock lock;
+
+static bool lane_is_active(const struct q_lane *lane) {
+    return lane->busy || lane->count > 0 || zmk_timer_is_pending(&lane->timer);
+}
+
+// Items from a position already in a lane join it. Otherwise they take an idle lane, or share the
+// lane with the fewest items if every lane is active.
+static struct q_lane *lane_for_position(uint32_t position) {
+    struct q_lane *idle = NULL;
+    struct q_lane *shortest = &lanes[0];
+
+    for (int i = 0; i < ARRAY_SIZE(lanes); i++) {
+        struct q_lane *lane = &lanes[i];
+
+        if (!lane_is_active(lane)) {
+            if (!idle) {
+                idle = lane;
+            }
+        } else if (lane->position == position) {
+            return lane;
+        } else if (lane->count < shortest->count) {
+            shortest = lane;
+        }
+    }
+
+    return idle ? idle : shortest;
+}
+
+static void behavior_queue_process_next(struct q_lane *lane) {
+    sys_snode_t *node;
 
-static void behavior_queue_process_next(struct k_work *work);
-static K_WORK_DELAYABLE_DEFINE(queue_work, behavior_queue_process_next);
+    zmk_endpoints_report_transaction_begin();
 
-static void behavior_queue_process_next(struct k_work *work) {
-    struct q_item item = {.wait = 0};
+    k_spinlock_key_t key = k_spin_lock(&lock);
 
-    while (k_msgq_get(&zmk_behavior_queue_msgq, &item, K_NO_WAIT) == 0) {
-        LOG_DBG("Invoking %s: 0x%02x 0x%02x", item.binding.behavior_dev, item.binding.param1,
-                item.binding.param2);
+    lane->busy = true;
 
-        struct zmk_behavior_binding_event event = {.position = item.position,
+    while ((node = sys_slist_peek_head(&lane->items)) != NULL) {
+        struct q_item *item = CONTAINER_OF(node, struct q_item, node);
+        struct zmk_behavior_binding binding = item->binding;
+        bool press = item->press;
+        uint32_t wait = item->wait;
+
+        if (item->step) {
+            wait = item->step(item->sequence, item->next_step++, &item->binding, &binding, &press);
+        }
+
+        struct zmk_behavior_binding_event event = {.position = item->position,
                                                    .timestamp = k_uptime_get(),
 #if IS_ENABLED(CONFIG_ZMK_SPLIT)
-                                                   .source = item.source
+                                                   .source = item->source
 #endif
         };
 
-        if (item.press) {
-            zmk_behavior_invoke_binding(&item.binding, event, true);
-        } else {
-            zmk_behavior_invoke_binding(&item.binding, event, false);
+        // Free the entry before invoking its last step, so the behavior can queue another one.
+        if (!item->step || item->next_step == item->steps_count) {
+            sys_slist_get(&lane->items);
+            lane->count--;
+
+            sys_slist_append(&free_items, &item->node);
+            free_count++;
         }
 
-        LOG_DBG("Processing next queued behavior in %dms", item.wait);
+        k_spin_unlock(&lock, key);
+
+        LOG_DBG("Invoking %s: 0x%02x 0x%02x", binding.behavior_dev, binding.param1,
+                binding.param2);
+
+        zmk_behavior_invoke_binding(&binding, event, press);
+
+        LOG_DBG("Processing next queued behavior in %dms", wait);
 
-        if (item.wait > 0) {
-            k_work_schedule(&queue_work, K_MSEC(item.wait));
+        key = k_spin_lock(&lock);
+
+        if (wait > 0) {
+            // Waits are added to the deadline the item was due at rather than the time it ran, so
+            // the time spent invoking behaviors isn't added to every wait in the lane.
+            lane->deadline += wait;
+            zmk_timer_start_at(&lane->timer, lane->deadline);
             break;
         }
     }
+
+    lane->busy = false;
+
+    k_spin_unlock(&lock, key);
+
+    zmk_endpoints_report_transaction_end();
+}
+
+static void behavior_queue_timer_cb(struct zmk_timer *timer) {
+    behavior_queue_process_next(CONTAINER_OF(timer, struct q_lane, timer));
+}
+
+static int queue_item(const struct zmk_behavior_binding_event *event, const struct q_item *data) {
+    k_spinlock_key_t key = k_spin_lock(&lock);
+
+    sys_snode_t *node = sys_slist_get(&free_items);
+    if (!node) {
+        k_spin_unlock(&lock, key);
+        LOG_WRN("Behavior queue is full, dropping %s. Bump CONFIG_ZMK_BEHAVIORS_QUEUE_SIZE",
+                data->binding.behavior_dev);
+        return -ENOMEM;
+    }
+
+    struct q_item *item = CONTAINER_OF(node, struct q_item, node);
+    *item = *data;
+    item->position = event->position;
+#if IS_ENABLED(CONFIG_ZMK_SPLIT)
+    item->source = event->source;
+#endif
+    free_count--;
+
+    struct q_lane *lane = lane_for_position(event->position);
+    const bool idle = !lane_is_active(lane);
+
+    sys_slist_append(&lane->items, &item->node);
+    lane->count++;
+    lane->position = event->position;
+
+    // Items always run from the timer's work queue, even when the lane is idle, so behaviors
+    // queued from other threads are never invoked alongside the ones already running.
+    if (idle) {
+        lane->deadline = k_uptime_get();
+        zmk_timer_start_at(&lane->timer, lane->deadline);
+    }
+
+    k_spin_unlock(&lock, key);
+
+    return 0;
 }
 
 int zmk_behavior_queue_add(const struct zmk_behavior_binding_event *event,
                            const struct zmk_behavior_binding binding, bool press, uint32_t wait) {
-    struct q_item item = {
+    const struct q_item item = {
         .press = press,
         .binding = binding,
         .wait = wait,
-        .position = event->position,
-#if IS_ENABLED(CONFIG_ZMK_SPLIT)
-        .source = event->source,
-#endif
     };
 
-    const int ret = k_msgq_put(&zmk_behavior_queue_msgq, &item, K_NO_WAIT);
-    if (ret < 0) {
-        return ret;
+    return queue_item(event, &item);
+}
+
+int zmk_behavior_queue_add_sequence(const struct zmk_behavior_binding_event *event,
+                                    zmk_behavior_queue_step_cb step, const void *sequence,
+                                    uint16_t count, const struct zmk_behavior_binding params) {
+    if (count == 0) {
+        return 0;
     }
 
-    if (!k_work_delayable_is_pending(&queue_work)) {
-        behavior_queue_process_next(&queue_work.work);
+    const struct q_item item = {
+        .binding = params,
+        .step = step,
+        .sequence = sequence,
+        .steps_count = count,
+    };
+
+    return queue_item(event, &item);
+}
+
+uint32_t zmk_behavior_queue_free_count(void) { return free_count; }
+
+static int behavior_queue_init(void) {
+    sys_slist_init(&free_items);
+    for (int i = 0; i < ARRAY_SIZE(items); i++) {
+        sys_slist_append(&free_items, &items[i].node);
+    }
+    free_count = ARRAY_SIZE(items);
+
+    for (int i = 0; i < ARRAY_SIZE(lanes); i++) {
+        sys_slist_init(&lanes[i].items);
+        zmk_timer_init(&lanes[i].timer, behavior_queue_timer_cb);
     }
 
     return 0;
 }
+
+SYS_INIT(behavior_queue_init, POST_KERNEL, CONFIG_KERNEL_INIT_PRIORITY_DEFAULT);
@@ -14,10 +14,13 @@
 #include <zmk/behavior.h>
 #include <zmk/matrix.h>
 #include <zmk/endpoints.h>
+#include <zmk/event_capture.h>
 #include <zmk/event_manager.h>
 #include <zmk/events/position_state_changed.h>
 #include <zmk/events/keycode_state_changed.h>
 #include <zmk/behavior.h>
+#include <zmk/keymap.h>
+#include <zmk/timer.h>
 
 LOG_MODULE_DECLARE(zmk, CONFIG_ZMK_LOG_LEVEL);
 
@@ -54,8 +57,8 @@ enum decision_moment {
 
 struct behavior_hold_tap_config {
     int tapping_term_ms;
-    char *hold_behavior_dev;
-    char *tap_behavior_dev;
+    struct zmk_behavior_binding hold_binding;
+    struct zmk_behavior_binding tap_binding;
     int quick_tap_ms;
     int require_prior_idle_ms;
     enum flavor flavor;
@@ -84,8 +87,7 @@ struct active_hold_tap {
     int64_t timestamp;
     enum status status;
     const struct behavior_hold_tap_config *config;
-    struct k_work_delayable work;
-    bool work_is_cancelled;
+    struct zmk_timer timer;
 
     // initialized to -1, which is to be interpreted as "no other key has been pressed yet"
     int32_t position_of_first_other_key_pressed;
@@ -99,24 +101,7 @@ struct active_hold_tap {
 struct active_hold_tap *undecided_hold_tap = NULL;
 struct active_hold_tap active_hold_taps[ZMK_BHV_HOLD_TAP_MAX_HELD] = {};
 // We capture most position_state_changed events and some modifiers_state_changed events.
-
-enum captured_event_tag {
-    ET_NONE,
-    ET_POS_CHANGED,
-    ET_CODE_CHANGED,
-};
-
-union captured_event_data {
-    struct zmk_position_state_changed_event position;
-    struct zmk_keycode_state_changed_event keycode;
-};
-
-struct captured_event {
-    enum captured_event_tag tag;
-    union captured_event_data data;
-};
-
-struct captured_event captured_events[ZMK_BHV_HOLD_TAP_MAX_CAPTURED_EVENTS] = {};
+static ZMK_EVENT_CAPTURE_DEFINE(captured_events, ZMK_BHV_HOLD_TAP_MAX_CAPTURED_EVENTS);
 
 // Keep track of which key was tapped most recently for the standard, if it is a hold-tap
 // a position, will be given, if not it will just be INT32_MIN
@@ -150,96 +135,49 @@ static bool is_quick_tap(struct active_hold_tap *hold_tap) {
     }
 }
 
-static int capture_event(struct captured_event *data) {
-    for (int i = 0; i < ZMK_BHV_HOLD_TAP_MAX_CAPTURED_EVENTS; i++) {
-        if (captured_events[i].tag == ET_NONE) {
-            captured_events[i] = *data;
-            return 0;
-        }
-    }
-    return -ENOMEM;
-}
-
 static bool have_captured_keydown_event(uint32_t position) {
-    for (int i = 0; i < ZMK_BHV_HOLD_TAP_MAX_CAPTURED_EVENTS; i++) {
-        struct captured_event *ev = &captured_events[i];
-        if (ev->tag == ET_NONE) {
-            return false;
-        }
+    struct zmk_event_capture_slot *slot;
+    ZMK_EVENT_CAPTURE_FOR_EACH(&captured_events, slot) {
+        const struct zmk_position_state_changed *ev =
+            as_zmk_position_state_changed(&slot->event.header);
 
-        if (ev->tag != ET_POS_CHANGED) {
-            continue;
-        }
-
-        if (ev->data.position.data.position == position && ev->data.position.data.state) {
+        if (ev && ev->position == position && ev->state) {
             return true;
         }
     }
     return false;
 }
 
-const struct zmk_listener zmk_listener_behavior_hold_tap;
-
 static void release_captured_events() {
     if (undecided_hold_tap != NULL) {
         return;
     }
 
-    // We use a trick to prevent copying the captured_events array.
-    //
-    // Events for different mod-tap instances are separated by a NULL pointer.
-    //
-    // The first event popped will never be caught by the next active hold-tap
-    // because to start capturing a mod-tap-key-down event must first completely
-    // go through the events queue.
+    // Each event is raised again starting with this listener, so it may be captured again by a
+    // hold-tap that becomes undecided while the events are released. Once that hold-tap is decided,
+    // the events it captured are released ahead of the ones still waiting here.
     //
     // Example of this release process;
-    // [mt2_down, k1_down, k1_up, mt2_up, null, ...]
-    //  ^
+    // captured [mt2_down, k1_down, k1_up, mt2_up], releasing []
     // mt2_down position event isn't captured because no hold-tap is active.
     // mt2_down behavior event is handled, now we have an undecided hold-tap
-    // [null, k1_down, k1_up, mt2_up, null, ...]
-    //        ^
-    // k1_down  is captured by the mt2 mod-tap
-    // !note that searches for find_captured_keydown_event by the mt2 behavior will stop at the
-    // first null encountered [mt1_down, null, k1_up, mt2_up, null, ...]
-    //                  ^
+    // captured [], releasing [k1_down, k1_up, mt2_up]
+    // k1_down is captured by the mt2 mod-tap
+    // !note that searches for have_captured_keydown_event by the mt2 behavior only look at the
+    // captured events
+    // captured [k1_down], releasing [k1_up, mt2_up]
     // k1_up event is captured by the new hold-tap:
-    // [k1_down, k1_up, null, mt2_up, null, ...]
-    //                        ^
+    // captured [k1_down, k1_up], releasing [mt2_up]
     // mt2_up event is not captured but causes release of mt2 behavior
-    // [k1_down, k1_up, null, null, null, ...]
+    // captured [], releasing [k1_down, k1_up]
     // now mt2 will start releasing it's own captured positions.
-    for (int i = 0; i < ZMK_BHV_HOLD_TAP_MAX_CAPTURED_EVENTS; i++) {
-        struct captured_event *captured_event = &captured_events[i];
-        enum captured_event_tag tag = captured_event->tag;
-
-        if (tag == ET_NONE) {
-            return;
-        }
-
-        captured_events[i].tag = ET_NONE;
+    zmk_event_capture_begin_release(&captured_events);
+    while (zmk_event_capture_is_releasing(&captured_events)) {
         if (undecided_hold_tap != NULL) {
             k_msleep(10);
         }
 
-        switch (tag) {
-        case ET_CODE_CHANGED:
-            LOG_DBG("Releasing mods changed event 0x%02X %s",
-                    captured_event->data.keycode.data.keycode,
-                    (captured_event->data.keycode.data.state ? "pressed" : "released"));
-            ZMK_EVENT_RAISE_AT(captured_event->data.keycode, behavior_hold_tap);
-            break;
-        case ET_POS_CHANGED:
-            LOG_DBG("Releasing key position event for position %d %s",
-                    captured_event->data.position.data.position,
-                    (captured_event->data.position.data.state ? "pressed" : "released"));
-            ZMK_EVENT_RAISE_AT(captured_event->data.position, behavior_hold_tap);
-            break;
-        default:
-            LOG_ERR("Unhandled captured event type");
-            break;
-        }
+        zmk_event_capture_release_next(&captured_events);
     }
 }
 
@@ -277,7 +215,6 @@ static struct active_hold_tap *store_hold_tap(struct zmk_behavior_binding_event
 static void clear_hold_tap(struct active_hold_tap *hold_tap) {
     hold_tap->position = ZMK_BHV_HOLD_TAP_POSITION_NOT_USED;
     hold_tap->status = STATUS_UNDECIDED;
-    hold_tap->work_is_cancelled = false;
 }
 
 static void decide_balanced(struct active_hold_tap *hold_tap, enum decision_moment event) {
@@ -410,8 +347,8 @@ static int press_hold_binding(struct active_hold_tap *hold_tap) {
 #endif
     };
 
-    struct zmk_behavior_binding binding = {.behavior_dev = hold_tap->config->hold_behavior_dev,
-                                           .param1 = hold_tap->param_hold};
+    struct zmk_behavior_binding binding = hold_tap->config->hold_binding;
+    binding.param1 = hold_tap->param_hold;
     return zmk_behavior_invoke_binding(&binding, event, true);
 }
 
@@ -424,8 +361,8 @@ static int press_tap_binding(struct active_hold_tap *hold_tap) {
 #endif
     };
 
-    struct zmk_behavior_binding binding = {.behavior_dev = hold_tap->config->tap_behavior_dev,
-                                           .param1 = hold_tap->param_tap};
+    struct zmk_behavior_binding binding = hold_tap->config->tap_binding;
+    binding.param1 = hold_tap->param_tap;
     store_last_hold_tapped(hold_tap);
     return zmk_behavior_invoke_binding(&binding, event, true);
 }
@@ -439,8 +376,8 @@ static int release_hold_binding(struct active_hold_tap *hold_tap) {
 #endif
     };
 
-    struct zmk_behavior_binding binding = {.behavior_dev = hold_tap->config->hold_behavior_dev,
-                                           .param1 = hold_tap->param_hold};
+    struct zmk_behavior_binding binding = hold_tap->config->hold_binding;
+    binding.param1 = hold_tap->param_hold;
     return zmk_behavior_invoke_binding(&binding, event, false);
 }
 
@@ -453,8 +390,8 @@ static int release_tap_binding(struct active_hold_tap *hold_tap) {
 #endif
     };
 
-    struct zmk_behavior_binding binding = {.behavior_dev = hold_tap->config->tap_behavior_dev,
-                                           .param1 = hold_tap->param_tap};
+    struct zmk_behavior_binding binding = hold_tap->config->tap_binding;
+    binding.param1 = hold_tap->param_tap;
     return zmk_behavior_invoke_binding(&binding, event, false);
 }
 
@@ -605,7 +542,7 @@ static void update_hold_status_for_retro_tap(uint32_t ignore_position) {
 
 static int on_hold_tap_binding_pressed(struct zmk_behavior_binding *binding,
                                        struct zmk_behavior_binding_event event) {
-    const struct device *dev = zmk_behavior_get_binding(binding->behavior_dev);
+    const struct device *dev = zmk_behavior_get_binding_device(binding);
     const struct behavior_hold_tap_config *cfg = dev->config;
 
     if (undecided_hold_tap != NULL) {
@@ -632,10 +569,8 @@ static int on_hold_tap_binding_pressed(struct zmk_behavior_binding *binding,
 
     decide_hold_tap(hold_tap, HT_KEY_DOWN);
 
-    // if this behavior was queued we have to adjust the timer to only
-    // wait for the remaining time.
-    int32_t tapping_term_ms_left = (hold_tap->timestamp + cfg->tapping_term_ms) - k_uptime_get();
-    k_work_schedule(&hold_tap->work, K_MSEC(tapping_term_ms_left));
+    // if this behavior was queued the deadline may be sooner than a full tapping term from now.
+    zmk_timer_start_at(&hold_tap->timer, hold_tap->timestamp + cfg->tapping_term_ms);
 
     return ZMK_BEHAVIOR_OPAQUE;
 }
@@ -650,7 +585,7 @@ static int on_hold_tap_binding_released(struct zmk_behavior_binding *binding,
 
     // If these events were queued, the timer event may be queued too late or not at all.
     // We insert a timer event before the TH_KEY_UP event to verify.
-    int work_cancel_result = k_work_cancel_delayable(&hold_tap->work);
+    zmk_timer_stop(&hold_tap->timer);
     if (event.timestamp > (hold_tap->timestamp + hold_tap->config->tapping_term_ms)) {
         decide_hold_tap(hold_tap, HT_TIMER_EVENT);
     }
@@ -663,15 +598,8 @@ static int on_hold_tap_binding_released(struct zmk_behavior_binding *binding,
         release_hold_binding(hold_tap);
     }
 
-    if (work_cancel_result == -EINPROGRESS) {
-        // let the timer handler clean up
-        // if we'd clear now, the timer may call back for an uninitialized active_hold_tap.
-        LOG_DBG("%d hold-tap timer work in event queue", event.position);
-        hold_tap->work_is_cancelled = true;
-    } else {
-        LOG_DBG("%d cleaning up hold-tap", event.position);
-        clear_hold_tap(hold_tap);
-    }
+    LOG_DBG("%d cleaning up hold-tap", event.position);
+    clear_hold_tap(hold_tap);
 
     return ZMK_BEHAVIOR_OPAQUE;
 }
@@ -684,7 +612,7 @@ static int hold_tap_parameter_metadata(const struct device *hold_tap,
     int err;
     struct behavior_parameter_metadata child_meta;
 
-    err = behavior_get_parameter_metadata(zmk_behavior_get_binding(cfg->hold_behavior_dev),
+    err = behavior_get_parameter_metadata(zmk_behavior_get_binding_device(&cfg->hold_binding),
                                           &child_meta);
     if (err < 0) {
         LOG_WRN("Failed to get the hold behavior parameter: %d", err);
@@ -696,7 +624,7 @@ static int hold_tap_parameter_metadata(const struct device *hold_tap,
         data->set.param1_values_len = child_meta.sets[0].param1_values_len;
     }
 
-    err = behavior_get_parameter_metadata(zmk_behavior_get_binding(cfg->tap_behavior_dev),
+    err = behavior_get_parameter_metadata(zmk_behavior_get_binding_device(&cfg->tap_binding),
                                           &child_meta);
     if (err < 0) {
         LOG_WRN("Failed to get the tap behavior parameter: %d", err);
@@ -776,11 +704,14 @@ static int position_state_changed_listener(const zmk_event_t *eh) {
 
     LOG_DBG("%d capturing %d %s event", undecided_hold_tap->position, ev->position,
             ev->state ? "down" : "up");
-    struct captured_event capture = {
-        .tag = ET_POS_CHANGED,
-        .data = {.position = copy_raised_zmk_position_state_changed(ev)},
-    };
-    capture_event(&capture);
+    if (zmk_event_capture_add(&captured_events, eh) < 0) {
+        // Pass the event on rather than lose it, even though it goes ahead of the captured ones.
+        LOG_ERR("%d unable to capture %d %s event, bump CONFIG_ZMK_EVENT_CAPTURE_POOL_SIZE or "
+                "CONFIG_ZMK_BEHAVIOR_HOLD_TAP_MAX_CAPTURED_EVENTS",
+                undecided_hold_tap->position, ev->position, ev->state ? "down" : "up");
+        return ZMK_EV_EVENT_BUBBLE;
+    }
+
     decide_hold_tap(undecided_hold_tap, ev->state ? HT_OTHER_KEY_DOWN : HT_OTHER_KEY_UP);
     return ZMK_EV_EVENT_CAPTURED;
 }
@@ -813,9 +744,13 @@ static int keycode_state_changed_listener(const zmk_event_t *eh) {
     // if a undecided_hold_tap is active.
     LOG_DBG("%d capturing 0x%02X %s event", undecided_hold_tap->position, ev->keycode,
             ev->state ? "down" : "up");
-    struct captured_event capture = {
-        .tag = ET_CODE_CHANGED, .data = {.keycode = copy_raised_zmk_keycode_state_changed(ev)}};
-    capture_event(&capture);
+    if (zmk_event_capture_add(&captured_events, eh) < 0) {
+        LOG_ERR("%d unable to capture 0x%02X %s event, bump CONFIG_ZMK_EVENT_CAPTURE_POOL_SIZE or "
+                "CONFIG_ZMK_BEHAVIOR_HOLD_TAP_MAX_CAPTURED_EVENTS",
+                undecided_hold_tap->position, ev->keycode, ev->state ? "down" : "up");
+        return ZMK_EV_EVENT_BUBBLE;
+    }
+
     return ZMK_EV_EVENT_CAPTURED;
 }
 
@@ -833,15 +768,10 @@ ZMK_SUBSCRIPTION(behavior_hold_tap, zmk_position_state_changed);
 // this should be modifiers_state_changed, but unfrotunately that's not implemented yet.
 ZMK_SUBSCRIPTION(behavior_hold_tap, zmk_keycode_state_changed);
 
-void behavior_hold_tap_timer_work_handler(struct k_work *item) {
-    struct k_work_delayable *d_work = k_work_delayable_from_work(item);
-    struct active_hold_tap *hold_tap = CONTAINER_OF(d_work, struct active_hold_tap, work);
+void behavior_hold_tap_timer_handler(struct zmk_timer *timer) {
+    struct active_hold_tap *hold_tap = CONTAINER_OF(timer, struct active_hold_tap, timer);
 
-    if (hold_tap->work_is_cancelled) {
-        clear_hold_tap(hold_tap);
-    } else {
-        decide_hold_tap(hold_tap, HT_TIMER_EVENT);
-    }
+    decide_hold_tap(hold_tap, HT_TIMER_EVENT);
 }
 
 static int behavior_hold_tap_init(const struct device *dev) {
@@ -849,7 +779,7 @@ static int behavior_hold_tap_init(const struct device *dev) {
 
     if (init_first_run) {
         for (int i = 0; i < ZMK_BHV_HOLD_TAP_MAX_HELD; i++) {
-            k_work_init_delayable(&active_hold_taps[i].work, behavior_hold_tap_timer_work_handler);
+            zmk_timer_init(&active_hold_taps[i].timer, behavior_hold_tap_timer_handler);
             active_hold_taps[i].position = ZMK_BHV_HOLD_TAP_POSITION_NOT_USED;
         }
     }
@@ -860,8 +790,8 @@ static int behavior_hold_tap_init(const struct device *dev) {
 #define KP_INST(n)                                                                                 \
     static const struct behavior_hold_tap_config behavior_hold_tap_config_##n = {                  \
         .tapping_term_ms = DT_INST_PROP(n, tapping_term_ms),                                       \
-        .hold_behavior_dev = DEVICE_DT_NAME(DT_INST_PHANDLE_BY_IDX(n, bindings, 0)),               \
-        .tap_behavior_dev = DEVICE_DT_NAME(DT_INST_PHANDLE_BY_IDX(n, bindings, 1)),                \
+        .hold_binding = ZMK_KEYMAP_EXTRACT_BINDING(0, DT_DRV_INST(n)),                             \
+        .tap_binding = ZMK_KEYMAP_EXTRACT_BINDING(1, DT_DRV_INST(n)),                              \
         .quick_tap_ms = DT_INST_PROP(n, quick_tap_ms),                                             \
         .require_prior_idle_ms = DT_INST_PROP(n, global_quick_tap)                                 \
                                      ? DT_INST_PROP(n, quick_tap_ms)                               \
@@ -6,6 +6,8 @@
 
 #define DT_DRV_COMPAT zmk_behavior_input_two_axis
 
+#include <stdlib.h>
+
 #include <zephyr/device.h>
 #include <drivers/behavior.h>
 #include <zephyr/input/input.h>
@@ -13,23 +15,29 @@
 #include <zephyr/sys/util.h> // CLAMP
 
 #include <zmk/behavior.h>
+#include <zmk/timer.h>
 #include <dt-bindings/zmk/pointing.h>
 
 #if IS_ENABLED(CONFIG_ZMK_POINTING_SMOOTH_SCROLLING)
 #include <zmk/pointing/resolution_multipliers.h>
 #endif // IS_ENABLED(CONFIG_ZMK_POINTING_SMOOTH_SCROLLING)
 
+#include "behavior_input_two_axis.h"
+
 LOG_MODULE_DECLARE(zmk, CONFIG_ZMK_LOG_LEVEL);
 
 struct vector2d {
-    float x;
-    float y;
+    int32_t x;
+    int32_t y;
 };
 
 struct movement_state_1d {
-    float remainder;
+    // Fraction of a pixel left over from earlier ticks, in fixed point.
+    int32_t remainder;
     int16_t speed;
     int64_t start_time;
+    // Time up to which movement has been reported.
+    int64_t last_time;
 };
 
 struct movement_state_2d {
@@ -38,7 +46,8 @@ struct movement_state_2d {
 };
 
 struct behavior_input_two_axis_data {
-    struct k_work_delayable tick_work;
+    struct zmk_timer tick_timer;
+    int64_t tick_deadline;
     const struct device *dev;
 
     struct movement_state_2d state;
@@ -48,110 +57,95 @@ struct behavior_input_two_axis_config {
     int16_t x_code;
     int16_t y_code;
     uint16_t delay_ms;
-    uint16_t time_to_max_speed_ms;
     uint8_t trigger_period_ms;
-    // acceleration exponent 0: uniform speed
-    // acceleration exponent 1: uniform acceleration
-    // acceleration exponent 2: uniform jerk
-    uint8_t acceleration_exponent;
+    // Built from time-to-max-speed-ms and acceleration-exponent, which is 0 for uniform speed, 1
+    // for uniform acceleration and 2 for uniform jerk.
+    struct input_two_axis_curve curve;
 };
 
-#if CONFIG_MINIMAL_LIBC
-static float powf(float base, float exponent) {
-    // poor man's power implementation rounds the exponent down to the nearest integer.
-    float power = 1.0f;
-    for (; exponent >= 1.0f; exponent--) {
-        power = power * base;
+// Multiplying by this and shifting right by 32 bits divides by 1000, converting a speed in pixels
+// per second over a time in milliseconds to pixels.
+#define MS_PER_SEC_RECIPROCAL 4294967ULL
+
+// Keeps the product of a speed, its fraction and the time within 63 bits.
+#define MAX_MOVE_MS UINT8_MAX
+
+uint32_t input_two_axis_curve_speed(const struct input_two_axis_curve *curve, uint32_t ms) {
+    if (ms >= curve->time_to_max_speed_ms) {
+        return INPUT_TWO_AXIS_FP_ONE;
     }
-    return power;
+
+    // Calculate the speed based on MouseKeysAccel
+    // See https://en.wikipedia.org/wiki/Mouse_keys
+    const uint64_t position = ms * curve->ms_to_segment;
+    const uint32_t segment = position >> 32;
+    const uint32_t fraction =
+        (position >> (32 - INPUT_TWO_AXIS_FP_SHIFT)) & (INPUT_TWO_AXIS_FP_ONE - 1);
+    const uint32_t from = curve->points[segment];
+
+    return from + (((curve->points[segment + 1] - from) * fraction) >> INPUT_TWO_AXIS_FP_SHIFT);
 }
-#else
-#include <math.h>
-#endif
 
-static int64_t ticks_since_start(int64_t start, int64_t now, int64_t delay) {
-    if (start == 0) {
-        return 0;
-    }
-    int64_t move_duration = now - (start + delay);
-    // start can be in the future if there's a delay
-    if (move_duration < 0) {
-        move_duration = 0;
-    }
-    return move_duration;
+int32_t input_two_axis_move(int16_t max_speed, uint32_t speed_fraction, uint32_t elapsed_ms,
+                            int32_t *remainder) {
+    const uint64_t scaled =
+        (uint64_t)abs(max_speed) * speed_fraction * MIN(elapsed_ms, MAX_MOVE_MS);
+    const int32_t distance = (scaled * MS_PER_SEC_RECIPROCAL + BIT64(31)) >> 32;
+    const int32_t move = (max_speed < 0 ? -distance : distance) + *remainder;
+
+    // Truncate towards zero, keeping the fraction of a pixel with the same sign as the movement.
+    const int32_t whole = move / INPUT_TWO_AXIS_FP_ONE;
+    *remainder = move - whole * INPUT_TWO_AXIS_FP_ONE;
+
+    return whole;
 }
 
 #if IS_ENABLED(CONFIG_ZMK_POINTING_SMOOTH_SCROLLING)
 
-static uint8_t get_acceleration_exponent(const struct behavior_input_two_axis_config *config,
-                                         uint16_t code) {
+static bool is_accelerated(uint16_t code) {
     switch (code) {
     case INPUT_REL_WHEEL:
-        return (zmk_pointing_resolution_multipliers_get_current_profile().wheel > 0)
-                   ? 0
-                   : config->acceleration_exponent;
+        return zmk_pointing_resolution_multipliers_get_current_profile().wheel == 0;
     case INPUT_REL_HWHEEL:
-        return (zmk_pointing_resolution_multipliers_get_current_profile().hor_wheel > 0)
-                   ? 0
-                   : config->acceleration_exponent;
+        return zmk_pointing_resolution_multipliers_get_current_profile().hor_wheel == 0;
     default:
-        return config->acceleration_exponent;
+        return true;
     }
 }
 
 #else
 
-static inline uint8_t get_acceleration_exponent(const struct behavior_input_two_axis_config *config,
-                                                uint16_t code) {
-    return config->acceleration_exponent;
-}
+static inline bool is_accelerated(uint16_t code) { return true; }
 
 #endif // IS_ENABLED(CONFIG_ZMK_POINTING_SMOOTH_SCROLLING)
 
-static float speed(const struct behavior_input_two_axis_config *config, uint16_t code,
-                   float max_speed, int64_t duration_ticks) {
-    uint8_t accel_exp = get_acceleration_exponent(config, code);
-
-    if ((1000 * duration_ticks / CONFIG_SYS_CLOCK_TICKS_PER_SEC) > config->time_to_max_speed_ms ||
-        config->time_to_max_speed_ms == 0 || accel_exp == 0) {
-        return max_speed;
+// Each tick moves for the time since the previous one at the speed reached by now, so movement
+// stays smooth when ticks are late.
+static int32_t update_movement_1d(const struct behavior_input_two_axis_config *config,
+                                  uint16_t code, struct movement_state_1d *state, int64_t now) {
+    if (state->speed == 0) {
+        state->remainder = 0;
+        return 0;
     }
 
-    // Calculate the speed based on MouseKeysAccel
-    // See https://en.wikipedia.org/wiki/Mouse_keys
-    if (duration_ticks == 0) {
+    // start can be in the future if there's a delay
+    const int64_t move_start = state->start_time + config->delay_ms;
+    const int64_t move_from = MAX(move_start, state->last_time);
+    if (now <= move_from) {
         return 0;
     }
 
-    float time_fraction = (float)(1000 * duration_ticks / CONFIG_SYS_CLOCK_TICKS_PER_SEC) /
-                          config->time_to_max_speed_ms;
-    return max_speed * powf(time_fraction, accel_exp);
-}
-
-static void track_remainder(float *move, float *remainder) {
-    float new_move = *move + *remainder;
-    *remainder = new_move - (int)new_move;
-    *move = (int)new_move;
-}
-
-static float update_movement_1d(const struct behavior_input_two_axis_config *config, uint16_t code,
-                                struct movement_state_1d *state, int64_t now) {
-    float move = 0;
-    if (state->speed == 0) {
-        state->remainder = 0;
-        return move;
-    }
+    const uint32_t fraction =
+        is_accelerated(code)
+            ? input_two_axis_curve_speed(&config->curve, MIN(now - move_start, UINT32_MAX))
+            : INPUT_TWO_AXIS_FP_ONE;
 
-    int64_t move_duration = ticks_since_start(state->start_time, now, config->delay_ms);
-    LOG_DBG("Calculated speed: %f", speed(config, code, state->speed, move_duration));
-    move =
-        (move_duration > 0)
-            ? (speed(config, code, state->speed, move_duration) * config->trigger_period_ms / 1000)
-            : 0;
+    const int32_t speed = ((int64_t)state->speed * fraction) >> INPUT_TWO_AXIS_FP_SHIFT;
+    LOG_DBG("Calculated speed: %d", speed);
 
-    track_remainder(&(move), &(state->remainder));
+    state->last_time = now;
 
-    return move;
+    return input_two_axis_move(state->speed, fraction, now - move_from, &state->remainder);
 }
 static struct vector2d update_movement_2d(const struct behavior_input_two_axis_config *config,
                                           struct movement_state_2d *state, int64_t now) {
@@ -175,23 +169,19 @@ static bool should_be_working(struct behavior_input_two_axis_data *data) {
     return is_non_zero_2d_movement(&data->state);
 }
 
-static void tick_work_cb(struct k_work *work) {
-    struct k_work_delayable *d_work = k_work_delayable_from_work(work);
+static void tick_timer_cb(struct zmk_timer *timer) {
     struct behavior_input_two_axis_data *data =
-        CONTAINER_OF(d_work, struct behavior_input_two_axis_data, tick_work);
+        CONTAINER_OF(timer, struct behavior_input_two_axis_data, tick_timer);
     const struct device *dev = data->dev;
     const struct behavior_input_two_axis_config *cfg = dev->config;
 
-    uint64_t timestamp = k_uptime_ticks();
-
-    // LOG_INF("x start: %llu, y start: %llu, current timestamp: %llu", data->state.x.start_time,
-    //         data->state.y.start_time, timestamp);
+    int64_t timestamp = k_uptime_get();
 
     struct vector2d move = update_movement_2d(cfg, &data->state, timestamp);
 
     int ret = 0;
-    bool have_x = is_non_zero_1d_movement(move.x);
-    bool have_y = is_non_zero_1d_movement(move.y);
+    bool have_x = move.x != 0;
+    bool have_y = move.y != 0;
     if (have_x) {
         ret = input_report_rel(dev, cfg->x_code, (int16_t)CLAMP(move.x, INT16_MIN, INT16_MAX),
                                !have_y, K_NO_WAIT);
@@ -202,13 +192,21 @@ static void tick_work_cb(struct k_work *work) {
     }
 
     if (should_be_working(data)) {
-        k_work_schedule(&data->tick_work, K_MSEC(cfg->trigger_period_ms));
+        // Each deadline follows on from the previous one so ticks keep the configured rate, but
+        // skip ahead instead of bunching up if they fell behind.
+        data->tick_deadline += cfg->trigger_period_ms;
+        if (data->tick_deadline <= timestamp) {
+            data->tick_deadline = timestamp + cfg->trigger_period_ms;
+        }
+
+        zmk_timer_start_at(&data->tick_timer, data->tick_deadline);
     }
 }
 
 static void set_start_times_for_activity_1d(struct movement_state_1d *state) {
     if (state->speed != 0 && state->start_time == 0) {
-        state->start_time = k_uptime_ticks();
+        state->start_time = k_uptime_get();
+        state->last_time = state->start_time;
     } else if (state->speed == 0) {
         state->start_time = 0;
     }
@@ -225,9 +223,12 @@ static void update_work_scheduling(const struct device *dev) {
     set_start_times_for_activity(&data->state);
 
     if (should_be_working(data)) {
-        k_work_schedule(&data->tick_work, K_MSEC(cfg->trigger_period_ms));
+        if (!zmk_timer_is_pending(&data->tick_timer)) {
+            data->tick_deadline = k_uptime_get() + cfg->trigger_period_ms;
+            zmk_timer_start_at(&data->tick_timer, data->tick_deadline);
+        }
     } else {
-        k_work_cancel_delayable(&data->tick_work);
+        zmk_timer_stop(&data->tick_timer);
         data->state.y.remainder = 0;
         data->state.x.remainder = 0;
     }
@@ -251,7 +252,7 @@ static int behavior_input_two_axis_init(const struct device *dev) {
     struct behavior_input_two_axis_data *data = dev->data;
 
     data->dev = dev;
-    k_work_init_delayable(&data->tick_work, tick_work_cb);
+    zmk_timer_init(&data->tick_timer, tick_timer_cb);
 
     return 0;
 };
@@ -259,7 +260,7 @@ static int behavior_input_two_axis_init(const struct device *dev) {
 static int on_keymap_binding_pressed(struct zmk_behavior_binding *binding,
                                      struct zmk_behavior_binding_event event) {
 
-    const struct device *behavior_dev = zmk_behavior_get_binding(binding->behavior_dev);
+    const struct device *behavior_dev = zmk_behavior_get_binding_device(binding);
 
     LOG_DBG("position %d keycode 0x%02X", event.position, binding->param1);
 
@@ -272,7 +273,7 @@ static int on_keymap_binding_pressed(struct zmk_behavior_binding *binding,
 
 static int on_keymap_binding_released(struct zmk_behavior_binding *binding,
                                       struct zmk_behavior_binding_event event) {
-    const struct device *behavior_dev = zmk_behavior_get_binding(binding->behavior_dev);
+    const struct device *behavior_dev = zmk_behavior_get_binding_device(binding);
 
     LOG_DBG("position %d keycode 0x%02X", event.position, binding->param1);
 
@@ -288,13 +289,20 @@ static const struct behavior_driver_api behavior_input_two_axis_driver_api = {
 
 #define ITA_INST(n)                                                                                \
     static struct behavior_input_two_axis_data behavior_input_two_axis_data_##n = {};              \
-    static struct behavior_input_two_axis_config behavior_input_two_axis_config_##n = {            \
+    BUILD_ASSERT(DT_INST_PROP(n, trigger_period_ms) > 0 &&                                         \
+                     DT_INST_PROP(n, trigger_period_ms) <= UINT8_MAX,                              \
+                 "trigger-period-ms must be between 1 and 255");                                   \
+    BUILD_ASSERT(DT_INST_PROP(n, time_to_max_speed_ms) <= UINT16_MAX,                              \
+                 "time-to-max-speed-ms must be at most 65535");                                    \
+    BUILD_ASSERT(DT_INST_PROP_OR(n, acceleration_exponent, 1) <= INPUT_TWO_AXIS_MAX_EXPONENT,      \
+                 "acceleration-exponent must be at most 4");                                       \
+    static const struct behavior_input_two_axis_config behavior_input_two_axis_config_##n = {      \
         .x_code = DT_INST_PROP(n, x_input_code),                                                   \
         .y_code = DT_INST_PROP(n, y_input_code),                                                   \
         .trigger_period_ms = DT_INST_PROP(n, trigger_period_ms),                                   \
         .delay_ms = DT_INST_PROP_OR(n, delay_ms, 0),                                               \
-        .time_to_max_speed_ms = DT_INST_PROP(n, time_to_max_speed_ms),                             \
-        .acceleration_exponent = DT_INST_PROP_OR(n, acceleration_exponent, 1),                     \
+        .curve = INPUT_TWO_AXIS_CURVE_INIT(DT_INST_PROP(n, time_to_max_speed_ms),                  \
+                                           DT_INST_PROP_OR(n, acceleration_exponent, 1)),          \
     };                                                                                             \
     BEHAVIOR_DT_INST_DEFINE(                                                                       \
         n, behavior_input_two_axis_init, NULL, &behavior_input_two_axis_data_##n,                  \
@@ -0,0 +1,74 @@
+/*
+ * Copyright (c) 2024 The ZMK Contributors
+ *
+ * SPDX-License-Identifier: MIT
+ */
+
+#pragma once
+
+#include <zephyr/kernel.h>
+#include <zephyr/sys/util.h>
+
+// Speeds and distances are fixed point numbers with this many fractional bits.
+#define INPUT_TWO_AXIS_FP_SHIFT 16
+#define INPUT_TWO_AXIS_FP_ONE (1 << INPUT_TWO_AXIS_FP_SHIFT)
+
+// An acceleration curve is stored as the speed at evenly spaced times from the start of the
+// movement to time-to-max-speed-ms, and interpolated linearly between them.
+#define INPUT_TWO_AXIS_CURVE_SEGMENTS 32
+#define INPUT_TWO_AXIS_MAX_EXPONENT 4
+
+struct input_two_axis_curve {
+    // Fraction of the maximum speed at the start of each segment, then at time-to-max-speed-ms.
+    uint32_t points[INPUT_TWO_AXIS_CURVE_SEGMENTS + 1];
+    // Converts milliseconds since the movement started to a segment, with 32 fractional bits.
+    uint64_t ms_to_segment;
+    uint16_t time_to_max_speed_ms;
+};
+
+#define Z_INPUT_TWO_AXIS_POW(base, exp)                                                            \
+    (((exp) > 0 ? (uint64_t)(base) : 1) * ((exp) > 1 ? (uint64_t)(base) : 1) *                    \
+     ((exp) > 2 ? (uint64_t)(base) : 1) * ((exp) > 3 ? (uint64_t)(base) : 1))
+
+#define Z_INPUT_TWO_AXIS_CURVE_POINT(i, exp)                                                       \
+    (uint32_t)(Z_INPUT_TWO_AXIS_POW(i, exp) * INPUT_TWO_AXIS_FP_ONE /                              \
+               Z_INPUT_TWO_AXIS_POW(INPUT_TWO_AXIS_CURVE_SEGMENTS, exp))
+
+/**
+ * Initializer for a curve that reaches the maximum speed after time_to_max_speed_ms, with the speed
+ * proportional to the time since the movement started raised to exponent. An exponent of 0 moves
+ * at the maximum speed right away. The table is computed at build time.
+ */
+#define INPUT_TWO_AXIS_CURVE_INIT(time_to_max_speed, exponent)                                     \
+    {                                                                                              \
+        .points = {LISTIFY(UTIL_INC(INPUT_TWO_AXIS_CURVE_SEGMENTS), Z_INPUT_TWO_AXIS_CURVE_POINT,  \
+                           (,), exponent)},                                                        \
+        .ms_to_segment =                                                                           \
+            (time_to_max_speed) > 0                                                                \
+                ? ((uint64_t)INPUT_TWO_AXIS_CURVE_SEGMENTS << 32) / (time_to_max_speed)            \
+                : 0,                                                                               \
+        .time_to_max_speed_ms = (time_to_max_speed),                                               \
+    }
+
+/**
+ * @brief Get the fraction of the maximum speed to move at.
+ *
+ * @param curve The acceleration curve.
+ * @param ms Milliseconds since the movement started.
+ * @return The fraction of the maximum speed, with INPUT_TWO_AXIS_FP_SHIFT fractional bits.
+ */
+uint32_t input_two_axis_curve_speed(const struct input_two_axis_curve *curve, uint32_t ms);
+
+/**
+ * @brief Get the distance to move in whole pixels, carrying the fraction of a pixel left over to
+ * the next call.
+ *
+ * @param max_speed The maximum speed in pixels per second.
+ * @param speed_fraction The fraction of the maximum speed to move at, from
+ *                       input_two_axis_curve_speed().
+ * @param elapsed_ms Milliseconds to move for.
+ * @param remainder The distance left over from earlier moves, with INPUT_TWO_AXIS_FP_SHIFT
+ *                  fractional bits.
+ */
+int32_t input_two_axis_move(int16_t max_speed, uint32_t speed_fraction, uint32_t elapsed_ms,
+                            int32_t *remainder);
@@ -25,26 +25,35 @@ struct behavior_macro_trigger_state {
     uint32_t wait_ms;
     uint32_t tap_ms;
     enum behavior_macro_mode mode;
-    uint16_t start_index;
-    uint16_t count;
     enum param_source param1_source;
     enum param_source param2_source;
 };
 
-struct behavior_macro_state {
-    struct behavior_macro_trigger_state release_state;
+// A press or release of an invokable binding of the macro, with the wait and parameter sources set
+// by the control bindings before it. Tapped bindings take two steps.
+struct behavior_macro_step {
+    const struct zmk_behavior_binding *binding;
+    uint32_t wait_ms;
+    bool press;
+    uint8_t param1_source;
+    uint8_t param2_source;
+};
 
+struct behavior_macro_state {
 #if IS_ENABLED(CONFIG_ZMK_BEHAVIOR_METADATA)
     struct behavior_parameter_metadata_set set;
 #endif // IS_ENABLED(CONFIG_ZMK_BEHAVIOR_METADATA)
 
-    uint32_t press_bindings_count;
+    // Steps before this index run on press, and the rest run on release.
+    uint16_t press_steps_count;
+    uint16_t steps_count;
 };
 
 struct behavior_macro_config {
     uint32_t default_wait_ms;
     uint32_t default_tap_ms;
     uint32_t count;
+    struct behavior_macro_step *steps;
     struct zmk_behavior_binding bindings[];
 };
 
@@ -111,28 +120,62 @@ static bool handle_control_binding(struct behavior_macro_trigger_state *state,
     return true;
 }
 
+// Control bindings are only matched against device names here. Each invokable binding is stored as
+// steps with the state set by the control bindings before it, so triggering the macro only has to
+// walk its steps.
 static int behavior_macro_init(const struct device *dev) {
     const struct behavior_macro_config *cfg = dev->config;
     struct behavior_macro_state *state = dev->data;
-    state->press_bindings_count = cfg->count;
-    state->release_state.start_index = cfg->count;
-    state->release_state.count = 0;
+    struct behavior_macro_trigger_state trigger_state = {.mode = MACRO_MODE_TAP,
+                                                         .tap_ms = cfg->default_tap_ms,
+                                                         .wait_ms = cfg->default_wait_ms};
+    // The release steps start from the modes, timings and parameter sources set by the control
+    // bindings before the pause, not from the macro's defaults. Parameter sources carry over even
+    // if a binding before the pause already used them.
+    struct behavior_macro_trigger_state release_state = {.mode = MACRO_MODE_TAP};
+    bool paused = false;
+
+    state->steps_count = 0;
 
-    LOG_DBG("Precalculate initial release state:");
+    LOG_DBG("Compile macro steps:");
     for (int i = 0; i < cfg->count; i++) {
-        if (handle_control_binding(&state->release_state, &cfg->bindings[i])) {
-            // Updated state used for initial state on release.
-        } else if (IS_PAUSE(cfg->bindings[i].behavior_dev)) {
-            state->release_state.start_index = i + 1;
-            state->release_state.count = cfg->count - state->release_state.start_index;
-            state->press_bindings_count = i;
-            LOG_DBG("Release will resume at %d", state->release_state.start_index);
-            break;
+        const struct zmk_behavior_binding *binding = &cfg->bindings[i];
+
+        if (handle_control_binding(&trigger_state, binding)) {
+            if (!paused) {
+                handle_control_binding(&release_state, binding);
+            }
+        } else if (!paused && IS_PAUSE(binding->behavior_dev)) {
+            paused = true;
+            state->press_steps_count = state->steps_count;
+            trigger_state = release_state;
+            LOG_DBG("Release will resume at step %d", state->steps_count);
         } else {
-            // Ignore regular invokable bindings
+            struct behavior_macro_step step = {
+                .binding = binding,
+                .wait_ms = trigger_state.wait_ms,
+                .press = trigger_state.mode != MACRO_MODE_RELEASE,
+                .param1_source = trigger_state.param1_source,
+                .param2_source = trigger_state.param2_source,
+            };
+
+            if (trigger_state.mode == MACRO_MODE_TAP) {
+                cfg->steps[state->steps_count] = step;
+                cfg->steps[state->steps_count++].wait_ms = trigger_state.tap_ms;
+                step.press = false;
+            }
+
+            cfg->steps[state->steps_count++] = step;
+
+            trigger_state.param1_source = PARAM_SOURCE_BINDING;
+            trigger_state.param2_source = PARAM_SOURCE_BINDING;
         }
     }
 
+    if (!paused) {
+        state->press_steps_count = state->steps_count;
+    }
+
     return 0;
 };
 
@@ -148,68 +191,86 @@ static uint32_t select_param(enum param_source param_source, uint32_t source_bin
     }
 };
 
-static void replace_params(struct behavior_macro_trigger_state *state,
-                           struct zmk_behavior_binding *binding,
-                           const struct zmk_behavior_binding *macro_binding) {
-    binding->param1 = select_param(state->param1_source, binding->param1, macro_binding);
-    binding->param2 = select_param(state->param2_source, binding->param2, macro_binding);
+static struct zmk_behavior_binding step_binding(const struct behavior_macro_step *step,
+                                                const struct zmk_behavior_binding *macro_binding) {
+    struct zmk_behavior_binding binding = *step->binding;
+
+    binding.param1 = select_param(step->param1_source, binding.param1, macro_binding);
+    binding.param2 = select_param(step->param2_source, binding.param2, macro_binding);
+
+    return binding;
+}
+
+#if IS_ENABLED(CONFIG_ZMK_MACRO_EXECUTOR)
+
+static uint32_t macro_step(const void *sequence, uint16_t index,
+                           const struct zmk_behavior_binding *macro_binding,
+                           struct zmk_behavior_binding *binding, bool *press) {
+    const struct behavior_macro_step *step = &((const struct behavior_macro_step *)sequence)[index];
+
+    *binding = step_binding(step, macro_binding);
+    *press = step->press;
 
-    state->param1_source = PARAM_SOURCE_BINDING;
-    state->param2_source = PARAM_SOURCE_BINDING;
+    return step->wait_ms;
 }
 
 static void queue_macro(struct zmk_behavior_binding_event *event,
-                        const struct zmk_behavior_binding bindings[],
-                        struct behavior_macro_trigger_state state,
-                        const struct zmk_behavior_binding *macro_binding) {
-    LOG_DBG("Iterating macro bindings - starting: %d, count: %d", state.start_index, state.count);
-    for (int i = state.start_index; i < state.start_index + state.count; i++) {
-        if (!handle_control_binding(&state, &bindings[i])) {
-            struct zmk_behavior_binding binding = bindings[i];
-            replace_params(&state, &binding, macro_binding);
-
-            switch (state.mode) {
-            case MACRO_MODE_TAP:
-                zmk_behavior_queue_add(event, binding, true, state.tap_ms);
-                zmk_behavior_queue_add(event, binding, false, state.wait_ms);
-                break;
-            case MACRO_MODE_PRESS:
-                zmk_behavior_queue_add(event, binding, true, state.wait_ms);
-                break;
-            case MACRO_MODE_RELEASE:
-                zmk_behavior_queue_add(event, binding, false, state.wait_ms);
-                break;
-            default:
-                LOG_ERR("Unknown macro mode: %d", state.mode);
-                break;
-            }
-        }
+                        const struct behavior_macro_config *cfg, uint16_t start_index,
+                        uint16_t count, const struct zmk_behavior_binding *macro_binding) {
+    if (count == 0) {
+        return;
     }
+
+    LOG_DBG("Queueing %d macro steps", count);
+
+    // The steps are looked up as they run, so the macro only takes one entry in the queue.
+    zmk_behavior_queue_add_sequence(event, macro_step, &cfg->steps[start_index], count,
+                                    *macro_binding);
 }
 
+#else
+
+static void queue_macro(struct zmk_behavior_binding_event *event,
+                        const struct behavior_macro_config *cfg, uint16_t start_index,
+                        uint16_t count, const struct zmk_behavior_binding *macro_binding) {
+    LOG_DBG("Iterating macro steps - starting: %d, count: %d", start_index, count);
+
+    // Queue all of the steps or none of them, so a full queue can't leave keys held down.
+    if (count > zmk_behavior_queue_free_count()) {
+        LOG_ERR("Dropping macro with %d queue entries, bump CONFIG_ZMK_BEHAVIORS_QUEUE_SIZE",
+                count);
+        return;
+    }
+
+    for (int i = start_index; i < start_index + count; i++) {
+        const struct behavior_macro_step *step = &cfg->steps[i];
+
+        zmk_behavior_queue_add(event, step_binding(step, macro_binding), step->press,
+                               step->wait_ms);
+    }
+}
+
+#endif // IS_ENABLED(CONFIG_ZMK_MACRO_EXECUTOR)
+
 static int on_macro_binding_pressed(struct zmk_behavior_binding *binding,
                                     struct zmk_behavior_binding_event event) {
-    const struct device *dev = zmk_behavior_get_binding(binding->behavior_dev);
+    const struct device *dev = zmk_behavior_get_binding_device(binding);
     const struct behavior_macro_config *cfg = dev->config;
-    struct behavior_macro_state *state = dev->data;
-    struct behavior_macro_trigger_state trigger_state = {.mode = MACRO_MODE_TAP,
-                                                         .tap_ms = cfg->default_tap_ms,
-                                                         .wait_ms = cfg->default_wait_ms,
-                                                         .start_index = 0,
-                                                         .count = state->press_bindings_count};
+    const struct behavior_macro_state *state = dev->data;
 
-    queue_macro(&event, cfg->bindings, trigger_state, binding);
+    queue_macro(&event, cfg, 0, state->press_steps_count, binding);
 
     return ZMK_BEHAVIOR_OPAQUE;
 }
 
 static int on_macro_binding_released(struct zmk_behavior_binding *binding,
                                      struct zmk_behavior_binding_event event) {
-    const struct device *dev = zmk_behavior_get_binding(binding->behavior_dev);
+    const struct device *dev = zmk_behavior_get_binding_device(binding);
     const struct behavior_macro_config *cfg = dev->config;
-    struct behavior_macro_state *state = dev->data;
+    const struct behavior_macro_state *state = dev->data;
 
-    queue_macro(&event, cfg->bindings, state->release_state, binding);
+    queue_macro(&event, cfg, state->press_steps_count,
+                state->steps_count - state->press_steps_count, binding);
 
     return ZMK_BEHAVIOR_OPAQUE;
 }
@@ -240,21 +301,21 @@ static int get_macro_parameter_metadata(const struct device *macro,
                                         struct behavior_parameter_metadata *param_metadata) {
     const struct behavior_macro_config *cfg = macro->config;
     struct behavior_macro_state *data = macro->data;
-    struct behavior_macro_trigger_state state = {0};
 
-    for (int i = 0; (i < cfg->count) && (!data->set.param1_values || !data->set.param2_values);
-         i++) {
-        if (handle_control_binding(&state, &cfg->bindings[i]) ||
-            (state.param1_source == PARAM_SOURCE_BINDING &&
-             state.param2_source == PARAM_SOURCE_BINDING)) {
+    for (int i = 0;
+         (i < data->steps_count) && (!data->set.param1_values || !data->set.param2_values); i++) {
+        const struct behavior_macro_step *step = &cfg->steps[i];
+
+        if (step->param1_source == PARAM_SOURCE_BINDING &&
+            step->param2_source == PARAM_SOURCE_BINDING) {
             continue;
         }
 
         LOG_DBG("checking %d for the given state", i);
 
         struct behavior_parameter_metadata binding_meta;
-        int err = behavior_get_parameter_metadata(
-            zmk_behavior_get_binding(cfg->bindings[i].behavior_dev), &binding_meta);
+        int err = behavior_get_parameter_metadata(zmk_behavior_get_binding_device(step->binding),
+                                                  &binding_meta);
         if (err < 0 || binding_meta.sets_len == 0) {
             LOG_WRN("Failed to fetch macro binding parameter details %d", err);
             return -ENOTSUP;
@@ -262,36 +323,33 @@ static int get_macro_parameter_metadata(const struct device *macro,
 
         // If both macro parameters get passed to this one entry, use
         // the metadata for this behavior verbatim.
-        if (state.param1_source != PARAM_SOURCE_BINDING &&
-            state.param2_source != PARAM_SOURCE_BINDING) {
+        if (step->param1_source != PARAM_SOURCE_BINDING &&
+            step->param2_source != PARAM_SOURCE_BINDING) {
             param_metadata->sets_len = binding_meta.sets_len;
             param_metadata->sets = binding_meta.sets;
             return 0;
         }
 
-        if (state.param1_source != PARAM_SOURCE_BINDING) {
-            assign_values_to_set(state.param1_source, &data->set,
+        if (step->param1_source != PARAM_SOURCE_BINDING) {
+            assign_values_to_set(step->param1_source, &data->set,
                                  binding_meta.sets[0].param1_values,
                                  binding_meta.sets[0].param1_values_len);
         }
 
-        if (state.param2_source != PARAM_SOURCE_BINDING) {
+        if (step->param2_source != PARAM_SOURCE_BINDING) {
             // For the param2 metadata, we need to find a set that matches fully bound first
             // parameter of our macro entry, and use the metadata from that set.
             for (int s = 0; s < binding_meta.sets_len; s++) {
                 if (zmk_behavior_validate_param_values(binding_meta.sets[s].param1_values,
                                                        binding_meta.sets[s].param1_values_len,
-                                                       cfg->bindings[i].param1) >= 0) {
-                    assign_values_to_set(state.param2_source, &data->set,
+                                                       step->binding->param1) >= 0) {
+                    assign_values_to_set(step->param2_source, &data->set,
                                          binding_meta.sets[s].param2_values,
                                          binding_meta.sets[s].param2_values_len);
                     break;
                 }
             }
         }
-
-        state.param1_source = PARAM_SOURCE_BINDING;
-        state.param2_source = PARAM_SOURCE_BINDING;
     }
 
     param_metadata->sets_len = 1;
@@ -314,11 +372,14 @@ static const struct behavior_driver_api behavior_macro_driver_api = {
     {LISTIFY(DT_PROP_LEN(n, bindings), ZMK_KEYMAP_EXTRACT_BINDING, (, ), n)},
 
 #define MACRO_INST(inst)                                                                           \
+    static struct behavior_macro_step                                                              \
+        behavior_macro_steps_##inst[2 * DT_PROP_LEN(inst, bindings)];                              \
     static struct behavior_macro_state behavior_macro_state_##inst = {};                           \
     static struct behavior_macro_config behavior_macro_config_##inst = {                           \
         .default_wait_ms = DT_PROP_OR(inst, wait_ms, CONFIG_ZMK_MACRO_DEFAULT_WAIT_MS),            \
         .default_tap_ms = DT_PROP_OR(inst, tap_ms, CONFIG_ZMK_MACRO_DEFAULT_TAP_MS),               \
         .count = DT_PROP_LEN(inst, bindings),                                                      \
+        .steps = behavior_macro_steps_##inst,                                                      \
         .bindings = TRANSFORMED_BEHAVIORS(inst)};                                                  \
     BEHAVIOR_DT_DEFINE(inst, behavior_macro_init, NULL, &behavior_macro_state_##inst,              \
                        &behavior_macro_config_##inst, POST_KERNEL,                                 \
@@ -34,7 +34,7 @@ static int on_keymap_binding_pressed(struct zmk_behavior_binding *binding,
                                      struct zmk_behavior_binding_event event) {
     LOG_DBG("position %d keycode 0x%02X", event.position, binding->param1);
 
-    process_key_state(zmk_behavior_get_binding(binding->behavior_dev), binding->param1, true);
+    process_key_state(zmk_behavior_get_binding_device(binding), binding->param1, true);
 
     return 0;
 }
@@ -43,7 +43,7 @@ static int on_keymap_binding_released(struct zmk_behavior_binding *binding,
                                       struct zmk_behavior_binding_event event) {
     LOG_DBG("position %d keycode 0x%02X", event.position, binding->param1);
 
-    process_key_state(zmk_behavior_get_binding(binding->behavior_dev), binding->param1, false);
+    process_key_state(zmk_behavior_get_binding_device(binding), binding->param1, false);
 
     return 0;
 }
@@ -0,0 +1,157 @@
+/*
+ * Copyright (c) 2024 The ZMK Contributors
+ *
+ * SPDX-License-Identifier: MIT
+ */
+
+#include <zephyr/init.h>
+#include <zephyr/kernel.h>
+#include <zephyr/sys/atomic.h>
+#include <zephyr/bluetooth/conn.h>
+
+#include <zephyr/logging/log.h>
+
+LOG_MODULE_DECLARE(zmk, CONFIG_ZMK_LOG_LEVEL);
+
+#include <zmk/activity.h>
+#include <zmk/timer.h>
+#include <zmk/event_manager.h>
+#include <zmk/events/activity_state_changed.h>
+#include <zmk/events/position_state_changed.h>
+#include <zmk/events/sensor_event.h>
+
+#if IS_ENABLED(CONFIG_ZMK_POINTING)
+#include <zephyr/input/input.h>
+#endif
+
+#define IDLE_MS CONFIG_ZMK_BLE_CONN_PARAMS_IDLE_MS
+
+// Connections start out with the fast parameters hosts and the split central pick while
+// connecting, so the scheduler starts out active too.
+static atomic_t relaxed = ATOMIC_INIT(0);
+static atomic_t last_activity_ms;
+
+static struct zmk_timer idle_timer;
+
+static const struct bt_le_conn_param active_params = BT_LE_CONN_PARAM_INIT(
+    CONFIG_ZMK_BLE_CONN_PARAMS_ACTIVE_INT, CONFIG_ZMK_BLE_CONN_PARAMS_ACTIVE_INT,
+    CONFIG_ZMK_BLE_CONN_PARAMS_ACTIVE_LATENCY, CONFIG_ZMK_BLE_CONN_PARAMS_TIMEOUT);
+
+static const struct bt_le_conn_param idle_params = BT_LE_CONN_PARAM_INIT(
+    CONFIG_ZMK_BLE_CONN_PARAMS_IDLE_INT, CONFIG_ZMK_BLE_CONN_PARAMS_IDLE_INT,
+    CONFIG_ZMK_BLE_CONN_PARAMS_IDLE_LATENCY, CONFIG_ZMK_BLE_CONN_PARAMS_TIMEOUT);
+
+static void update_conn_params(struct bt_conn *conn, void *data) {
+    const struct bt_le_conn_param *param = data;
+    struct bt_conn_info info;
+
+    if (bt_conn_get_info(conn, &info) < 0 || info.state != BT_CONN_STATE_CONNECTED) {
+        return;
+    }
+
+    if (info.le.interval >= param->interval_min && info.le.interval <= param->interval_max &&
+        info.le.latency == param->latency) {
+        return;
+    }
+
+    // As a peripheral this asks the host for the new parameters, which it may refuse. As the split
+    // central it updates the link to the peripheral directly.
+    int err = bt_conn_le_param_update(conn, param);
+    if (err < 0) {
+        LOG_DBG("Failed to update connection parameters (err %d)", err);
+    }
+}
+
+static void set_relaxed(bool relax) {
+    if (atomic_set(&relaxed, relax) == relax) {
+        return;
+    }
+
+    LOG_DBG("Requesting %s connection parameters", relax ? "idle" : "active");
+    bt_conn_foreach(BT_CONN_TYPE_LE, update_conn_params,
+                    (void *)(relax ? &idle_params : &active_params));
+}
+
+static void idle_timer_handler(struct zmk_timer *timer) {
+    // Activity only records a timestamp, so the timer isn't restarted for every key press.
+    uint32_t elapsed = k_uptime_get_32() - (uint32_t)atomic_get(&last_activity_ms);
+    if (elapsed < IDLE_MS) {
+        zmk_timer_start(&idle_timer, IDLE_MS - elapsed);
+        return;
+    }
+
+    set_relaxed(true);
+}
+
+static void wake_work_cb(struct k_work *work) {
+    set_relaxed(false);
+
+    if (!zmk_timer_is_pending(&idle_timer)) {
+        zmk_timer_start(&idle_timer, IDLE_MS);
+    }
+}
+
+static K_WORK_DEFINE(wake_work, wake_work_cb);
+
+static void note_activity(void) {
+    atomic_set(&last_activity_ms, k_uptime_get_32());
+
+    if (atomic_get(&relaxed) || !zmk_timer_is_pending(&idle_timer)) {
+        k_work_submit(&wake_work);
+    }
+}
+
+static int conn_params_listener(const zmk_event_t *eh) {
+    const struct zmk_activity_state_changed *ev = as_zmk_activity_state_changed(eh);
+    if (ev) {
+        if (ev->state == ZMK_ACTIVITY_ACTIVE) {
+            note_activity();
+        } else {
+            zmk_timer_stop(&idle_timer);
+            set_relaxed(true);
+        }
+        return ZMK_EV_EVENT_BUBBLE;
+    }
+
+    note_activity();
+    return ZMK_EV_EVENT_BUBBLE;
+}
+
+ZMK_LISTENER(ble_conn_params, conn_params_listener);
+ZMK_SUBSCRIPTION(ble_conn_params, zmk_activity_state_changed);
+ZMK_SUBSCRIPTION(ble_conn_params, zmk_position_state_changed);
+ZMK_SUBSCRIPTION(ble_conn_params, zmk_sensor_event);
+
+#if IS_ENABLED(CONFIG_ZMK_POINTING)
+
+static void conn_params_input_listener(struct input_event *ev) { note_activity(); }
+
+INPUT_CALLBACK_DEFINE(NULL, conn_params_input_listener);
+
+#endif // IS_ENABLED(CONFIG_ZMK_POINTING)
+
+static void conn_params_connected(struct bt_conn *conn, uint8_t err) {
+    if (err) {
+        return;
+    }
+
+    // Links start out with fast parameters. Count the connection as activity, so the new link is
+    // relaxed along with the others once the keyboard has been idle for long enough.
+    note_activity();
+}
+
+static struct bt_conn_cb conn_callbacks = {
+    .connected = conn_params_connected,
+};
+
+static int ble_conn_params_init(void) {
+    zmk_timer_init(&idle_timer, idle_timer_handler);
+    atomic_set(&last_activity_ms, k_uptime_get_32());
+    zmk_timer_start(&idle_timer, IDLE_MS);
+
+    bt_conn_cb_register(&conn_callbacks);
+
+    return 0;
+}
+
+SYS_INIT(ble_conn_params_init, APPLICATION, CONFIG_APPLICATION_INIT_PRIORITY);
@@ -20,6 +20,7 @@
 #include <zmk/hid.h>
 #include <zmk/matrix.h>
 #include <zmk/keymap.h>
+#include <zmk/timer.h>
 #include <zmk/virtual_key_position.h>
 
 LOG_MODULE_DECLARE(zmk, CONFIG_ZMK_LOG_LEVEL);
@@ -63,18 +64,44 @@ struct combo_candidate {
 uint32_t pressed_keys_count = 0;
 // set of keys pressed
 struct zmk_position_state_changed_event pressed_keys[CONFIG_ZMK_COMBO_MAX_KEYS_PER_COMBO] = {};
-// the set of candidate combos based on the currently pressed_keys
-struct combo_candidate candidates[CONFIG_ZMK_COMBO_MAX_COMBOS_PER_KEY];
 // the last candidate that was completely pressed
 struct combo_cfg *fully_pressed_combo = NULL;
+
+#if IS_ENABLED(CONFIG_ZMK_COMBO_BITMASK)
+
+#define COMBO_COUNT_ONE(n) +1
+#define COMBOS_LEN (0 DT_INST_FOREACH_CHILD(0, COMBO_COUNT_ONE))
+#define COMBO_MASK_WORDS DIV_ROUND_UP(COMBOS_LEN, 32)
+
+// all combos, sorted shortest-first, then by virtual-key-position. Bit i of a combo mask refers to
+// combos[i], so the lowest set bit in a mask is the preferred combo.
+struct combo_cfg *combos[COMBOS_LEN];
+int combos_len = 0;
+// masks of the combos that use each key position and are active on each layer
+uint32_t position_combos[ZMK_KEYMAP_LEN][COMBO_MASK_WORDS];
+uint32_t layer_combos[ZMK_KEYMAP_LAYERS_LEN][COMBO_MASK_WORDS];
+// mask of the combos that have require-prior-idle-ms set
+uint32_t prior_idle_combos[COMBO_MASK_WORDS];
+// the set of candidate combos based on the currently pressed_keys
+uint32_t candidates[COMBO_MASK_WORDS];
+// the timestamp of the first pressed key, which candidate timeouts are relative to
+int64_t candidates_timestamp;
+
+#else
+
+// the set of candidate combos based on the currently pressed_keys
+struct combo_candidate candidates[CONFIG_ZMK_COMBO_MAX_COMBOS_PER_KEY];
 // a lookup dict that maps a key position to all combos on that position
 struct combo_cfg *combo_lookup[ZMK_KEYMAP_LEN][CONFIG_ZMK_COMBO_MAX_COMBOS_PER_KEY] = {NULL};
+
+#endif // IS_ENABLED(CONFIG_ZMK_COMBO_BITMASK)
+
 // combos that have been activated and still have (some) keys pressed
 // this array is always contiguous from 0.
 struct active_combo active_combos[CONFIG_ZMK_COMBO_MAX_PRESSED_COMBOS] = {NULL};
 int active_combo_count = 0;
 
-struct k_work_delayable timeout_task;
+struct zmk_timer timeout_task;
 int64_t timeout_task_timeout_at;
 
 // this keeps track of the last non-combo, non-mod key tap
@@ -88,6 +115,149 @@ static void store_last_tapped(int64_t timestamp) {
     }
 }
 
+static bool is_quick_tap(struct combo_cfg *combo, int64_t timestamp) {
+    return (last_tapped_timestamp + combo->require_prior_idle_ms) > timestamp;
+}
+
+#if IS_ENABLED(CONFIG_ZMK_COMBO_BITMASK)
+
+// Store the combo in the combos array, keeping it sorted shortest-first, then by
+// virtual-key-position. The position and layer masks are built once all combos are stored.
+static int initialize_combo(struct combo_cfg *new_combo) {
+    for (int i = 0; i < new_combo->key_position_len; i++) {
+        int32_t position = new_combo->key_positions[i];
+        if (position >= ZMK_KEYMAP_LEN) {
+            LOG_ERR("Unable to initialize combo, key position %d does not exist", position);
+            return -EINVAL;
+        }
+    }
+
+    int i = combos_len++;
+    for (; i > 0; i--) {
+        struct combo_cfg *combo = combos[i - 1];
+        if (combo->key_position_len < new_combo->key_position_len ||
+            (combo->key_position_len == new_combo->key_position_len &&
+             combo->virtual_key_position < new_combo->virtual_key_position)) {
+            break;
+        }
+        combos[i] = combo;
+    }
+    combos[i] = new_combo;
+    return 0;
+}
+
+static void initialize_combo_masks() {
+    for (int i = 0; i < combos_len; i++) {
+        struct combo_cfg *combo = combos[i];
+        uint32_t bit = BIT(i % 32);
+        int word = i / 32;
+
+        for (int j = 0; j < combo->key_position_len; j++) {
+            position_combos[combo->key_positions[j]][word] |= bit;
+        }
+
+        if (combo->layers[0] == -1) {
+            // -1 in the first layer position is global layer scope
+            for (int layer = 0; layer < ZMK_KEYMAP_LAYERS_LEN; layer++) {
+                layer_combos[layer][word] |= bit;
+            }
+        } else {
+            for (int j = 0; j < combo->layers_len; j++) {
+                if (combo->layers[j] >= 0 && combo->layers[j] < ZMK_KEYMAP_LAYERS_LEN) {
+                    layer_combos[combo->layers[j]][word] |= bit;
+                }
+            }
+        }
+
+        if (combo->require_prior_idle_ms > 0) {
+            prior_idle_combos[word] |= bit;
+        }
+    }
+}
+
+static int count_candidates() {
+    int count = 0;
+    for (int i = 0; i < COMBO_MASK_WORDS; i++) {
+        count += POPCOUNT(candidates[i]);
+    }
+    return count;
+}
+
+static struct combo_cfg *first_candidate() {
+    for (int i = 0; i < COMBO_MASK_WORDS; i++) {
+        if (candidates[i]) {
+            return combos[i * 32 + find_lsb_set(candidates[i]) - 1];
+        }
+    }
+    return NULL;
+}
+
+static int setup_candidates_for_first_keypress(int32_t position, int64_t timestamp) {
+    uint8_t highest_active_layer = zmk_keymap_highest_layer_active();
+    if (highest_active_layer >= ZMK_KEYMAP_LAYERS_LEN) {
+        return 0;
+    }
+
+    candidates_timestamp = timestamp;
+    for (int i = 0; i < COMBO_MASK_WORDS; i++) {
+        candidates[i] = position_combos[position][i] & layer_combos[highest_active_layer][i];
+
+        // only combos with require-prior-idle-ms need to be checked one by one
+        for (uint32_t bits = candidates[i] & prior_idle_combos[i]; bits; bits &= bits - 1) {
+            int bit = find_lsb_set(bits) - 1;
+            if (is_quick_tap(combos[i * 32 + bit], timestamp)) {
+                candidates[i] &= ~BIT(bit);
+            }
+        }
+    }
+    return count_candidates();
+}
+
+static int filter_candidates(int32_t position) {
+    for (int i = 0; i < COMBO_MASK_WORDS; i++) {
+        candidates[i] &= position_combos[position][i];
+    }
+    return count_candidates();
+}
+
+static int64_t first_candidate_timeout() {
+    int64_t first_timeout = LLONG_MAX;
+    for (int i = 0; i < COMBO_MASK_WORDS; i++) {
+        for (uint32_t bits = candidates[i]; bits; bits &= bits - 1) {
+            struct combo_cfg *combo = combos[i * 32 + find_lsb_set(bits) - 1];
+            first_timeout = MIN(first_timeout, candidates_timestamp + combo->timeout_ms);
+        }
+    }
+    return first_timeout;
+}
+
+static int filter_timed_out_candidates(int64_t timestamp) {
+    for (int i = 0; i < COMBO_MASK_WORDS; i++) {
+        for (uint32_t bits = candidates[i]; bits; bits &= bits - 1) {
+            int bit = find_lsb_set(bits) - 1;
+            if (candidates_timestamp + combos[i * 32 + bit]->timeout_ms <= timestamp) {
+                candidates[i] &= ~BIT(bit);
+            }
+        }
+    }
+
+    int remaining_candidates = count_candidates();
+
+    LOG_DBG(
+        "after filtering out timed out combo candidates: remaining_candidates=%d timestamp=%lld",
+        remaining_candidates, timestamp);
+
+    return remaining_candidates;
+}
+
+static int clear_candidates() {
+    int count = count_candidates();
+    memset(candidates, 0, sizeof(candidates));
+    return count;
+}
+
+#else
+
 // Store the combo key pointer in the combos array, one pointer for each key position
 // The combos are sorted shortest-first, then by virtual-key-position.
 static int initialize_combo(struct combo_cfg *new_combo) {
@@ -138,10 +308,6 @@ static bool combo_active_on_layer(struct combo_cfg *combo, uint8_t layer) {
     return false;
 }
 
-static bool is_quick_tap(struct combo_cfg *combo, int64_t timestamp) {
-    return (last_tapped_timestamp + combo->require_prior_idle_ms) > timestamp;
-}
-
 static int setup_candidates_for_first_keypress(int32_t position, int64_t timestamp) {
     int number_of_combo_candidates = 0;
     uint8_t highest_active_layer = zmk_keymap_highest_layer_active();
@@ -207,17 +373,6 @@ static int64_t first_candidate_timeout() {
     return first_timeout;
 }
 
-static inline bool candidate_is_completely_pressed(struct combo_cfg *candidate) {
-    // this code assumes set(pressed_keys) <= set(candidate->key_positions)
-    // this invariant is enforced by filter_candidates
-    // since events may have been reraised after clearing one or more slots at
-    // the start of pressed_keys (see: release_pressed_keys), we have to check
-    // that each key needed to trigger the combo was pressed, not just the last.
-    return candidate->key_position_len == pressed_keys_count;
-}
-
-static int cleanup();
-
 static int filter_timed_out_candidates(int64_t timestamp) {
     int remaining_candidates = 0;
     for (int i = 0; i < CONFIG_ZMK_COMBO_MAX_COMBOS_PER_KEY; i++) {
@@ -249,6 +404,8 @@ static int filter_timed_out_candidates(int64_t timestamp) {
     return remaining_candidates;
 }
 
+static struct combo_cfg *first_candidate() { return candidates[0].combo; }
+
 static int clear_candidates() {
     for (int i = 0; i < CONFIG_ZMK_COMBO_MAX_COMBOS_PER_KEY; i++) {
         if (candidates[i].combo == NULL) {
@@ -259,8 +416,21 @@ static int clear_candidates() {
     return CONFIG_ZMK_COMBO_MAX_COMBOS_PER_KEY;
 }
 
+#endif // IS_ENABLED(CONFIG_ZMK_COMBO_BITMASK)
+
+static inline bool candidate_is_completely_pressed(struct combo_cfg *candidate) {
+    // this code assumes set(pressed_keys) <= set(candidate->key_positions)
+    // this invariant is enforced by filter_candidates
+    // since events may have been reraised after clearing one or more slots at
+    // the start of pressed_keys (see: release_pressed_keys), we have to check
+    // that each key needed to trigger the combo was pressed, not just the last.
+    return candidate->key_position_len == pressed_keys_count;
+}
+
+static int cleanup();
+
 static int capture_pressed_key(const struct zmk_position_state_changed *ev) {
-    if (pressed_keys_count == CONFIG_ZMK_COMBO_MAX_COMBOS_PER_KEY) {
+    if (pressed_keys_count == ARRAY_SIZE(pressed_keys)) {
         return ZMK_EV_EVENT_BUBBLE;
     }
 
@@ -401,7 +571,7 @@ static bool release_combo_key(int32_t position, int64_t timestamp) {
 }
 
 static int cleanup() {
-    k_work_cancel_delayable(&timeout_task);
+    zmk_timer_stop(&timeout_task);
     clear_candidates();
     if (fully_pressed_combo != NULL) {
         activate_combo(fully_pressed_combo);
@@ -417,17 +587,16 @@ static void update_timeout_task() {
     }
     if (first_timeout == LLONG_MAX) {
         timeout_task_timeout_at = 0;
-        k_work_cancel_delayable(&timeout_task);
+        zmk_timer_stop(&timeout_task);
         return;
     }
-    if (k_work_schedule(&timeout_task, K_MSEC(first_timeout - k_uptime_get())) >= 0) {
-        timeout_task_timeout_at = first_timeout;
-    }
+    zmk_timer_start_at(&timeout_task, first_timeout);
+    timeout_task_timeout_at = first_timeout;
 }
 
 static int position_state_down(const zmk_event_t *ev, struct zmk_position_state_changed *data) {
     int num_candidates;
-    if (candidates[0].combo == NULL) {
+    if (first_candidate() == NULL) {
         num_candidates = setup_candidates_for_first_keypress(data->position, data->timestamp);
         if (num_candidates == 0) {
             return ZMK_EV_EVENT_BUBBLE;
@@ -438,7 +607,7 @@ static int position_state_down(const zmk_event_t *ev, struct zmk_position_state_
     }
     update_timeout_task();
 
-    struct combo_cfg *candidate_combo = candidates[0].combo;
+    struct combo_cfg *candidate_combo = first_candidate();
     LOG_DBG("combo: capturing position event %d", data->position);
     int ret = capture_pressed_key(data);
     switch (num_candidates) {
@@ -475,7 +644,7 @@ static int position_state_up(const zmk_event_t *ev, struct zmk_position_state_ch
     return ZMK_EV_EVENT_BUBBLE;
 }
 
-static void combo_timeout_handler(struct k_work *item) {
+static void combo_timeout_handler(struct zmk_timer *timer) {
     if (timeout_task_timeout_at == 0 || k_uptime_get() < timeout_task_timeout_at) {
         // timer was cancelled or rescheduled.
         return;
@@ -541,8 +710,11 @@ ZMK_SUBSCRIPTION(combo, zmk_keycode_state_changed);
 DT_INST_FOREACH_CHILD(0, COMBO_INST)
 
 static int combo_init(void) {
-    k_work_init_delayable(&timeout_task, combo_timeout_handler);
+    zmk_timer_init(&timeout_task, combo_timeout_handler);
     DT_INST_FOREACH_CHILD(0, INITIALIZE_COMBO);
+#if IS_ENABLED(CONFIG_ZMK_COMBO_BITMASK)
+    initialize_combo_masks();
+#endif
     return 0;
 }
 
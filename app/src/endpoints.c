@@ -8,6 +8,7 @@
 #include <zephyr/settings/settings.h>
 
 #include <stdio.h>
+#include <string.h>
 
 #include <zmk/ble.h>
 #include <zmk/endpoints.h>
@@ -15,6 +16,7 @@
 #include <dt-bindings/zmk/hid_usage_pages.h>
 #include <zmk/usb_hid.h>
 #include <zmk/hog.h>
+#include <zmk/latency_trace.h>
 #include <zmk/event_manager.h>
 #include <zmk/events/ble_active_profile_changed.h>
 #include <zmk/events/usb_conn_state_changed.h>
@@ -118,11 +120,17 @@ int zmk_endpoints_toggle_transport(void) {
 
 struct zmk_endpoint_instance zmk_endpoints_selected(void) { return current_instance; }
 
-static int send_keyboard_report(void) {
+static int send_keyboard_report(struct zmk_hid_keyboard_report_body *body) {
     switch (current_instance.transport) {
     case ZMK_TRANSPORT_USB: {
 #if IS_ENABLED(CONFIG_ZMK_USB)
+        // The USB HID driver sends the live report (converting it for boot protocol if needed), so
+        // an earlier state is swapped in while it is sent.
+        struct zmk_hid_keyboard_report *keyboard_report = zmk_hid_get_keyboard_report();
+        struct zmk_hid_keyboard_report_body live = keyboard_report->body;
+        keyboard_report->body = *body;
         int err = zmk_usb_hid_send_keyboard_report();
+        keyboard_report->body = live;
         if (err) {
             LOG_ERR("FAILED TO SEND OVER USB: %d", err);
         }
@@ -135,8 +143,7 @@ static int send_keyboard_report(void) {
 
     case ZMK_TRANSPORT_BLE: {
 #if IS_ENABLED(CONFIG_ZMK_BLE)
-        struct zmk_hid_keyboard_report *keyboard_report = zmk_hid_get_keyboard_report();
-        int err = zmk_hog_send_keyboard_report(&keyboard_report->body);
+        int err = zmk_hog_send_keyboard_report(body);
         if (err) {
             LOG_ERR("FAILED TO SEND OVER HOG: %d", err);
         }
@@ -152,11 +159,15 @@ static int send_keyboard_report(void) {
     return -ENOTSUP;
 }
 
-static int send_consumer_report(void) {
+static int send_consumer_report(struct zmk_hid_consumer_report_body *body) {
     switch (current_instance.transport) {
     case ZMK_TRANSPORT_USB: {
 #if IS_ENABLED(CONFIG_ZMK_USB)
+        struct zmk_hid_consumer_report *consumer_report = zmk_hid_get_consumer_report();
+        struct zmk_hid_consumer_report_body live = consumer_report->body;
+        consumer_report->body = *body;
         int err = zmk_usb_hid_send_consumer_report();
+        consumer_report->body = live;
         if (err) {
             LOG_ERR("FAILED TO SEND OVER USB: %d", err);
         }
@@ -169,8 +180,7 @@ static int send_consumer_report(void) {
 
     case ZMK_TRANSPORT_BLE: {
 #if IS_ENABLED(CONFIG_ZMK_BLE)
-        struct zmk_hid_consumer_report *consumer_report = zmk_hid_get_consumer_report();
-        int err = zmk_hog_send_consumer_report(&consumer_report->body);
+        int err = zmk_hog_send_consumer_report(body);
         if (err) {
             LOG_ERR("FAILED TO SEND OVER HOG: %d", err);
         }
@@ -186,23 +196,205 @@ static int send_consumer_report(void) {
     return -ENOTSUP;
 }
 
-int zmk_endpoints_send_report(uint16_t usage_page) {
+static int send_report_body(uint16_t usage_page, void *body) {
+    LOG_DBG("Sending usage page 0x%02X report", usage_page);
 
-    LOG_DBG("usage page 0x%02X", usage_page);
     switch (usage_page) {
     case HID_USAGE_KEY:
-        return send_keyboard_report();
+        return send_keyboard_report(body);
 
     case HID_USAGE_CONSUMER:
-        return send_consumer_report();
+        return send_consumer_report(body);
     }
 
     LOG_ERR("Unsupported usage page %d", usage_page);
     return -ENOTSUP;
 }
 
+static void *live_report_body(uint16_t usage_page) {
+    switch (usage_page) {
+    case HID_USAGE_KEY:
+        return &zmk_hid_get_keyboard_report()->body;
+
+    case HID_USAGE_CONSUMER:
+        return &zmk_hid_get_consumer_report()->body;
+    }
+
+    return NULL;
+}
+
+#if IS_ENABLED(CONFIG_ZMK_ENDPOINTS_REPORT_TRANSACTIONS)
+
+// Transactions belong to the thread that opened them, which is the system work queue in practice.
+// Reports requested from any other thread are sent immediately, after the report held back by an
+// open transaction, so the host still gets the reports in the order they were requested.
+static K_MUTEX_DEFINE(transaction_mutex);
+static k_tid_t transaction_thread;
+static uint8_t transaction_depth;
+
+// Usage page of the report requested during the transaction but not yet sent, or 0 if none is
+// pending. Only one report is pending at a time, so reports of different types are sent in the
+// order they were requested.
+static uint16_t pending_page;
+
+// The bodies last sent to the host, and the bodies requested by the last call to
+// zmk_endpoints_send_report(). A pending report is merged with the next one only if the host can't
+// tell the difference between seeing the two changes separately and seeing them together.
+static struct zmk_hid_keyboard_report_body keyboard_sent, keyboard_requested;
+static struct zmk_hid_consumer_report_body consumer_sent, consumer_requested;
+
+static bool in_transaction(void) {
+    return transaction_depth > 0 && transaction_thread == k_current_get();
+}
+
+static void *sent_body(uint16_t usage_page) {
+    return usage_page == HID_USAGE_KEY ? (void *)&keyboard_sent : (void *)&consumer_sent;
+}
+
+static void *requested_body(uint16_t usage_page) {
+    return usage_page == HID_USAGE_KEY ? (void *)&keyboard_requested : (void *)&consumer_requested;
+}
+
+static size_t body_size(uint16_t usage_page) {
+    return usage_page == HID_USAGE_KEY ? sizeof(keyboard_sent) : sizeof(consumer_sent);
+}
+
+static int flush_pending(void) {
+    if (pending_page == 0) {
+        return 0;
+    }
+
+    uint16_t usage_page = pending_page;
+    pending_page = 0;
+
+    memcpy(sent_body(usage_page), requested_body(usage_page), body_size(usage_page));
+
+    int err = send_report_body(usage_page, requested_body(usage_page));
+    if (err < 0) {
+        LOG_ERR("Failed to send pending usage page 0x%02X report: %d", usage_page, err);
+    }
+
+    return err;
+}
+
+static int hold_report(uint16_t usage_page, const void *live) {
+    int err = 0;
+
+    if (pending_page == usage_page) {
+        bool can_merge =
+            usage_page == HID_USAGE_KEY
+                ? zmk_hid_keyboard_report_can_merge(&keyboard_sent, &keyboard_requested, live)
+                : zmk_hid_consumer_report_can_merge(&consumer_sent, &consumer_requested, live);
+        if (!can_merge) {
+            err = flush_pending();
+        }
+    } else {
+        err = flush_pending();
+    }
+
+    memcpy(requested_body(usage_page), live, body_size(usage_page));
+    pending_page = usage_page;
+
+    return err;
+}
+
+static int send_report(uint16_t usage_page) {
+    void *live = live_report_body(usage_page);
+    if (live == NULL) {
+        LOG_ERR("Unsupported usage page %d", usage_page);
+        return -ENOTSUP;
+    }
+
+    int err;
+
+    k_mutex_lock(&transaction_mutex, K_FOREVER);
+
+    if (in_transaction()) {
+        err = hold_report(usage_page, live);
+    } else {
+        flush_pending();
+
+        memcpy(sent_body(usage_page), live, body_size(usage_page));
+        err = send_report_body(usage_page, live);
+    }
+
+    k_mutex_unlock(&transaction_mutex);
+
+    return err;
+}
+
+void zmk_endpoints_report_transaction_begin(void) {
+    k_mutex_lock(&transaction_mutex, K_FOREVER);
+
+    if (transaction_depth == 0) {
+        transaction_thread = k_current_get();
+        transaction_depth++;
+    } else if (transaction_thread == k_current_get()) {
+        transaction_depth++;
+    }
+
+    k_mutex_unlock(&transaction_mutex);
+}
+
+int zmk_endpoints_report_transaction_end(void) {
+    int err = 0;
+
+    k_mutex_lock(&transaction_mutex, K_FOREVER);
+
+    if (in_transaction() && --transaction_depth == 0) {
+        err = flush_pending();
+    }
+
+    k_mutex_unlock(&transaction_mutex);
+
+    return err;
+}
+
+int zmk_endpoints_report_barrier(void) {
+    int err = 0;
+
+    k_mutex_lock(&transaction_mutex, K_FOREVER);
+
+    if (in_transaction()) {
+        err = flush_pending();
+    }
+
+    k_mutex_unlock(&transaction_mutex);
+
+    return err;
+}
+
+#else
+
+static int send_report(uint16_t usage_page) {
+    void *live = live_report_body(usage_page);
+    if (live == NULL) {
+        LOG_ERR("Unsupported usage page %d", usage_page);
+        return -ENOTSUP;
+    }
+
+    return send_report_body(usage_page, live);
+}
+
+#endif // IS_ENABLED(CONFIG_ZMK_ENDPOINTS_REPORT_TRANSACTIONS)
+
+int zmk_endpoints_send_report(uint16_t usage_page) {
+
+    LOG_DBG("usage page 0x%02X", usage_page);
+    zmk_latency_trace_record(ZMK_LATENCY_TRACE_STAGE_ENDPOINT,
+                             usage_page == HID_USAGE_KEY ? "keyboard" : "consumer");
+
+    return send_report(usage_page);
+}
+
 #if IS_ENABLED(CONFIG_ZMK_POINTING)
 int zmk_endpoints_send_mouse_report() {
+    zmk_latency_trace_record(ZMK_LATENCY_TRACE_STAGE_ENDPOINT, "mouse");
+
+    // Mouse movement is cleared as soon as it has been sent, so mouse reports are never deferred.
+    // Anything requested before them is sent first to keep the order the host sees.
+    zmk_endpoints_report_barrier();
+
     switch (current_instance.transport) {
     case ZMK_TRANSPORT_USB: {
 #if IS_ENABLED(CONFIG_ZMK_USB)
@@ -338,6 +530,9 @@ void zmk_endpoints_clear_current(void) {
 
     zmk_endpoints_send_report(HID_USAGE_KEY);
     zmk_endpoints_send_report(HID_USAGE_CONSUMER);
+
+    // The cleared reports must reach this endpoint before a new one is selected.
+    zmk_endpoints_report_barrier();
 }
 
 static void update_current_endpoint(void) {
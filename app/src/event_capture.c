@@ -0,0 +1,87 @@
+/*
+ * Copyright (c) 2024 The ZMK Contributors
+ *
+ * SPDX-License-Identifier: MIT
+ */
+
+#include <string.h>
+
+#include <zephyr/init.h>
+#include <zephyr/kernel.h>
+#include <zephyr/logging/log.h>
+
+LOG_MODULE_DECLARE(zmk, CONFIG_ZMK_LOG_LEVEL);
+
+#include <zmk/event_capture.h>
+
+static struct zmk_event_capture_slot pool[CONFIG_ZMK_EVENT_CAPTURE_POOL_SIZE];
+static sys_slist_t free_slots;
+
+int zmk_event_capture_add(struct zmk_event_capture *capture, const zmk_event_t *event) {
+    if (event->event->size > sizeof(union zmk_event_capture_payload)) {
+        LOG_ERR("Can't capture %s events, add them to union zmk_event_capture_payload",
+                event->event->name);
+        return -EINVAL;
+    }
+
+    sys_snode_t *node = capture->count < capture->limit ? sys_slist_get(&free_slots) : NULL;
+    if (!node) {
+        capture->overflows++;
+        LOG_WRN("Unable to capture %s event with %d events held, %d overflows so far",
+                event->event->name, capture->count, capture->overflows);
+        return -ENOMEM;
+    }
+
+    // The header records the index of the listener capturing the event, so it can be raised again
+    // from there without searching the subscriptions.
+    struct zmk_event_capture_slot *slot = CONTAINER_OF(node, struct zmk_event_capture_slot, node);
+    memcpy(&slot->event, event, event->event->size);
+    sys_slist_append(&capture->events, &slot->node);
+
+    capture->count++;
+    capture->high_water = MAX(capture->high_water, capture->count);
+
+    return 0;
+}
+
+void zmk_event_capture_begin_release(struct zmk_event_capture *capture) {
+    sys_slist_merge_slist(&capture->events, &capture->releasing);
+    capture->releasing = capture->events;
+    sys_slist_init(&capture->events);
+}
+
+int zmk_event_capture_release_next(struct zmk_event_capture *capture) {
+    sys_snode_t *node = sys_slist_get(&capture->releasing);
+    if (!node) {
+        return -ENOENT;
+    }
+
+    // Raising the event may capture it or others again, so free its slot first.
+    struct zmk_event_capture_slot *slot = CONTAINER_OF(node, struct zmk_event_capture_slot, node);
+    union zmk_event_capture_payload event;
+
+    memcpy(&event, &slot->event, slot->event.header.event->size);
+    sys_slist_append(&free_slots, &slot->node);
+    capture->count--;
+
+    LOG_DBG("Releasing captured %s event", event.header.event->name);
+
+    return zmk_event_manager_handle_from(&event.header, event.header.last_listener_index);
+}
+
+void zmk_event_capture_release(struct zmk_event_capture *capture) {
+    zmk_event_capture_begin_release(capture);
+    while (zmk_event_capture_release_next(capture) != -ENOENT) {
+    }
+}
+
+static int event_capture_init(void) {
+    sys_slist_init(&free_slots);
+    for (int i = 0; i < ARRAY_SIZE(pool); i++) {
+        sys_slist_append(&free_slots, &pool[i].node);
+    }
+
+    return 0;
+}
+
+SYS_INIT(event_capture_init, PRE_KERNEL_1, CONFIG_KERNEL_INIT_PRIORITY_DEFAULT);
@@ -10,23 +10,18 @@
 LOG_MODULE_DECLARE(zmk, CONFIG_ZMK_LOG_LEVEL);
 
 #include <zmk/event_manager.h>
-
-extern struct zmk_event_type *__event_type_start[];
-extern struct zmk_event_type *__event_type_end[];
-
-extern struct zmk_event_subscription __event_subscriptions_start[];
-extern struct zmk_event_subscription __event_subscriptions_end[];
+#include <zmk/latency_trace.h>
 
 int zmk_event_manager_handle_from(zmk_event_t *event, uint8_t start_index) {
     int ret = 0;
-    uint8_t len = __event_subscriptions_end - __event_subscriptions_start;
+    const struct zmk_event_subscription *subs = event->event->subscriptions_start;
+    uint8_t len = event->event->subscriptions_end - subs;
     for (int i = start_index; i < len; i++) {
-        struct zmk_event_subscription *ev_sub = __event_subscriptions_start + i;
-        if (ev_sub->event_type != event->event) {
-            continue;
-        }
         event->last_listener_index = i;
-        ret = ev_sub->listener->callback(event);
+#if IS_ENABLED(CONFIG_ZMK_LATENCY_TRACE)
+        zmk_latency_trace_record(ZMK_LATENCY_TRACE_STAGE_LISTENER, subs[i].listener->name);
+#endif // IS_ENABLED(CONFIG_ZMK_LATENCY_TRACE)
+        ret = subs[i].listener->callback(event);
         switch (ret) {
         case ZMK_EV_EVENT_BUBBLE:
             continue;
@@ -45,36 +40,39 @@ int zmk_event_manager_handle_from(zmk_event_t *event, uint8_t start_index) {
     return 0;
 }
 
-int zmk_event_manager_raise(zmk_event_t *event) { return zmk_event_manager_handle_from(event, 0); }
-
-int zmk_event_manager_raise_after(zmk_event_t *event, const struct zmk_listener *listener) {
-    uint8_t len = __event_subscriptions_end - __event_subscriptions_start;
-    for (int i = 0; i < len; i++) {
-        struct zmk_event_subscription *ev_sub = __event_subscriptions_start + i;
-
-        if (ev_sub->event_type == event->event && ev_sub->listener == listener) {
-            return zmk_event_manager_handle_from(event, i + 1);
+// Listeners are subscribed to a handful of event types, so only the listener's own subscriptions
+// are checked, however many subscriptions the firmware has.
+static int listener_index(const zmk_event_t *event, const struct zmk_listener *listener) {
+    for (const struct zmk_event_subscription *const *sub = listener->subscriptions_start;
+         sub < listener->subscriptions_end; sub++) {
+        if ((*sub)->event_type == event->event) {
+            return *sub - event->event->subscriptions_start;
         }
     }
 
-    LOG_WRN("Unable to find where to raise this after event");
-
     return -EINVAL;
 }
 
-int zmk_event_manager_raise_at(zmk_event_t *event, const struct zmk_listener *listener) {
-    uint8_t len = __event_subscriptions_end - __event_subscriptions_start;
-    for (int i = 0; i < len; i++) {
-        struct zmk_event_subscription *ev_sub = __event_subscriptions_start + i;
+int zmk_event_manager_raise(zmk_event_t *event) { return zmk_event_manager_handle_from(event, 0); }
 
-        if (ev_sub->event_type == event->event && ev_sub->listener == listener) {
-            return zmk_event_manager_handle_from(event, i);
-        }
+int zmk_event_manager_raise_after(zmk_event_t *event, const struct zmk_listener *listener) {
+    int index = listener_index(event, listener);
+    if (index < 0) {
+        LOG_WRN("Unable to find where to raise this after event");
+        return index;
     }
 
-    LOG_WRN("Unable to find where to raise this event");
+    return zmk_event_manager_handle_from(event, index + 1);
+}
 
-    return -EINVAL;
+int zmk_event_manager_raise_at(zmk_event_t *event, const struct zmk_listener *listener) {
+    int index = listener_index(event, listener);
+    if (index < 0) {
+        LOG_WRN("Unable to find where to raise this event");
+        return index;
+    }
+
+    return zmk_event_manager_handle_from(event, index);
 }
 
 int zmk_event_manager_release(zmk_event_t *event) {
@@ -468,6 +468,59 @@ void zmk_hid_mouse_clear(void) {
 
 #endif // IS_ENABLED(CONFIG_ZMK_POINTING)
 
+// Keys are either a bitmap, where a press sets a bit, or an array of usages, where a press writes a
+// non-zero usage to a slot.
+static bool keys_have_press(const uint8_t *from, const uint8_t *to, size_t len, bool bitmap) {
+    for (size_t i = 0; i < len; i++) {
+        if (bitmap ? (to[i] & ~from[i]) : (to[i] != from[i] && to[i] != 0)) {
+            return true;
+        }
+    }
+
+    return false;
+}
+
+static bool keys_overlap(const uint8_t *a0, const uint8_t *a1, const uint8_t *b1, size_t len,
+                         bool bitmap) {
+    for (size_t i = 0; i < len; i++) {
+        if (bitmap ? ((a0[i] ^ a1[i]) & (a1[i] ^ b1[i])) : (a0[i] != a1[i] && a1[i] != b1[i])) {
+            return true;
+        }
+    }
+
+    return false;
+}
+
+// Hosts apply the changes in one report as released keys first, then pressed keys, and order
+// presses within a report by usage rather than by when they happened. Merging the first change
+// (prev -> pending) with the second (pending -> next) is only safe if that order holds and neither
+// change undoes part of the other. Modifier changes are never merged, since some hosts apply them
+// after the keys in the same report.
+bool zmk_hid_keyboard_report_can_merge(const struct zmk_hid_keyboard_report_body *prev,
+                                       const struct zmk_hid_keyboard_report_body *pending,
+                                       const struct zmk_hid_keyboard_report_body *next) {
+    const bool bitmap = IS_ENABLED(CONFIG_ZMK_HID_REPORT_TYPE_NKRO);
+    const size_t len = sizeof(next->keys);
+
+    if (prev->modifiers != pending->modifiers || pending->modifiers != next->modifiers) {
+        return false;
+    }
+
+    return !keys_have_press(prev->keys, pending->keys, len, bitmap) &&
+           !keys_overlap(prev->keys, pending->keys, next->keys, len, bitmap);
+}
+
+bool zmk_hid_consumer_report_can_merge(const struct zmk_hid_consumer_report_body *prev,
+                                       const struct zmk_hid_consumer_report_body *pending,
+                                       const struct zmk_hid_consumer_report_body *next) {
+    const size_t len = sizeof(next->keys);
+
+    return !keys_have_press((const uint8_t *)prev->keys, (const uint8_t *)pending->keys, len,
+                            false) &&
+           !keys_overlap((const uint8_t *)prev->keys, (const uint8_t *)pending->keys,
+                         (const uint8_t *)next->keys, len, false);
+}
+
 struct zmk_hid_keyboard_report *zmk_hid_get_keyboard_report(void) { return &keyboard_report; }
 
 struct zmk_hid_consumer_report *zmk_hid_get_consumer_report(void) { return &consumer_report; }
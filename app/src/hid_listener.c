@@ -32,6 +32,7 @@ static int hid_listener_keycode_pressed(const struct zmk_keycode_state_changed *
         if (err < 0) {
             LOG_ERR("Failed to send key report for pre-releasing keycode (%d)", err);
         }
+        zmk_endpoints_report_barrier();
     }
 
     LOG_DBG("usage_page 0x%02X keycode 0x%02X implicit_mods 0x%02X explicit_mods 0x%02X",
@@ -74,6 +75,7 @@ static int hid_listener_keycode_released(const struct zmk_keycode_state_changed
     if (err < 0) {
         LOG_ERR("Failed to send key report for the released keycode (%d)", err);
     }
+    zmk_endpoints_report_barrier();
 
 #endif // IS_ENABLED(CONFIG_ZMK_HID_SEPARATE_MOD_RELEASE_REPORT)
 
@@ -6,6 +6,9 @@
 
 #include <zephyr/settings/settings.h>
 #include <zephyr/init.h>
+#include <zephyr/spinlock.h>
+
+#include <string.h>
 
 #include <zephyr/logging/log.h>
 
@@ -18,6 +21,7 @@ LOG_MODULE_DECLARE(zmk, CONFIG_ZMK_LOG_LEVEL);
 #include <zmk/endpoints_types.h>
 #include <zmk/hog.h>
 #include <zmk/hid.h>
+#include <zmk/latency_trace.h>
 #if IS_ENABLED(CONFIG_ZMK_POINTING_SMOOTH_SCROLLING)
 #include <zmk/pointing/resolution_multipliers.h>
 #endif // IS_ENABLED(CONFIG_ZMK_POINTING_SMOOTH_SCROLLING)
@@ -285,169 +289,342 @@ K_THREAD_STACK_DEFINE(hog_q_stack, CONFIG_ZMK_BLE_THREAD_STACK_SIZE);
 
 struct k_work_q hog_work_q;
 
-K_MSGQ_DEFINE(zmk_hog_keyboard_msgq, sizeof(struct zmk_hid_keyboard_report_body),
-              CONFIG_ZMK_BLE_KEYBOARD_REPORT_QUEUE_SIZE, 4);
+// Keyboard, consumer and mouse reports share one queue, so the host gets them in the order they
+// were sent, and a burst of one type can use space the others aren't using.
+#define REPORT_QUEUE_SIZE                                                                          \
+    (CONFIG_ZMK_BLE_KEYBOARD_REPORT_QUEUE_SIZE + CONFIG_ZMK_BLE_CONSUMER_REPORT_QUEUE_SIZE +       \
+     COND_CODE_1(IS_ENABLED(CONFIG_ZMK_POINTING), (CONFIG_ZMK_BLE_MOUSE_REPORT_QUEUE_SIZE), (0)))
 
-void send_keyboard_report_callback(struct k_work *work) {
-    struct zmk_hid_keyboard_report_body report;
+enum hog_report_type {
+    HOG_REPORT_KEYBOARD,
+    HOG_REPORT_CONSUMER,
+#if IS_ENABLED(CONFIG_ZMK_POINTING)
+    HOG_REPORT_MOUSE,
+#endif // IS_ENABLED(CONFIG_ZMK_POINTING)
+};
 
-    while (k_msgq_get(&zmk_hog_keyboard_msgq, &report, K_NO_WAIT) == 0) {
-        struct bt_conn *conn = zmk_ble_active_profile_conn();
-        if (conn == NULL) {
-            return;
-        }
+struct queued_report {
+    enum hog_report_type type;
+    union {
+        struct zmk_hid_keyboard_report_body keyboard;
+        struct zmk_hid_consumer_report_body consumer;
+#if IS_ENABLED(CONFIG_ZMK_POINTING)
+        struct zmk_hid_mouse_report_body mouse;
+#endif // IS_ENABLED(CONFIG_ZMK_POINTING)
+    } body;
+};
 
-        struct bt_gatt_notify_params notify_params = {
-            .attr = &hog_svc.attrs[5],
-            .data = &report,
-            .len = sizeof(report),
-        };
+static struct k_spinlock queue_lock;
+static struct queued_report queue[REPORT_QUEUE_SIZE];
+static uint16_t queue_head;
+static uint16_t queue_len;
+// Set while the head is being handed to the Bluetooth stack, so it isn't replaced meanwhile.
+static bool head_sending;
+// Notifications handed to the Bluetooth stack that haven't been sent yet. Reports wait in the queue
+// while this is at the limit, which is when they can be merged.
+static uint8_t in_flight;
+// The connection the in-flight notifications were sent on. Notifications still pending on a
+// connection that is closed or no longer active may never complete, so the count starts over.
+static struct bt_conn *in_flight_conn;
+// Changed whenever the count starts over, so completions of older notifications are ignored.
+static uintptr_t in_flight_generation;
+
+// The last two keyboard and consumer states added to the queue. The newest queued report is
+// replaced by the next one of the same type if the host would see the same presses and releases.
+static struct zmk_hid_keyboard_report_body keyboard_prev, keyboard_last;
+static struct zmk_hid_consumer_report_body consumer_prev, consumer_last;
+
+static K_SEM_DEFINE(queue_space_sem, 0, 1);
+
+static void send_reports_callback(struct k_work *work);
+
+static K_WORK_DELAYABLE_DEFINE(hog_send_work, send_reports_callback);
+
+static const struct bt_gatt_attr *report_attr(enum hog_report_type type) {
+    switch (type) {
+    case HOG_REPORT_KEYBOARD:
+        return &hog_svc.attrs[5];
+    case HOG_REPORT_CONSUMER:
+        return &hog_svc.attrs[9];
+#if IS_ENABLED(CONFIG_ZMK_POINTING)
+    case HOG_REPORT_MOUSE:
+        return &hog_svc.attrs[13];
+#endif // IS_ENABLED(CONFIG_ZMK_POINTING)
+    }
 
-        int err = bt_gatt_notify_cb(conn, &notify_params);
-        if (err == -EPERM) {
-            bt_conn_set_security(conn, BT_SECURITY_L2);
-        } else if (err) {
-            LOG_DBG("Error notifying %d", err);
-        }
+    return NULL;
+}
 
-        bt_conn_unref(conn);
+static size_t report_len(enum hog_report_type type) {
+    switch (type) {
+    case HOG_REPORT_KEYBOARD:
+        return sizeof(struct zmk_hid_keyboard_report_body);
+    case HOG_REPORT_CONSUMER:
+        return sizeof(struct zmk_hid_consumer_report_body);
+#if IS_ENABLED(CONFIG_ZMK_POINTING)
+    case HOG_REPORT_MOUSE:
+        return sizeof(struct zmk_hid_mouse_report_body);
+#endif // IS_ENABLED(CONFIG_ZMK_POINTING)
     }
+
+    return 0;
 }
 
-K_WORK_DEFINE(hog_keyboard_work, send_keyboard_report_callback);
+// Must be called with the queue lock held.
+static void in_flight_reset(struct bt_conn *conn) {
+    in_flight = 0;
+    in_flight_conn = conn;
+    in_flight_generation++;
+}
 
-int zmk_hog_send_keyboard_report(struct zmk_hid_keyboard_report_body *report) {
-    int err = k_msgq_put(&zmk_hog_keyboard_msgq, report, K_MSEC(100));
-    if (err) {
-        switch (err) {
-        case -EAGAIN: {
-            LOG_WRN("Keyboard message queue full, popping first message and queueing again");
-            struct zmk_hid_keyboard_report_body discarded_report;
-            k_msgq_get(&zmk_hog_keyboard_msgq, &discarded_report, K_NO_WAIT);
-            return zmk_hog_send_keyboard_report(report);
-        }
-        default:
-            LOG_WRN("Failed to queue keyboard report to send (%d)", err);
-            return err;
-        }
+// Must be called with the queue lock held.
+static void queue_reset(void) {
+    queue_head = 0;
+    queue_len = 0;
+    in_flight_reset(NULL);
+    memset(&keyboard_prev, 0, sizeof(keyboard_prev));
+    memset(&keyboard_last, 0, sizeof(keyboard_last));
+    memset(&consumer_prev, 0, sizeof(consumer_prev));
+    memset(&consumer_last, 0, sizeof(consumer_last));
+}
+
+static void report_sent(struct bt_conn *conn, void *user_data) {
+    k_spinlock_key_t key = k_spin_lock(&queue_lock);
+    if (in_flight > 0 && (uintptr_t)user_data == in_flight_generation) {
+        in_flight--;
     }
+    k_spin_unlock(&queue_lock, key);
 
-    k_work_submit_to_queue(&hog_work_q, &hog_keyboard_work);
+    k_work_reschedule_for_queue(&hog_work_q, &hog_send_work, K_NO_WAIT);
+}
 
-    return 0;
-};
+static void send_reports_callback(struct k_work *work) {
+    struct bt_conn *conn = zmk_ble_active_profile_conn();
+    if (conn == NULL) {
+        // The host starts from a clean state when it reconnects, so there is no point keeping the
+        // reports for later.
+        k_spinlock_key_t key = k_spin_lock(&queue_lock);
+        queue_reset();
+        k_spin_unlock(&queue_lock, key);
+        k_sem_give(&queue_space_sem);
+        return;
+    }
 
-K_MSGQ_DEFINE(zmk_hog_consumer_msgq, sizeof(struct zmk_hid_consumer_report_body),
-              CONFIG_ZMK_BLE_CONSUMER_REPORT_QUEUE_SIZE, 4);
+    k_spinlock_key_t key = k_spin_lock(&queue_lock);
+    if (conn != in_flight_conn) {
+        // The active profile changed, so notifications pending on the old connection don't hold
+        // up the new one.
+        in_flight_reset(conn);
+    }
+    k_spin_unlock(&queue_lock, key);
 
-void send_consumer_report_callback(struct k_work *work) {
-    struct zmk_hid_consumer_report_body report;
+    while (true) {
+        key = k_spin_lock(&queue_lock);
 
-    while (k_msgq_get(&zmk_hog_consumer_msgq, &report, K_NO_WAIT) == 0) {
-        struct bt_conn *conn = zmk_ble_active_profile_conn();
-        if (conn == NULL) {
-            return;
+        // Go over the in-flight limit when the queue is full, rather than make the sender wait.
+        if (queue_len == 0 || (in_flight >= CONFIG_ZMK_BLE_MAX_REPORTS_IN_FLIGHT &&
+                               queue_len < REPORT_QUEUE_SIZE)) {
+            k_spin_unlock(&queue_lock, key);
+            break;
         }
 
+        struct queued_report report = queue[queue_head];
+        void *generation = (void *)in_flight_generation;
+        head_sending = true;
+
+        k_spin_unlock(&queue_lock, key);
+
         struct bt_gatt_notify_params notify_params = {
-            .attr = &hog_svc.attrs[9],
-            .data = &report,
-            .len = sizeof(report),
+            .attr = report_attr(report.type),
+            .data = &report.body,
+            .len = report_len(report.type),
+            .func = report_sent,
+            .user_data = generation,
         };
 
+        zmk_latency_trace_record(ZMK_LATENCY_TRACE_STAGE_TRANSPORT, "hog");
         int err = bt_gatt_notify_cb(conn, &notify_params);
+
+        key = k_spin_lock(&queue_lock);
+        head_sending = false;
+
+        if (err == -ENOMEM) {
+            // Out of notification buffers. Keep the report and retry once a notification is sent,
+            // or shortly if none of ours are pending.
+            bool retry_later = in_flight == 0;
+            k_spin_unlock(&queue_lock, key);
+            if (retry_later) {
+                k_work_schedule_for_queue(&hog_work_q, &hog_send_work, K_MSEC(1));
+            }
+            break;
+        }
+
+        if (err == 0) {
+            in_flight++;
+        }
+
+        queue_head = (queue_head + 1) % REPORT_QUEUE_SIZE;
+        queue_len--;
+
+        k_spin_unlock(&queue_lock, key);
+
+        k_sem_give(&queue_space_sem);
+
         if (err == -EPERM) {
             bt_conn_set_security(conn, BT_SECURITY_L2);
         } else if (err) {
             LOG_DBG("Error notifying %d", err);
         }
+    }
+
+    bt_conn_unref(conn);
+}
 
-        bt_conn_unref(conn);
+// Must be called with the queue lock held.
+static bool try_replace_tail(enum hog_report_type type, const void *body) {
+    if (queue_len == 0 || (queue_len == 1 && head_sending)) {
+        return false;
     }
-};
 
-K_WORK_DEFINE(hog_consumer_work, send_consumer_report_callback);
+    struct queued_report *tail = &queue[(queue_head + queue_len - 1) % REPORT_QUEUE_SIZE];
+    if (tail->type != type) {
+        return false;
+    }
 
-int zmk_hog_send_consumer_report(struct zmk_hid_consumer_report_body *report) {
-    int err = k_msgq_put(&zmk_hog_consumer_msgq, report, K_MSEC(100));
-    if (err) {
-        switch (err) {
-        case -EAGAIN: {
-            LOG_WRN("Consumer message queue full, popping first message and queueing again");
-            struct zmk_hid_consumer_report_body discarded_report;
-            k_msgq_get(&zmk_hog_consumer_msgq, &discarded_report, K_NO_WAIT);
-            return zmk_hog_send_consumer_report(report);
+    switch (type) {
+    case HOG_REPORT_KEYBOARD:
+        if (!zmk_hid_keyboard_report_can_merge(&keyboard_prev, &keyboard_last, body)) {
+            return false;
         }
-        default:
-            LOG_WRN("Failed to queue consumer report to send (%d)", err);
-            return err;
+        tail->body.keyboard = *(const struct zmk_hid_keyboard_report_body *)body;
+        keyboard_last = tail->body.keyboard;
+        return true;
+
+    case HOG_REPORT_CONSUMER:
+        if (!zmk_hid_consumer_report_can_merge(&consumer_prev, &consumer_last, body)) {
+            return false;
+        }
+        tail->body.consumer = *(const struct zmk_hid_consumer_report_body *)body;
+        consumer_last = tail->body.consumer;
+        return true;
+
+#if IS_ENABLED(CONFIG_ZMK_POINTING)
+    case HOG_REPORT_MOUSE: {
+        // Movement is relative, so it can be added up as long as no button changed in between.
+        const struct zmk_hid_mouse_report_body *next = body;
+        struct zmk_hid_mouse_report_body *last = &tail->body.mouse;
+        int32_t d_x = last->d_x + next->d_x;
+        int32_t d_y = last->d_y + next->d_y;
+        int32_t d_scroll_x = last->d_scroll_x + next->d_scroll_x;
+        int32_t d_scroll_y = last->d_scroll_y + next->d_scroll_y;
+
+        if (last->buttons != next->buttons || d_x != (int16_t)d_x || d_y != (int16_t)d_y ||
+            d_scroll_x != (int16_t)d_scroll_x || d_scroll_y != (int16_t)d_scroll_y) {
+            return false;
         }
+
+        last->d_x = d_x;
+        last->d_y = d_y;
+        last->d_scroll_x = d_scroll_x;
+        last->d_scroll_y = d_scroll_y;
+        return true;
+    }
+#endif // IS_ENABLED(CONFIG_ZMK_POINTING)
     }
 
-    k_work_submit_to_queue(&hog_work_q, &hog_consumer_work);
+    return false;
+}
 
-    return 0;
-};
+// Must be called with the queue lock held.
+static bool try_append(enum hog_report_type type, const void *body) {
+    if (queue_len == REPORT_QUEUE_SIZE) {
+        return false;
+    }
 
-#if IS_ENABLED(CONFIG_ZMK_POINTING)
+    struct queued_report *report = &queue[(queue_head + queue_len) % REPORT_QUEUE_SIZE];
+    report->type = type;
+    memcpy(&report->body, body, report_len(type));
+    queue_len++;
+
+    switch (type) {
+    case HOG_REPORT_KEYBOARD:
+        keyboard_prev = keyboard_last;
+        keyboard_last = report->body.keyboard;
+        break;
+    case HOG_REPORT_CONSUMER:
+        consumer_prev = consumer_last;
+        consumer_last = report->body.consumer;
+        break;
+    default:
+        break;
+    }
 
-K_MSGQ_DEFINE(zmk_hog_mouse_msgq, sizeof(struct zmk_hid_mouse_report_body),
-              CONFIG_ZMK_BLE_MOUSE_REPORT_QUEUE_SIZE, 4);
+    return true;
+}
 
-void send_mouse_report_callback(struct k_work *work) {
-    struct zmk_hid_mouse_report_body report;
-    while (k_msgq_get(&zmk_hog_mouse_msgq, &report, K_NO_WAIT) == 0) {
-        struct bt_conn *conn = zmk_ble_active_profile_conn();
-        if (conn == NULL) {
-            return;
-        }
+static int queue_report(enum hog_report_type type, const void *body) {
+    k_spinlock_key_t key = k_spin_lock(&queue_lock);
 
-        struct bt_gatt_notify_params notify_params = {
-            .attr = &hog_svc.attrs[13],
-            .data = &report,
-            .len = sizeof(report),
-        };
+    while (!try_replace_tail(type, body) && !try_append(type, body)) {
+        // Dropping a report could lose a press or release, so wait for room instead.
+        k_spin_unlock(&queue_lock, key);
+        k_work_reschedule_for_queue(&hog_work_q, &hog_send_work, K_NO_WAIT);
 
-        int err = bt_gatt_notify_cb(conn, &notify_params);
-        if (err == -EPERM) {
-            bt_conn_set_security(conn, BT_SECURITY_L2);
-        } else if (err) {
-            LOG_DBG("Error notifying %d", err);
+        if (k_sem_take(&queue_space_sem, K_MSEC(100)) != 0) {
+            LOG_WRN("HID report queue full, dropping report");
+            return -EAGAIN;
         }
 
-        bt_conn_unref(conn);
+        key = k_spin_lock(&queue_lock);
     }
+
+    k_spin_unlock(&queue_lock, key);
+
+    k_work_reschedule_for_queue(&hog_work_q, &hog_send_work, K_NO_WAIT);
+
+    return 0;
+}
+
+int zmk_hog_send_keyboard_report(struct zmk_hid_keyboard_report_body *report) {
+    return queue_report(HOG_REPORT_KEYBOARD, report);
+};
+
+int zmk_hog_send_consumer_report(struct zmk_hid_consumer_report_body *report) {
+    return queue_report(HOG_REPORT_CONSUMER, report);
 };
 
-K_WORK_DEFINE(hog_mouse_work, send_mouse_report_callback);
+#if IS_ENABLED(CONFIG_ZMK_POINTING)
 
 int zmk_hog_send_mouse_report(struct zmk_hid_mouse_report_body *report) {
-    int err = k_msgq_put(&zmk_hog_mouse_msgq, report, K_MSEC(100));
-    if (err) {
-        switch (err) {
-        case -EAGAIN: {
-            LOG_WRN("Consumer message queue full, popping first message and queueing again");
-            struct zmk_hid_mouse_report_body discarded_report;
-            k_msgq_get(&zmk_hog_mouse_msgq, &discarded_report, K_NO_WAIT);
-            return zmk_hog_send_mouse_report(report);
-        }
-        default:
-            LOG_WRN("Failed to queue mouse report to send (%d)", err);
-            return err;
-        }
+    return queue_report(HOG_REPORT_MOUSE, report);
+};
+
+#endif // IS_ENABLED(CONFIG_ZMK_POINTING)
+
+static void hog_disconnected(struct bt_conn *conn, uint8_t reason) {
+    k_spinlock_key_t key = k_spin_lock(&queue_lock);
+    const bool active = conn == in_flight_conn;
+    if (active) {
+        in_flight_reset(NULL);
     }
+    k_spin_unlock(&queue_lock, key);
 
-    k_work_submit_to_queue(&hog_work_q, &hog_mouse_work);
+    if (active) {
+        k_work_reschedule_for_queue(&hog_work_q, &hog_send_work, K_NO_WAIT);
+    }
+}
 
-    return 0;
+static struct bt_conn_cb conn_callbacks = {
+    .disconnected = hog_disconnected,
 };
-#endif // IS_ENABLED(CONFIG_ZMK_POINTING)
 
 static int zmk_hog_init(void) {
     static const struct k_work_queue_config queue_config = {.name = "HID Over GATT Send Work"};
     k_work_queue_start(&hog_work_q, hog_q_stack, K_THREAD_STACK_SIZEOF(hog_q_stack),
                        CONFIG_ZMK_BLE_THREAD_PRIORITY, &queue_config);
 
+    bt_conn_cb_register(&conn_callbacks);
+
     return 0;
 }
 
@@ -43,6 +43,7 @@ static zmk_keymap_layer_id_t _zmk_keymap_layer_default = 0;
 #define _TRANSFORM_SENSOR_ENTRY(idx, layer)                                                        \
     {                                                                                              \
         .behavior_dev = DEVICE_DT_NAME(DT_PHANDLE_BY_IDX(layer, sensor_bindings, idx)),            \
+        ZMK_BEHAVIOR_BINDING_DEVICE_INIT(DT_PHANDLE_BY_IDX(layer, sensor_bindings, idx))           \
         .param1 = COND_CODE_0(DT_PHA_HAS_CELL_AT_IDX(layer, sensor_bindings, idx, param1), (0),    \
                               (DT_PHA_BY_IDX(layer, sensor_bindings, idx, param1))),               \
         .param2 = COND_CODE_0(DT_PHA_HAS_CELL_AT_IDX(layer, sensor_bindings, idx, param2), (0),    \
@@ -72,11 +73,94 @@ static uint8_t keymap_layer_orders[ZMK_KEYMAP_LAYERS_LEN];
 
 #endif // IS_ENABLED(CONFIG_ZMK_KEYMAP_LAYER_REORDERING)
 
+#define KEYMAP_FOREACH_LAYER_SEP(fn, sep)                                                          \
+    COND_CODE_1(IS_ENABLED(CONFIG_ZMK_STUDIO), (DT_INST_FOREACH_CHILD_SEP(0, fn, sep)),            \
+                (DT_INST_FOREACH_CHILD_STATUS_OKAY_SEP(0, fn, sep)))
+
+#if DT_HAS_COMPAT_STATUS_OKAY(zmk_behavior_transparent)
+
+#define TRANSPARENT_NODE DT_COMPAT_GET_ANY_STATUS_OKAY(zmk_behavior_transparent)
+#define TRANSPARENT_BEHAVIOR DEVICE_DT_GET(TRANSPARENT_NODE)
+
+#else
+
+#define TRANSPARENT_BEHAVIOR NULL
+
+#endif
+
+#if IS_ENABLED(CONFIG_ZMK_KEYMAP_SPARSE_LAYERS)
+
+// Sparse layers only store the bindings that aren't transparent. Those of all layers are kept in
+// one array, ordered by layer ID and then by key position. A bitmap of the key positions each layer
+// has a binding for gives the index of a binding from the number of bits set before it.
+
+#define IS_TRANSPARENT_BINDING(node, idx)                                                          \
+    DT_NODE_HAS_COMPAT(DT_PHANDLE_BY_IDX(node, bindings, idx), zmk_behavior_transparent)
+
+#define _SPARSE_BINDING(idx, node)                                                                 \
+    COND_CODE_1(IS_TRANSPARENT_BINDING(node, idx), (), (ZMK_KEYMAP_EXTRACT_BINDING(idx, node), ))
+#define _SPARSE_POSITION(idx, node) COND_CODE_1(IS_TRANSPARENT_BINDING(node, idx), (), (idx, ))
+#define _SPARSE_COUNT(idx, node) +COND_CODE_1(IS_TRANSPARENT_BINDING(node, idx), (0), (1))
+
+#define SPARSE_LAYER_BINDINGS(node)                                                                \
+    COND_CODE_1(DT_NODE_HAS_PROP(node, bindings),                                                  \
+                (LISTIFY(DT_PROP_LEN(node, bindings), _SPARSE_BINDING, (), node)), ())
+#define SPARSE_LAYER_POSITIONS(node)                                                               \
+    COND_CODE_1(DT_NODE_HAS_PROP(node, bindings),                                                  \
+                (LISTIFY(DT_PROP_LEN(node, bindings), _SPARSE_POSITION, (), node)), ())
+#define SPARSE_LAYER_LEN(node)                                                                     \
+    (0 COND_CODE_1(DT_NODE_HAS_PROP(node, bindings),                                               \
+                   (LISTIFY(DT_PROP_LEN(node, bindings), _SPARSE_COUNT, (), node)), ()))
+
+#define SPARSE_STOCK_LEN (KEYMAP_FOREACH_LAYER_SEP(SPARSE_LAYER_LEN, (+)))
+#define SPARSE_LEN (SPARSE_STOCK_LEN + CONFIG_ZMK_KEYMAP_SPARSE_LAYERS_SPARE_BINDINGS)
+#define SPARSE_WORDS DIV_ROUND_UP(ZMK_KEYMAP_LEN, 32)
+
+#define SPARSE_VAR(_name, _opts, _len)                                                             \
+    static _opts struct zmk_behavior_binding _name[_len] = {                                       \
+        KEYMAP_FOREACH_LAYER_SEP(SPARSE_LAYER_BINDINGS, ())};
+
+struct sparse_layer {
+    // A bit is set for each key position with a binding stored for it.
+    uint32_t present[SPARSE_WORDS];
+    // Number of bindings stored for the key positions before each word of the bitmap.
+    uint16_t rank[SPARSE_WORDS];
+    // Index of the layer's first binding.
+    uint16_t offset;
+};
+
+SPARSE_VAR(zmk_keymap_bindings,
+           COND_CODE_1(IS_ENABLED(CONFIG_ZMK_KEYMAP_SETTINGS_STORAGE), (), (const)), SPARSE_LEN)
+
+static uint16_t zmk_keymap_bindings_len = SPARSE_STOCK_LEN;
+
+static struct sparse_layer zmk_keymap_sparse_layers[ZMK_KEYMAP_LAYERS_LEN];
+
+static const uint16_t zmk_stock_keymap_positions[SPARSE_STOCK_LEN] = {
+    KEYMAP_FOREACH_LAYER_SEP(SPARSE_LAYER_POSITIONS, ())};
+
+static const uint16_t zmk_stock_keymap_layer_lens[ZMK_KEYMAP_LAYERS_LEN] = {
+    KEYMAP_FOREACH_LAYER_SEP(SPARSE_LAYER_LEN, (, ))};
+
+#if IS_ENABLED(CONFIG_ZMK_KEYMAP_SETTINGS_STORAGE)
+
+SPARSE_VAR(zmk_stock_keymap_bindings, const, SPARSE_STOCK_LEN)
+
+#endif
+
+// Returned for the key positions a sparse layer doesn't store a binding for.
+static const struct zmk_behavior_binding transparent_binding = {
+#if DT_HAS_COMPAT_STATUS_OKAY(zmk_behavior_transparent)
+    .behavior_dev = DEVICE_DT_NAME(TRANSPARENT_NODE),
+    ZMK_BEHAVIOR_BINDING_DEVICE_INIT(TRANSPARENT_NODE)
+#endif
+};
+
+#else
+
 #define KEYMAP_VAR(_name, _opts)                                                                   \
     static _opts struct zmk_behavior_binding _name[ZMK_KEYMAP_LAYERS_LEN][ZMK_KEYMAP_LEN] = {      \
-        COND_CODE_1(IS_ENABLED(CONFIG_ZMK_STUDIO),                                                 \
-                    (DT_INST_FOREACH_CHILD_SEP(0, TRANSFORMED_LAYER, (, ))),                       \
-                    (DT_INST_FOREACH_CHILD_STATUS_OKAY_SEP(0, TRANSFORMED_LAYER, (, ))))};
+        KEYMAP_FOREACH_LAYER_SEP(TRANSFORMED_LAYER, (, ))};
 
 KEYMAP_VAR(zmk_keymap, COND_CODE_1(IS_ENABLED(CONFIG_ZMK_KEYMAP_SETTINGS_STORAGE), (), (const)))
 
@@ -84,6 +168,12 @@ KEYMAP_VAR(zmk_keymap, COND_CODE_1(IS_ENABLED(CONFIG_ZMK_KEYMAP_SETTINGS_STORAGE
 
 KEYMAP_VAR(zmk_stock_keymap, const)
 
+#endif
+
+#endif // IS_ENABLED(CONFIG_ZMK_KEYMAP_SPARSE_LAYERS)
+
+#if IS_ENABLED(CONFIG_ZMK_KEYMAP_SETTINGS_STORAGE)
+
 static char zmk_keymap_layer_names[ZMK_KEYMAP_LAYERS_LEN][CONFIG_ZMK_KEYMAP_LAYER_NAME_MAX_LEN] = {
     DT_INST_FOREACH_CHILD_SEP(0, LAYER_NAME, (, ))};
 
@@ -131,6 +221,278 @@ uint8_t map_layer_id_to_index(zmk_keymap_layer_id_t layer_id) {
 
 #endif // IS_ENABLED(CONFIG_ZMK_KEYMAP_LAYER_REORDERING)
 
+#if IS_ENABLED(CONFIG_ZMK_KEYMAP_SPARSE_LAYERS)
+
+static void update_sparse_ranks(struct sparse_layer *layer) {
+    layer->rank[0] = 0;
+    for (int w = 1; w < SPARSE_WORDS; w++) {
+        layer->rank[w] = layer->rank[w - 1] + POPCOUNT(layer->present[w - 1]);
+    }
+}
+
+static void load_stock_sparse_layers(void) {
+    uint16_t offset = 0;
+
+    for (int l = 0; l < ZMK_KEYMAP_LAYERS_LEN; l++) {
+        struct sparse_layer *layer = &zmk_keymap_sparse_layers[l];
+
+        memset(layer->present, 0, sizeof(layer->present));
+        layer->offset = offset;
+
+        for (int i = 0; i < zmk_stock_keymap_layer_lens[l]; i++) {
+            uint16_t position = zmk_stock_keymap_positions[offset + i];
+            layer->present[position / 32] |= BIT(position % 32);
+        }
+
+        update_sparse_ranks(layer);
+        offset += zmk_stock_keymap_layer_lens[l];
+    }
+
+    zmk_keymap_bindings_len = offset;
+}
+
+// Index of the binding for the key position, or where it would be inserted if there isn't one.
+static uint16_t sparse_binding_idx(const struct sparse_layer *layer, uint32_t storage_idx) {
+    return layer->offset + layer->rank[storage_idx / 32] +
+           POPCOUNT(layer->present[storage_idx / 32] & (BIT(storage_idx % 32) - 1));
+}
+
+static bool sparse_binding_present(const struct sparse_layer *layer, uint32_t storage_idx) {
+    return layer->present[storage_idx / 32] & BIT(storage_idx % 32);
+}
+
+static const struct zmk_behavior_binding *keymap_binding(zmk_keymap_layer_id_t layer_id,
+                                                         uint32_t storage_idx) {
+    const struct sparse_layer *layer = &zmk_keymap_sparse_layers[layer_id];
+
+    if (!sparse_binding_present(layer, storage_idx)) {
+        return &transparent_binding;
+    }
+
+    return &zmk_keymap_bindings[sparse_binding_idx(layer, storage_idx)];
+}
+
+#if IS_ENABLED(CONFIG_ZMK_KEYMAP_SETTINGS_STORAGE)
+
+static const struct zmk_behavior_binding *stock_keymap_binding(zmk_keymap_layer_id_t layer_id,
+                                                               uint32_t storage_idx) {
+    uint16_t offset = 0;
+    for (int l = 0; l < layer_id; l++) {
+        offset += zmk_stock_keymap_layer_lens[l];
+    }
+
+    for (int i = offset; i < offset + zmk_stock_keymap_layer_lens[layer_id]; i++) {
+        if (zmk_stock_keymap_positions[i] == storage_idx) {
+            return &zmk_stock_keymap_bindings[i];
+        }
+    }
+
+    return &transparent_binding;
+}
+
+static int keymap_set_binding(zmk_keymap_layer_id_t layer_id, uint32_t storage_idx,
+                              const struct zmk_behavior_binding *binding) {
+    struct sparse_layer *layer = &zmk_keymap_sparse_layers[layer_id];
+    const struct device *behavior = zmk_behavior_get_binding_device(binding);
+    bool transparent = behavior && behavior == TRANSPARENT_BEHAVIOR;
+    bool present = sparse_binding_present(layer, storage_idx);
+    uint16_t idx = sparse_binding_idx(layer, storage_idx);
+    int shift;
+
+    if (present && !transparent) {
+        zmk_keymap_bindings[idx] = *binding;
+        return 0;
+    } else if (present) {
+        memmove(&zmk_keymap_bindings[idx], &zmk_keymap_bindings[idx + 1],
+                (zmk_keymap_bindings_len - idx - 1) * sizeof(zmk_keymap_bindings[0]));
+        zmk_keymap_bindings_len--;
+        shift = -1;
+    } else if (!transparent) {
+        if (zmk_keymap_bindings_len == ARRAY_SIZE(zmk_keymap_bindings)) {
+            LOG_WRN("No room for another binding, increase "
+                    "CONFIG_ZMK_KEYMAP_SPARSE_LAYERS_SPARE_BINDINGS");
+            return -ENOMEM;
+        }
+
+        memmove(&zmk_keymap_bindings[idx + 1], &zmk_keymap_bindings[idx],
+                (zmk_keymap_bindings_len - idx) * sizeof(zmk_keymap_bindings[0]));
+        zmk_keymap_bindings[idx] = *binding;
+        zmk_keymap_bindings_len++;
+        shift = 1;
+    } else {
+        return 0;
+    }
+
+    WRITE_BIT(layer->present[storage_idx / 32], storage_idx % 32, !present);
+    update_sparse_ranks(layer);
+
+    for (int l = layer_id + 1; l < ZMK_KEYMAP_LAYERS_LEN; l++) {
+        zmk_keymap_sparse_layers[l].offset += shift;
+    }
+
+    return 0;
+}
+
+#endif // IS_ENABLED(CONFIG_ZMK_KEYMAP_SETTINGS_STORAGE)
+
+#if IS_ENABLED(CONFIG_ZMK_KEYMAP_SETTINGS_STORAGE)
+
+static inline struct zmk_behavior_binding *keymap_stored_bindings(size_t *len) {
+    *len = zmk_keymap_bindings_len;
+    return zmk_keymap_bindings;
+}
+
+#endif // IS_ENABLED(CONFIG_ZMK_KEYMAP_SETTINGS_STORAGE)
+
+#else
+
+static const struct zmk_behavior_binding *keymap_binding(zmk_keymap_layer_id_t layer_id,
+                                                         uint32_t storage_idx) {
+    return &zmk_keymap[layer_id][storage_idx];
+}
+
+#if IS_ENABLED(CONFIG_ZMK_KEYMAP_SETTINGS_STORAGE)
+
+static const struct zmk_behavior_binding *stock_keymap_binding(zmk_keymap_layer_id_t layer_id,
+                                                               uint32_t storage_idx) {
+    return &zmk_stock_keymap[layer_id][storage_idx];
+}
+
+static int keymap_set_binding(zmk_keymap_layer_id_t layer_id, uint32_t storage_idx,
+                              const struct zmk_behavior_binding *binding) {
+    zmk_keymap[layer_id][storage_idx] = *binding;
+    return 0;
+}
+
+#endif // IS_ENABLED(CONFIG_ZMK_KEYMAP_SETTINGS_STORAGE)
+
+#if IS_ENABLED(CONFIG_ZMK_KEYMAP_SETTINGS_STORAGE)
+
+static inline struct zmk_behavior_binding *keymap_stored_bindings(size_t *len) {
+    *len = ZMK_KEYMAP_LAYERS_LEN * ZMK_KEYMAP_LEN;
+    return &zmk_keymap[0][0];
+}
+
+#endif // IS_ENABLED(CONFIG_ZMK_KEYMAP_SETTINGS_STORAGE)
+
+#endif // IS_ENABLED(CONFIG_ZMK_KEYMAP_SPARSE_LAYERS)
+
+#if IS_ENABLED(CONFIG_ZMK_KEYMAP_SETTINGS_STORAGE)
+
+// The stock bindings have their devices set at build time, only those loaded from settings need to
+// be looked up by name.
+static void resolve_keymap_bindings(void) {
+#if IS_ENABLED(CONFIG_ZMK_BEHAVIOR_DEVICES_IN_BINDINGS)
+    size_t len;
+    struct zmk_behavior_binding *bindings = keymap_stored_bindings(&len);
+
+    for (size_t i = 0; i < len; i++) {
+        zmk_behavior_resolve_binding(&bindings[i]);
+    }
+#endif // IS_ENABLED(CONFIG_ZMK_BEHAVIOR_DEVICES_IN_BINDINGS)
+}
+
+#endif // IS_ENABLED(CONFIG_ZMK_KEYMAP_SETTINGS_STORAGE)
+
+#if IS_ENABLED(CONFIG_ZMK_KEYMAP_BINDING_CACHE)
+
+#define POSITION_BITS_SIZE DIV_ROUND_UP(ZMK_KEYMAP_LEN, 8)
+
+// Bindings that always fall through to the next active layer, indexed by layer ID and stored key
+// position. These are skipped when working out which binding a key position resolves to.
+static uint8_t zmk_keymap_transparent_bindings[ZMK_KEYMAP_LAYERS_LEN][POSITION_BITS_SIZE];
+
+// For each stored key position, the index of the highest active layer with a binding that isn't
+// transparent, or ZMK_KEYMAP_LAYER_ID_INVAL if every layer needs to be walked.
+static zmk_keymap_layer_index_t zmk_keymap_resolved_layer_idx[ZMK_KEYMAP_LEN];
+
+// The layer index each key position started at when it was pressed, so the release is sent to the
+// same binding.
+static zmk_keymap_layer_index_t zmk_keymap_pressed_layer_idx[ZMK_KEYMAP_LEN];
+
+static bool binding_is_transparent(zmk_keymap_layer_id_t layer_id, uint32_t storage_idx) {
+    return zmk_keymap_transparent_bindings[layer_id][storage_idx / 8] & BIT(storage_idx % 8);
+}
+
+static void update_transparent_binding(zmk_keymap_layer_id_t layer_id, uint32_t storage_idx) {
+    const struct device *behavior =
+        zmk_behavior_get_binding_device(keymap_binding(layer_id, storage_idx));
+
+    // Bindings without a behavior fall through too, see zmk_behavior_invoke_binding.
+    WRITE_BIT(zmk_keymap_transparent_bindings[layer_id][storage_idx / 8], storage_idx % 8,
+              !behavior || behavior == TRANSPARENT_BEHAVIOR);
+}
+
+static zmk_keymap_layer_index_t resolve_layer_idx(uint32_t storage_idx, int start_idx) {
+    const int default_idx = LAYER_ID_TO_INDEX(_zmk_keymap_layer_default);
+
+    // We use int here to be sure we don't loop layer_idx back to UINT8_MAX
+    for (int layer_idx = start_idx; layer_idx >= default_idx; layer_idx--) {
+        zmk_keymap_layer_id_t layer_id = LAYER_INDEX_TO_ID(layer_idx);
+
+        if (layer_id == ZMK_KEYMAP_LAYER_ID_INVAL) {
+            continue;
+        }
+        if (zmk_keymap_layer_active(layer_id) && !binding_is_transparent(layer_id, storage_idx)) {
+            return layer_idx;
+        }
+    }
+
+    return ZMK_KEYMAP_LAYER_ID_INVAL;
+}
+
+static void refresh_resolved_layers(void) {
+    for (int k = 0; k < ZMK_KEYMAP_LEN; k++) {
+        zmk_keymap_resolved_layer_idx[k] = resolve_layer_idx(k, ZMK_KEYMAP_LAYERS_LEN - 1);
+    }
+}
+
+static void refresh_binding_cache(void) {
+    for (int l = 0; l < ZMK_KEYMAP_LAYERS_LEN; l++) {
+        for (int k = 0; k < ZMK_KEYMAP_LEN; k++) {
+            update_transparent_binding(l, k);
+        }
+    }
+
+    refresh_resolved_layers();
+}
+
+// Only key positions that can resolve to the changed layer need updating. Activating a layer can
+// only raise the resolved layer, and deactivating one only affects the positions resolved to it.
+static void update_resolved_layers(zmk_keymap_layer_id_t layer_id, bool state) {
+    zmk_keymap_layer_index_t changed_idx = LAYER_ID_TO_INDEX(layer_id);
+
+    if (changed_idx == ZMK_KEYMAP_LAYER_ID_INVAL ||
+        changed_idx < LAYER_ID_TO_INDEX(_zmk_keymap_layer_default)) {
+        return;
+    }
+
+    for (int k = 0; k < ZMK_KEYMAP_LEN; k++) {
+        zmk_keymap_layer_index_t *resolved_idx = &zmk_keymap_resolved_layer_idx[k];
+
+        if (!state) {
+            if (*resolved_idx == changed_idx) {
+                *resolved_idx = resolve_layer_idx(k, changed_idx - 1);
+            }
+        } else if (!binding_is_transparent(layer_id, k) &&
+                   (*resolved_idx == ZMK_KEYMAP_LAYER_ID_INVAL || changed_idx > *resolved_idx)) {
+            *resolved_idx = changed_idx;
+        }
+    }
+}
+
+static zmk_keymap_layer_index_t cached_layer_idx(uint32_t position) {
+    const uint32_t *pos_map;
+    int ret = zmk_physical_layouts_get_selected_to_stock_position_map(&pos_map);
+    if (ret < 0 || position >= ret || pos_map[position] >= ZMK_KEYMAP_LEN) {
+        return ZMK_KEYMAP_LAYER_ID_INVAL;
+    }
+
+    return zmk_keymap_resolved_layer_idx[pos_map[position]];
+}
+
+#endif // IS_ENABLED(CONFIG_ZMK_KEYMAP_BINDING_CACHE)
+
 static inline int set_layer_state(zmk_keymap_layer_id_t layer_id, bool state) {
     int ret = 0;
     if (layer_id >= ZMK_KEYMAP_LAYERS_LEN) {
@@ -146,6 +508,10 @@ static inline int set_layer_state(zmk_keymap_layer_id_t layer_id, bool state) {
     WRITE_BIT(_zmk_keymap_layer_state, layer_id, state);
     // Don't send state changes unless there was an actual change
     if (old_state != _zmk_keymap_layer_state) {
+#if IS_ENABLED(CONFIG_ZMK_KEYMAP_BINDING_CACHE)
+        update_resolved_layers(layer_id, state);
+#endif
+
         LOG_DBG("layer_changed: layer %d state %d", layer_id, state);
         ret = raise_layer_state_changed(layer_id, state);
         if (ret < 0) {
@@ -250,7 +616,7 @@ zmk_keymap_get_layer_binding_at_idx(zmk_keymap_layer_id_t layer_id, uint8_t bind
         return NULL;
     }
 
-    return &zmk_keymap[layer_id][mapped_idx];
+    return keymap_binding(layer_id, mapped_idx);
 }
 
 #if IS_ENABLED(CONFIG_ZMK_KEYMAP_SETTINGS_STORAGE)
@@ -286,18 +652,30 @@ int zmk_keymap_set_layer_binding_at_idx(zmk_keymap_layer_id_t layer_id, uint8_t
         return -EINVAL;
     }
 
-    if (memcmp(&zmk_keymap[layer_id][storage_binding_idx], &binding, sizeof(binding)) == 0) {
+    // Resolve before comparing, so the stored and incoming bindings only differ by their content.
+    zmk_behavior_resolve_binding(&binding);
+
+    if (memcmp(keymap_binding(layer_id, storage_binding_idx), &binding, sizeof(binding)) == 0) {
         LOG_DBG("Not setting, no change to layer %d at index %d (%d)", layer_id, binding_idx,
                 storage_binding_idx);
         return 0;
     }
 
+    // TODO: Need a mutex to protect access to the keymap data?
+    ret = keymap_set_binding(layer_id, storage_binding_idx, &binding);
+    if (ret < 0) {
+        return ret;
+    }
+
     uint8_t *pending = zmk_keymap_layer_pending_changes[layer_id];
 
     WRITE_BIT(pending[storage_binding_idx / 8], storage_binding_idx % 8, 1);
 
-    // TODO: Need a mutex to protect access to the keymap data?
-    memcpy(&zmk_keymap[layer_id][storage_binding_idx], &binding, sizeof(binding));
+#if IS_ENABLED(CONFIG_ZMK_KEYMAP_BINDING_CACHE)
+    update_transparent_binding(layer_id, storage_binding_idx);
+    zmk_keymap_resolved_layer_idx[storage_binding_idx] =
+        resolve_layer_idx(storage_binding_idx, ZMK_KEYMAP_LAYERS_LEN - 1);
+#endif
 
     return 0;
 }
@@ -342,6 +720,10 @@ int zmk_keymap_move_layer(zmk_keymap_layer_index_t start_idx, zmk_keymap_layer_i
         keymap_layer_orders[dest_idx] = val;
     }
 
+#if IS_ENABLED(CONFIG_ZMK_KEYMAP_BINDING_CACHE)
+    refresh_resolved_layers();
+#endif
+
     return 0;
 }
 
@@ -360,6 +742,9 @@ int zmk_keymap_add_layer(void) {
         for (int candidate_id = 0; candidate_id < ZMK_KEYMAP_LAYERS_LEN; candidate_id++) {
             if (!(seen_layer_ids & BIT(candidate_id))) {
                 keymap_layer_orders[index] = candidate_id;
+#if IS_ENABLED(CONFIG_ZMK_KEYMAP_BINDING_CACHE)
+                refresh_resolved_layers();
+#endif
                 return index;
             }
         }
@@ -387,6 +772,10 @@ int zmk_keymap_remove_layer(zmk_keymap_layer_index_t index) {
 
     LOG_HEXDUMP_DBG(keymap_layer_orders, ZMK_KEYMAP_LAYERS_LEN, "Order");
 
+#if IS_ENABLED(CONFIG_ZMK_KEYMAP_BINDING_CACHE)
+    refresh_resolved_layers();
+#endif
+
     return 0;
 }
 
@@ -400,6 +789,10 @@ int zmk_keymap_restore_layer(zmk_keymap_layer_id_t id, zmk_keymap_layer_index_t
 
     keymap_layer_orders[at_index] = id;
 
+#if IS_ENABLED(CONFIG_ZMK_KEYMAP_BINDING_CACHE)
+    refresh_resolved_layers();
+#endif
+
     return 0;
 }
 
@@ -484,7 +877,7 @@ static int save_bindings(void) {
         for (int kp = 0; kp < ZMK_KEYMAP_LEN; kp++) {
             if (pending[kp / 8] & BIT(kp % 8)) {
 
-                const struct zmk_behavior_binding *binding = &zmk_keymap[l][kp];
+                const struct zmk_behavior_binding *binding = keymap_binding(l, kp);
                 LOG_DBG("Pending save for layer %d at key position %d: %s with %d, %d", l, kp,
                         binding->behavior_dev, binding->param1, binding->param2);
 
@@ -586,11 +979,20 @@ static void load_stock_keymap_layer_ordering() {
 #endif
 
 static void reload_from_stock_keymap(void) {
+#if IS_ENABLED(CONFIG_ZMK_KEYMAP_SPARSE_LAYERS)
+    memcpy(zmk_keymap_bindings, zmk_stock_keymap_bindings, sizeof(zmk_stock_keymap_bindings));
+    load_stock_sparse_layers();
+#else
     for (int l = 0; l < ZMK_KEYMAP_LAYERS_LEN; l++) {
         for (int k = 0; k < ZMK_KEYMAP_LEN; k++) {
             zmk_keymap[l][k] = zmk_stock_keymap[l][k];
         }
     }
+#endif // IS_ENABLED(CONFIG_ZMK_KEYMAP_SPARSE_LAYERS)
+
+#if IS_ENABLED(CONFIG_ZMK_KEYMAP_BINDING_CACHE)
+    refresh_binding_cache();
+#endif
 }
 
 int zmk_keymap_discard_changes(void) {
@@ -650,7 +1052,7 @@ int zmk_keymap_reset_settings(void) {
         uint8_t *changes = zmk_keymap_layer_changes[l];
 
         for (int k = 0; k < ZMK_KEYMAP_LEN; k++) {
-            if (memcmp(&zmk_keymap[l][k], &zmk_stock_keymap[l][k],
+            if (memcmp(keymap_binding(l, k), stock_keymap_binding(l, k),
                        sizeof(struct zmk_behavior_binding_setting)) == 0) {
                 continue;
             }
@@ -700,15 +1102,11 @@ int zmk_keymap_apply_position_state(uint8_t source, zmk_keymap_layer_id_t layer_
     return zmk_behavior_invoke_binding(binding, event, pressed);
 }
 
-int zmk_keymap_position_state_changed(uint8_t source, uint32_t position, bool pressed,
-                                      int64_t timestamp) {
-    if (pressed) {
-        zmk_keymap_active_behavior_layer[position] = _zmk_keymap_layer_state;
-    }
-
+static int apply_position_state_from_layer_idx(uint8_t source, int start_idx, uint32_t position,
+                                              bool pressed, int64_t timestamp) {
     // We use int here to be sure we don't loop layer_idx back to UINT8_MAX
-    for (int layer_idx = ZMK_KEYMAP_LAYERS_LEN - 1;
-         layer_idx >= LAYER_ID_TO_INDEX(_zmk_keymap_layer_default); layer_idx--) {
+    for (int layer_idx = start_idx; layer_idx >= LAYER_ID_TO_INDEX(_zmk_keymap_layer_default);
+         layer_idx--) {
         zmk_keymap_layer_id_t layer_id = LAYER_INDEX_TO_ID(layer_idx);
 
         if (layer_id == ZMK_KEYMAP_LAYER_ID_INVAL) {
@@ -733,6 +1131,29 @@ int zmk_keymap_position_state_changed(uint8_t source, uint32_t position, bool pr
     return -ENOTSUP;
 }
 
+int zmk_keymap_position_state_changed(uint8_t source, uint32_t position, bool pressed,
+                                      int64_t timestamp) {
+    int start_idx = ZMK_KEYMAP_LAYERS_LEN - 1;
+
+    if (pressed) {
+        zmk_keymap_active_behavior_layer[position] = _zmk_keymap_layer_state;
+    }
+
+#if IS_ENABLED(CONFIG_ZMK_KEYMAP_BINDING_CACHE)
+    // Layers above the cached one are inactive or transparent at this position, so start there.
+    // The layers below are still walked in case the behavior asks to continue to the next layer.
+    if (pressed) {
+        zmk_keymap_pressed_layer_idx[position] = cached_layer_idx(position);
+    }
+
+    if (zmk_keymap_pressed_layer_idx[position] != ZMK_KEYMAP_LAYER_ID_INVAL) {
+        start_idx = zmk_keymap_pressed_layer_idx[position];
+    }
+#endif
+
+    return apply_position_state_from_layer_idx(source, start_idx, position, pressed, timestamp);
+}
+
 #if ZMK_KEYMAP_HAS_SENSORS
 int zmk_keymap_sensor_event(uint8_t sensor_index,
                             const struct zmk_sensor_channel_data *channel_data,
@@ -751,7 +1172,7 @@ int zmk_keymap_sensor_event(uint8_t sensor_index,
         LOG_DBG("layer idx: %d, layer id: %d sensor_index: %d, binding name: %s", layer_idx,
                 layer_id, sensor_index, binding->behavior_dev);
 
-        const struct device *behavior = zmk_behavior_get_binding(binding->behavior_dev);
+        const struct device *behavior = zmk_behavior_get_binding_device(binding);
         if (!behavior) {
             LOG_DBG("No behavior assigned to %d on layer %d", sensor_index, layer_id);
             continue;
@@ -895,7 +1316,7 @@ static int keymap_handle_set(const char *name, size_t len, settings_read_cb read
                     binding_setting.behavior_local_id);
         }
 
-        zmk_keymap[layer][key_position] = (struct zmk_behavior_binding){
+        struct zmk_behavior_binding binding = {
 #if IS_ENABLED(CONFIG_ZMK_BEHAVIOR_LOCAL_IDS_IN_BINDINGS)
             .local_id = binding_setting.behavior_local_id,
 #endif
@@ -903,6 +1324,12 @@ static int keymap_handle_set(const char *name, size_t len, settings_read_cb read
             .param1 = binding_setting.param1,
             .param2 = binding_setting.param2,
         };
+
+        err = keymap_set_binding(layer, key_position, &binding);
+        if (err < 0) {
+            LOG_ERR("Failed to set keymap binding from settings (err %d)", err);
+            return err;
+        }
     }
 #if IS_ENABLED(CONFIG_ZMK_KEYMAP_LAYER_REORDERING)
     else if (settings_name_steq(name, "layer_order", &next) && !next) {
@@ -926,23 +1353,30 @@ static int keymap_handle_set(const char *name, size_t len, settings_read_cb read
 
 static int keymap_handle_commit(void) {
 #if IS_ENABLED(CONFIG_ZMK_BEHAVIOR_LOCAL_IDS_IN_BINDINGS)
-    for (int l = 0; l < ZMK_KEYMAP_LAYERS_LEN; l++) {
-        for (int p = 0; p < ZMK_KEYMAP_LEN; p++) {
-            struct zmk_behavior_binding *binding = &zmk_keymap[l][p];
+    size_t len;
+    struct zmk_behavior_binding *bindings = keymap_stored_bindings(&len);
 
-            if (binding->local_id > 0 && !binding->behavior_dev) {
-                binding->behavior_dev =
-                    zmk_behavior_find_behavior_name_from_local_id(binding->local_id);
+    for (size_t i = 0; i < len; i++) {
+        struct zmk_behavior_binding *binding = &bindings[i];
 
-                if (!binding->behavior_dev) {
-                    LOG_ERR("Failed to finding device for local ID %d after settings load",
-                            binding->local_id);
-                }
+        if (binding->local_id > 0 && !binding->behavior_dev) {
+            binding->behavior_dev =
+                zmk_behavior_find_behavior_name_from_local_id(binding->local_id);
+
+            if (!binding->behavior_dev) {
+                LOG_ERR("Failed to finding device for local ID %d after settings load",
+                        binding->local_id);
             }
         }
     }
 #endif
 
+    resolve_keymap_bindings();
+
+#if IS_ENABLED(CONFIG_ZMK_KEYMAP_BINDING_CACHE)
+    refresh_binding_cache();
+#endif
+
     return 0;
 }
 
@@ -956,6 +1390,21 @@ int keymap_init(void) {
     load_stock_keymap_layer_ordering();
 #endif
 
+#if IS_ENABLED(CONFIG_ZMK_KEYMAP_SPARSE_LAYERS)
+    load_stock_sparse_layers();
+
+    LOG_INF("Sparse keymap stores %d of %d bindings in %d bytes, dense layers would use %d",
+            zmk_keymap_bindings_len, ZMK_KEYMAP_LAYERS_LEN * ZMK_KEYMAP_LEN,
+            sizeof(zmk_keymap_bindings) + sizeof(zmk_keymap_sparse_layers),
+            ZMK_KEYMAP_LAYERS_LEN * ZMK_KEYMAP_LEN * sizeof(struct zmk_behavior_binding));
+#endif // IS_ENABLED(CONFIG_ZMK_KEYMAP_SPARSE_LAYERS)
+
+#if IS_ENABLED(CONFIG_ZMK_KEYMAP_BINDING_CACHE)
+    memset(zmk_keymap_pressed_layer_idx, ZMK_KEYMAP_LAYER_ID_INVAL,
+           sizeof(zmk_keymap_pressed_layer_idx));
+    refresh_binding_cache();
+#endif
+
     return 0;
 }
 
@@ -0,0 +1,191 @@
+/*
+ * Copyright (c) 2024 The ZMK Contributors
+ *
+ * SPDX-License-Identifier: MIT
+ */
+
+#include <zephyr/kernel.h>
+#include <zephyr/init.h>
+#include <zephyr/sys/atomic.h>
+#include <zephyr/sys/util.h>
+#include <zephyr/logging/log.h>
+
+LOG_MODULE_DECLARE(zmk, CONFIG_ZMK_LOG_LEVEL);
+
+#include <zmk/latency_trace.h>
+
+#define BUFFER_SIZE CONFIG_ZMK_LATENCY_TRACE_BUFFER_SIZE
+
+BUILD_ASSERT(IS_POWER_OF_TWO(BUFFER_SIZE),
+             "CONFIG_ZMK_LATENCY_TRACE_BUFFER_SIZE must be a power of two");
+
+struct trace_slot {
+    // Index + 1 of the claim that last completed writing this slot, or 0 while being written.
+    atomic_t seq;
+    struct zmk_latency_trace_record record;
+};
+
+static struct trace_slot slots[BUFFER_SIZE];
+
+// Producers claim slots by incrementing the write index, so records can be added from any context
+// without locking. A reader that falls more than a full buffer behind skips the overwritten slots.
+static atomic_t write_index = ATOMIC_INIT(0);
+static uint32_t read_index;
+
+static atomic_t next_id = ATOMIC_INIT(0);
+static atomic_t current_id = ATOMIC_INIT(0);
+
+static void record(uint32_t id, enum zmk_latency_trace_stage stage, const char *label) {
+    uint32_t cycles = k_cycle_get_32();
+    uint32_t index = (uint32_t)atomic_inc(&write_index);
+    struct trace_slot *slot = &slots[index & (BUFFER_SIZE - 1)];
+
+    atomic_set(&slot->seq, 0);
+    slot->record = (struct zmk_latency_trace_record){
+        .id = id,
+        .cycles = cycles,
+        .label = label,
+        .stage = stage,
+    };
+    atomic_set(&slot->seq, index + 1);
+}
+
+#if IS_ENABLED(CONFIG_ZMK_LATENCY_TRACE_LOG)
+
+static void latency_trace_log_work_cb(struct k_work *work);
+
+static K_WORK_DELAYABLE_DEFINE(log_work, latency_trace_log_work_cb);
+
+#endif // IS_ENABLED(CONFIG_ZMK_LATENCY_TRACE_LOG)
+
+uint32_t zmk_latency_trace_begin(void) {
+    // Zero is reserved for "no trace", so skip it when the counter wraps.
+    uint32_t id = (uint32_t)atomic_inc(&next_id) + 1;
+    if (id == 0) {
+        id = (uint32_t)atomic_inc(&next_id) + 1;
+    }
+
+    record(id, ZMK_LATENCY_TRACE_STAGE_KSCAN, NULL);
+
+#if IS_ENABLED(CONFIG_ZMK_LATENCY_TRACE_LOG)
+    k_work_reschedule(&log_work, K_MSEC(CONFIG_ZMK_LATENCY_TRACE_LOG_DELAY_MS));
+#endif // IS_ENABLED(CONFIG_ZMK_LATENCY_TRACE_LOG)
+
+    return id;
+}
+
+void zmk_latency_trace_set_current(uint32_t id) { atomic_set(&current_id, id); }
+
+void zmk_latency_trace_record(enum zmk_latency_trace_stage stage, const char *label) {
+    uint32_t id = (uint32_t)atomic_get(&current_id);
+    if (id == 0) {
+        return;
+    }
+
+    record(id, stage, label);
+}
+
+size_t zmk_latency_trace_read(struct zmk_latency_trace_record *records, size_t len) {
+    uint32_t end = (uint32_t)atomic_get(&write_index);
+    size_t count = 0;
+
+    if (end - read_index > BUFFER_SIZE) {
+        LOG_WRN("Latency trace buffer overrun, dropped %u records",
+                end - read_index - BUFFER_SIZE);
+        read_index = end - BUFFER_SIZE;
+    }
+
+    while (read_index != end && count < len) {
+        struct trace_slot *slot = &slots[read_index & (BUFFER_SIZE - 1)];
+
+        records[count] = slot->record;
+
+        // Only keep the copy if the slot wasn't being written or overwritten while we read it.
+        if ((uint32_t)atomic_get(&slot->seq) == read_index + 1) {
+            count++;
+        }
+
+        read_index++;
+    }
+
+    return count;
+}
+
+#if IS_ENABLED(CONFIG_ZMK_LATENCY_TRACE_LOG)
+
+static const char *stage_str(uint8_t stage) {
+    switch (stage) {
+    case ZMK_LATENCY_TRACE_STAGE_KSCAN:
+        return "kscan";
+    case ZMK_LATENCY_TRACE_STAGE_KSCAN_PROCESS:
+        return "kscan_process";
+    case ZMK_LATENCY_TRACE_STAGE_LISTENER:
+        return "listener";
+    case ZMK_LATENCY_TRACE_STAGE_BEHAVIOR:
+        return "behavior";
+    case ZMK_LATENCY_TRACE_STAGE_ENDPOINT:
+        return "endpoint";
+    case ZMK_LATENCY_TRACE_STAGE_TRANSPORT:
+        return "transport";
+    default:
+        return "unknown";
+    }
+}
+
+// Traces may overlap when keys are scanned faster than they're processed, so remember where the
+// most recent ones started, since their records may span several batches.
+#define LOG_TRACES 8
+
+struct log_trace_begin {
+    uint32_t id;
+    uint32_t cycles;
+};
+
+static struct log_trace_begin log_begins[LOG_TRACES];
+static uint32_t log_begin_count;
+
+static const struct log_trace_begin *find_begin(uint32_t id) {
+    for (int i = 0; i < MIN(log_begin_count, LOG_TRACES); i++) {
+        if (log_begins[i].id == id) {
+            return &log_begins[i];
+        }
+    }
+
+    return NULL;
+}
+
+static void latency_trace_log_work_cb(struct k_work *work) {
+    struct zmk_latency_trace_record batch[16];
+    size_t count;
+    uint32_t skipped = 0;
+
+    while ((count = zmk_latency_trace_read(batch, ARRAY_SIZE(batch))) > 0) {
+        for (int i = 0; i < count; i++) {
+            struct zmk_latency_trace_record *rec = &batch[i];
+
+            if (rec->stage == ZMK_LATENCY_TRACE_STAGE_KSCAN) {
+                log_begins[log_begin_count++ % LOG_TRACES] = (struct log_trace_begin){
+                    .id = rec->id,
+                    .cycles = rec->cycles,
+                };
+            }
+
+            const struct log_trace_begin *begin = find_begin(rec->id);
+            if (!begin) {
+                skipped++;
+                continue;
+            }
+
+            uint32_t ns = k_cyc_to_ns_floor32(rec->cycles - begin->cycles);
+            LOG_INF("trace %u %s %s +%u ns", rec->id, stage_str(rec->stage),
+                    rec->label ? rec->label : "-", ns);
+        }
+    }
+
+    if (skipped > 0) {
+        LOG_WRN("Skipped %u latency trace records from traces that began more than %d traces ago",
+                skipped, LOG_TRACES);
+    }
+}
+
+#endif // IS_ENABLED(CONFIG_ZMK_LATENCY_TRACE_LOG)
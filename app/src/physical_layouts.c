@@ -20,7 +20,9 @@ LOG_MODULE_DECLARE(zmk, CONFIG_ZMK_LOG_LEVEL);
 
 #include <zmk/matrix.h>
 #include <zmk/physical_layouts.h>
+#include <zmk/endpoints.h>
 #include <zmk/event_manager.h>
+#include <zmk/latency_trace.h>
 #include <zmk/events/position_state_changed.h>
 
 ZMK_EVENT_IMPL(zmk_physical_layout_selection_changed);
@@ -169,6 +171,9 @@ struct zmk_kscan_event {
     uint32_t row;
     uint32_t column;
     uint32_t state;
+#if IS_ENABLED(CONFIG_ZMK_LATENCY_TRACE)
+    uint32_t trace_id;
+#endif // IS_ENABLED(CONFIG_ZMK_LATENCY_TRACE)
 };
 
 static struct zmk_kscan_msg_processor {
@@ -187,7 +192,11 @@ static void zmk_physical_layout_kscan_callback(const struct device *dev, uint32_
     struct zmk_kscan_event ev = {
         .row = row,
         .column = column,
-        .state = (pressed ? ZMK_KSCAN_EVENT_STATE_PRESSED : ZMK_KSCAN_EVENT_STATE_RELEASED)};
+        .state = (pressed ? ZMK_KSCAN_EVENT_STATE_PRESSED : ZMK_KSCAN_EVENT_STATE_RELEASED),
+#if IS_ENABLED(CONFIG_ZMK_LATENCY_TRACE)
+        .trace_id = zmk_latency_trace_begin(),
+#endif // IS_ENABLED(CONFIG_ZMK_LATENCY_TRACE)
+    };
 
     k_msgq_put(&physical_layouts_kscan_msgq, &ev, K_NO_WAIT);
     k_work_submit(&msg_processor.work);
@@ -196,7 +205,15 @@ static void zmk_physical_layout_kscan_callback(const struct device *dev, uint32_
 static void zmk_physical_layouts_kscan_process_msgq(struct k_work *item) {
     struct zmk_kscan_event ev;
 
+    // Key changes that were scanned together are processed as one report transaction.
+    zmk_endpoints_report_transaction_begin();
+
     while (k_msgq_get(&physical_layouts_kscan_msgq, &ev, K_NO_WAIT) == 0) {
+#if IS_ENABLED(CONFIG_ZMK_LATENCY_TRACE)
+        zmk_latency_trace_set_current(ev.trace_id);
+        zmk_latency_trace_record(ZMK_LATENCY_TRACE_STAGE_KSCAN_PROCESS, NULL);
+#endif // IS_ENABLED(CONFIG_ZMK_LATENCY_TRACE)
+
         bool pressed = (ev.state == ZMK_KSCAN_EVENT_STATE_PRESSED);
         int32_t position = zmk_matrix_transform_row_column_to_position(active->matrix_transform,
                                                                        ev.row, ev.column);
@@ -215,6 +232,13 @@ static void zmk_physical_layouts_kscan_process_msgq(struct k_work *item) {
                                                 .position = position,
                                                 .timestamp = k_uptime_get()});
     }
+
+    zmk_endpoints_report_transaction_end();
+
+#if IS_ENABLED(CONFIG_ZMK_LATENCY_TRACE)
+    // Anything recorded after this didn't come from a key scan.
+    zmk_latency_trace_set_current(0);
+#endif // IS_ENABLED(CONFIG_ZMK_LATENCY_TRACE)
 }
 
 static const struct zmk_physical_layout *get_default_layout(void) {
@@ -62,7 +62,7 @@ struct input_listener_layer_override {
 };
 
 struct input_processor_remainder_data {
-    int16_t x, y, wheel, h_wheel;
+    int16_t axes[ZMK_INPUT_FRAME_AXES];
 };
 
 struct input_listener_processor_data {
@@ -93,6 +93,10 @@ struct input_listener_data {
     int16_t h_wheel_remainder;
 #endif // IS_ENABLED(CONFIG_ZMK_POINTING_SMOOTH_SCROLLING)
 
+    // Relative movement collected since the last sync event.
+    struct zmk_input_processor_frame frame;
+    const struct device *frame_dev;
+
     struct input_listener_processor_data base_processor_data;
     struct input_listener_processor_data layer_override_data[];
 };
@@ -154,10 +158,16 @@ static inline bool is_y_data(const struct input_event *evt) {
 }
 
 static int apply_config(uint8_t listener_index, const struct input_listener_config_entry *cfg,
-                        struct input_listener_processor_data *processor_data,
+                        size_t first, struct input_listener_processor_data *processor_data,
                         struct input_listener_data *data, struct input_event *evt) {
     size_t remainder_index = 0;
-    for (size_t p = 0; p < cfg->processors_len; p++) {
+    for (size_t p = 0; p < first; p++) {
+        if (cfg->processors[p].track_remainders) {
+            remainder_index++;
+        }
+    }
+
+    for (size_t p = first; p < cfg->processors_len; p++) {
         const struct zmk_input_processor_entry *proc_e = &cfg->processors[p];
         struct input_processor_remainder_data *remainders = NULL;
         if (proc_e->track_remainders) {
@@ -165,23 +175,9 @@ static int apply_config(uint8_t listener_index, const struct input_listener_conf
         }
 
         int16_t *remainder = NULL;
-        if (remainders) {
-            if (evt->type == INPUT_EV_REL) {
-                switch (evt->code) {
-                case INPUT_REL_X:
-                    remainder = &remainders->x;
-                    break;
-                case INPUT_REL_Y:
-                    remainder = &remainders->y;
-                    break;
-                case INPUT_REL_WHEEL:
-                    remainder = &remainders->wheel;
-                    break;
-                case INPUT_REL_HWHEEL:
-                    remainder = &remainders->h_wheel;
-                    break;
-                }
-            }
+        const int axis = zmk_input_frame_axis(evt->type, evt->code);
+        if (remainders && axis >= 0) {
+            remainder = &remainders->axes[axis];
         }
 
         LOG_DBG("LISTENER INDEX: %d", listener_index);
@@ -214,8 +210,134 @@ static int filter_with_input_config(const struct input_listener_config *cfg,
         uint8_t layer = 0;
         while (mask != 0) {
             if (mask & BIT(0) && zmk_keymap_layer_active(layer)) {
-                int ret =
-                    apply_config(cfg->listener_index, &override->config, override_data, data, evt);
+                int ret = apply_config(cfg->listener_index, &override->config, 0, override_data,
+                                       data, evt);
+
+                if (ret < 0) {
+                    return ret;
+                }
+                if (!override->process_next) {
+                    return 0;
+                }
+            }
+
+            layer++;
+            mask = mask >> 1;
+        }
+    }
+
+    return apply_config(cfg->listener_index, &cfg->base, 0, &data->base_processor_data, data, evt);
+}
+
+static void handle_processed_event(const struct input_listener_config *config,
+                                   struct input_listener_data *data, struct input_event *evt);
+
+// Runs a processor that doesn't handle frames on one event per axis, then collects the events back
+// into the frame. The frame is stopped if the processor stops every event.
+static int split_frame_for_processor(const struct input_listener_config *config,
+                                     const struct input_listener_config_entry *cfg, size_t p,
+                                     struct input_listener_processor_data *processor_data,
+                                     struct input_processor_remainder_data *remainders,
+                                     struct input_listener_data *data,
+                                     struct zmk_input_processor_frame *frame) {
+    const struct zmk_input_processor_entry *proc_e = &cfg->processors[p];
+    struct zmk_input_processor_frame processed = {0};
+    bool stopped = true;
+
+    for (int axis = 0; axis < ZMK_INPUT_FRAME_AXES; axis++) {
+        if ((frame->axes & BIT(axis)) == 0) {
+            continue;
+        }
+
+        struct input_event evt = {
+            .dev = data->frame_dev,
+            .type = INPUT_EV_REL,
+            .code = zmk_input_frame_axis_code(axis),
+            .value = frame->values[axis],
+        };
+        struct zmk_input_processor_state state = {
+            .input_device_index = config->listener_index,
+            .remainder = remainders ? &remainders->axes[axis] : NULL,
+        };
+
+        int ret = zmk_input_processor_handle_event(proc_e->dev, &evt, proc_e->param1,
+                                                   proc_e->param2, &state);
+        if (ret < 0) {
+            return ret;
+        } else if (ret == ZMK_INPUT_PROC_STOP) {
+            continue;
+        }
+
+        stopped = false;
+
+        const int processed_axis = zmk_input_frame_axis(evt.type, evt.code);
+        if (processed_axis >= 0) {
+            processed.values[processed_axis] += evt.value;
+            processed.axes |= BIT(processed_axis);
+            continue;
+        }
+
+        // The processor turned the event into one that isn't part of a frame, so the rest of this
+        // config processes it on its own before it's handled.
+        ret = apply_config(config->listener_index, cfg, p + 1, processor_data, data, &evt);
+        if (ret < 0) {
+            return ret;
+        } else if (ret == ZMK_INPUT_PROC_CONTINUE) {
+            handle_processed_event(config, data, &evt);
+        }
+    }
+
+    *frame = processed;
+    return stopped ? ZMK_INPUT_PROC_STOP : ZMK_INPUT_PROC_CONTINUE;
+}
+
+static int apply_config_to_frame(const struct input_listener_config *config,
+                                 const struct input_listener_config_entry *cfg,
+                                 struct input_listener_processor_data *processor_data,
+                                 struct input_listener_data *data,
+                                 struct zmk_input_processor_frame *frame) {
+    size_t remainder_index = 0;
+    for (size_t p = 0; p < cfg->processors_len && frame->axes != 0; p++) {
+        const struct zmk_input_processor_entry *proc_e = &cfg->processors[p];
+        struct input_processor_remainder_data *remainders = NULL;
+        if (proc_e->track_remainders) {
+            remainders = &processor_data->remainders[remainder_index++];
+        }
+
+        struct zmk_input_processor_frame_state state = {
+            .input_device_index = config->listener_index,
+            .remainders = remainders ? remainders->axes : NULL,
+        };
+
+        int ret = zmk_input_processor_handle_frame(proc_e->dev, frame, proc_e->param1,
+                                                   proc_e->param2, &state);
+        if (ret == -ENOTSUP) {
+            ret = split_frame_for_processor(config, cfg, p, processor_data, remainders, data,
+                                            frame);
+        }
+
+        switch (ret) {
+        case ZMK_INPUT_PROC_CONTINUE:
+            continue;
+        default:
+            return ret;
+        }
+    }
+
+    return ZMK_INPUT_PROC_CONTINUE;
+}
+
+static int filter_frame_with_input_config(const struct input_listener_config *cfg,
+                                          struct input_listener_data *data,
+                                          struct zmk_input_processor_frame *frame) {
+    for (size_t oi = 0; oi < cfg->layer_overrides_len; oi++) {
+        const struct input_listener_layer_override *override = &cfg->layer_overrides[oi];
+        struct input_listener_processor_data *override_data = &data->layer_override_data[oi];
+        uint32_t mask = override->layer_mask;
+        uint8_t layer = 0;
+        while (mask != 0) {
+            if (mask & BIT(0) && zmk_keymap_layer_active(layer)) {
+                int ret = apply_config_to_frame(cfg, &override->config, override_data, data, frame);
 
                 if (ret < 0) {
                     return ret;
@@ -230,7 +352,7 @@ static int filter_with_input_config(const struct input_listener_config *cfg,
         }
     }
 
-    return apply_config(cfg->listener_index, &cfg->base, &data->base_processor_data, data, evt);
+    return apply_config_to_frame(cfg, &cfg->base, &data->base_processor_data, data, frame);
 }
 
 static void clear_xy_data(struct input_listener_xy_data *data) {
@@ -263,18 +385,8 @@ static void apply_resolution_scaling(struct input_listener_data *data, struct in
 }
 #endif // IS_ENABLED(CONFIG_ZMK_POINTING_SMOOTH_SCROLLING)
 
-static void input_handler(const struct input_listener_config *config,
-                          struct input_listener_data *data, struct input_event *evt) {
-    // First, process to update the event data as needed.
-    int ret = filter_with_input_config(config, data, evt);
-
-    if (ret < 0) {
-        LOG_ERR("Error applying input processors: %d", ret);
-        return;
-    } else if (ret == ZMK_INPUT_PROC_STOP) {
-        return;
-    }
-
+static void handle_processed_event(const struct input_listener_config *config,
+                                   struct input_listener_data *data, struct input_event *evt) {
 #if IS_ENABLED(CONFIG_ZMK_POINTING_SMOOTH_SCROLLING)
     apply_resolution_scaling(data, evt);
 #endif // IS_ENABLED(CONFIG_ZMK_POINTING_SMOOTH_SCROLLING)
@@ -290,8 +402,72 @@ static void input_handler(const struct input_listener_config *config,
         handle_key_code(config, data, evt);
         break;
     }
+}
+
+// Returns false if the processors stopped the frame.
+static bool handle_frame(const struct input_listener_config *config,
+                         struct input_listener_data *data) {
+    struct zmk_input_processor_frame frame = data->frame;
+
+    data->frame = (struct zmk_input_processor_frame){0};
+
+    int ret = filter_frame_with_input_config(config, data, &frame);
+
+    if (ret < 0) {
+        LOG_ERR("Error applying input processors: %d", ret);
+        return false;
+    } else if (ret == ZMK_INPUT_PROC_STOP) {
+        return false;
+    }
+
+    for (int axis = 0; axis < ZMK_INPUT_FRAME_AXES; axis++) {
+        if ((frame.axes & BIT(axis)) != 0) {
+            struct input_event evt = {
+                .dev = data->frame_dev,
+                .type = INPUT_EV_REL,
+                .code = zmk_input_frame_axis_code(axis),
+                .value = frame.values[axis],
+            };
+
+            handle_processed_event(config, data, &evt);
+        }
+    }
+
+    return true;
+}
+
+static void input_handler(const struct input_listener_config *config,
+                          struct input_listener_data *data, struct input_event *evt) {
+    const int axis = zmk_input_frame_axis(evt->type, evt->code);
+
+    if (axis >= 0 && evt->dev) {
+        // Relative movement is collected until the device syncs, then processed as one frame. The
+        // sum is kept within the 16 bit range processors such as the scaler work in, so a burst of
+        // events can't wrap around to a movement in the other direction.
+        data->frame.values[axis] = CLAMP((int64_t)data->frame.values[axis] + evt->value,
+                                         INT16_MIN, INT16_MAX);
+        data->frame.axes |= BIT(axis);
+        data->frame_dev = evt->dev;
+    } else {
+        // First, process to update the event data as needed.
+        int ret = filter_with_input_config(config, data, evt);
+
+        if (ret < 0) {
+            LOG_ERR("Error applying input processors: %d", ret);
+            return;
+        } else if (ret == ZMK_INPUT_PROC_STOP) {
+            return;
+        }
+
+        handle_processed_event(config, data, evt);
+    }
 
     if (evt->sync) {
+        // Like a stopped event, syncing on movement the processors stopped doesn't send a report.
+        if (data->frame.axes != 0 && !handle_frame(config, data) && axis >= 0) {
+            return;
+        }
+
         if (data->mouse.wheel_data.mode == INPUT_LISTENER_XY_DATA_MODE_REL) {
             zmk_hid_mouse_scroll_set(data->mouse.wheel_data.x.value,
                                      data->mouse.wheel_data.y.value);
@@ -20,6 +20,11 @@ struct cm_config {
     uint16_t mapping[];
 };
 
+struct cm_data {
+    // Frame axis each frame axis maps to, or -1 if it maps to a code that isn't a frame axis.
+    int8_t frame_map[ZMK_INPUT_FRAME_AXES];
+};
+
 static int cm_handle_event(const struct device *dev, struct input_event *event, uint32_t param1,
                            uint32_t param2, struct zmk_input_processor_state *state) {
     const struct cm_config *cfg = dev->config;
@@ -40,10 +45,56 @@ static int cm_handle_event(const struct device *dev, struct input_event *event,
     return ZMK_INPUT_PROC_CONTINUE;
 }
 
+static int cm_handle_frame(const struct device *dev, struct zmk_input_processor_frame *frame,
+                           uint32_t param1, uint32_t param2,
+                           struct zmk_input_processor_frame_state *state) {
+    const struct cm_config *cfg = dev->config;
+    const struct cm_data *data = dev->data;
+
+    if (cfg->type != INPUT_EV_REL) {
+        return ZMK_INPUT_PROC_CONTINUE;
+    }
+
+    for (int axis = 0; axis < ZMK_INPUT_FRAME_AXES; axis++) {
+        if ((frame->axes & BIT(axis)) != 0 && data->frame_map[axis] < 0) {
+            return -ENOTSUP;
+        }
+    }
+
+    struct zmk_input_processor_frame mapped = {0};
+
+    for (int axis = 0; axis < ZMK_INPUT_FRAME_AXES; axis++) {
+        if ((frame->axes & BIT(axis)) != 0) {
+            mapped.values[data->frame_map[axis]] += frame->values[axis];
+            mapped.axes |= BIT(data->frame_map[axis]);
+        }
+    }
+
+    *frame = mapped;
+
+    return ZMK_INPUT_PROC_CONTINUE;
+}
+
 static struct zmk_input_processor_driver_api cm_driver_api = {
     .handle_event = cm_handle_event,
+    .handle_frame = cm_handle_frame,
 };
 
+static int cm_init(const struct device *dev) {
+    const struct cm_config *cfg = dev->config;
+    struct cm_data *data = dev->data;
+
+    // Map a copy of each frame axis once, so frames don't need to search the mapping.
+    for (int axis = 0; axis < ZMK_INPUT_FRAME_AXES; axis++) {
+        struct input_event event = {.type = cfg->type, .code = zmk_input_frame_axis_code(axis)};
+
+        cm_handle_event(dev, &event, 0, 0, NULL);
+        data->frame_map[axis] = zmk_input_frame_axis(INPUT_EV_REL, event.code);
+    }
+
+    return 0;
+}
+
 #define TL_INST(n)                                                                                 \
     static const struct cm_config cm_config_##n = {                                                \
         .type = DT_INST_PROP_OR(n, type, INPUT_EV_REL),                                            \
@@ -52,7 +103,8 @@ static struct zmk_input_processor_driver_api cm_driver_api = {
     };                                                                                             \
     BUILD_ASSERT(DT_INST_PROP_LEN(n, map) % 2 == 0,                                                \
                  "Must have an even number of mapping entries");                                   \
-    DEVICE_DT_INST_DEFINE(n, NULL, NULL, NULL, &cm_config_##n, POST_KERNEL,                        \
+    static struct cm_data cm_data_##n;                                                             \
+    DEVICE_DT_INST_DEFINE(n, &cm_init, NULL, &cm_data_##n, &cm_config_##n, POST_KERNEL,            \
                           CONFIG_KERNEL_INIT_PRIORITY_DEFAULT, &cm_driver_api);
 
 DT_INST_FOREACH_STATUS_OKAY(TL_INST)
\ No newline at end of file
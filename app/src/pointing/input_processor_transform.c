@@ -22,11 +22,19 @@ struct ipt_config {
     size_t x_codes_size;
     size_t y_codes_size;
     uint8_t type;
+    // Masks of the frame axes in x_codes and y_codes, worked out at build time.
+    uint8_t x_frame_axes;
+    uint8_t y_frame_axes;
 
     const uint16_t *x_codes;
     const uint16_t *y_codes;
 };
 
+struct ipt_data {
+    // Frame axis each frame axis swaps with, or -1 if it swaps with a code that isn't a frame axis.
+    int8_t frame_swap[ZMK_INPUT_FRAME_AXES];
+};
+
 static int code_idx(uint16_t code, const uint16_t *list, size_t len) {
     for (int i = 0; i < len; i++) {
         if (list[i] == code) {
@@ -68,11 +76,74 @@ static int ipt_handle_event(const struct device *dev, struct input_event *event,
     return ZMK_INPUT_PROC_CONTINUE;
 }
 
+static int ipt_handle_frame(const struct device *dev, struct zmk_input_processor_frame *frame,
+                            uint32_t param1, uint32_t param2,
+                            struct zmk_input_processor_frame_state *state) {
+    const struct ipt_config *cfg = dev->config;
+    const struct ipt_data *data = dev->data;
+
+    if (cfg->type != INPUT_EV_REL) {
+        return ZMK_INPUT_PROC_CONTINUE;
+    }
+
+    if (param1 & INPUT_TRANSFORM_XY_SWAP) {
+        for (int axis = 0; axis < ZMK_INPUT_FRAME_AXES; axis++) {
+            if ((frame->axes & BIT(axis)) != 0 && data->frame_swap[axis] < 0) {
+                return -ENOTSUP;
+            }
+        }
+
+        struct zmk_input_processor_frame swapped = {0};
+
+        for (int axis = 0; axis < ZMK_INPUT_FRAME_AXES; axis++) {
+            if ((frame->axes & BIT(axis)) != 0) {
+                swapped.values[data->frame_swap[axis]] += frame->values[axis];
+                swapped.axes |= BIT(data->frame_swap[axis]);
+            }
+        }
+
+        *frame = swapped;
+    }
+
+    uint8_t invert = 0;
+    if (param1 & INPUT_TRANSFORM_X_INVERT) {
+        invert |= cfg->x_frame_axes;
+    }
+    if (param1 & INPUT_TRANSFORM_Y_INVERT) {
+        invert |= cfg->y_frame_axes;
+    }
+
+    for (int axis = 0; axis < ZMK_INPUT_FRAME_AXES; axis++) {
+        if ((frame->axes & invert & BIT(axis)) != 0) {
+            frame->values[axis] = -frame->values[axis];
+        }
+    }
+
+    return ZMK_INPUT_PROC_CONTINUE;
+}
+
 static struct zmk_input_processor_driver_api ipt_driver_api = {
     .handle_event = ipt_handle_event,
+    .handle_frame = ipt_handle_frame,
 };
 
-static int ipt_init(const struct device *dev) { return 0; }
+static int ipt_init(const struct device *dev) {
+    const struct ipt_config *cfg = dev->config;
+    struct ipt_data *data = dev->data;
+
+    // Swap a copy of each frame axis once, so frames don't need to search the codes.
+    for (int axis = 0; axis < ZMK_INPUT_FRAME_AXES; axis++) {
+        struct input_event event = {.type = cfg->type, .code = zmk_input_frame_axis_code(axis)};
+
+        ipt_handle_event(dev, &event, INPUT_TRANSFORM_XY_SWAP, 0, NULL);
+        data->frame_swap[axis] = zmk_input_frame_axis(INPUT_EV_REL, event.code);
+    }
+
+    return 0;
+}
+
+#define IPT_FRAME_AXIS_BIT(node, prop, idx)                                                        \
+    | ZMK_INPUT_FRAME_AXIS_BIT_FOR_REL(DT_PROP_BY_IDX(node, prop, idx))
 
 #define IPT_INST(n)                                                                                \
     static const uint16_t ipt_x_codes_##n[] = DT_INST_PROP(n, x_codes);                            \
@@ -83,10 +154,13 @@ static int ipt_init(const struct device *dev) { return 0; }
         .type = DT_INST_PROP_OR(n, type, INPUT_EV_REL),                                            \
         .x_codes_size = DT_INST_PROP_LEN(n, x_codes),                                              \
         .y_codes_size = DT_INST_PROP_LEN(n, y_codes),                                              \
+        .x_frame_axes = 0 DT_INST_FOREACH_PROP_ELEM(n, x_codes, IPT_FRAME_AXIS_BIT),               \
+        .y_frame_axes = 0 DT_INST_FOREACH_PROP_ELEM(n, y_codes, IPT_FRAME_AXIS_BIT),               \
         .x_codes = ipt_x_codes_##n,                                                                \
         .y_codes = ipt_y_codes_##n,                                                                \
     };                                                                                             \
-    DEVICE_DT_INST_DEFINE(n, &ipt_init, NULL, NULL, &ipt_config_##n, POST_KERNEL,                  \
+    static struct ipt_data ipt_data_##n;                                                           \
+    DEVICE_DT_INST_DEFINE(n, &ipt_init, NULL, &ipt_data_##n, &ipt_config_##n, POST_KERNEL,         \
                           CONFIG_KERNEL_INIT_PRIORITY_DEFAULT, &ipt_driver_api);
 
 DT_INST_FOREACH_STATUS_OKAY(IPT_INST)
\ No newline at end of file
@@ -22,9 +22,11 @@ LOG_MODULE_DECLARE(zmk, CONFIG_ZMK_LOG_LEVEL);
 #include <zmk/stdlib.h>
 #include <zmk/ble.h>
 #include <zmk/behavior.h>
+#include <zmk/endpoints.h>
 #include <zmk/sensors.h>
 #include <zmk/split/bluetooth/uuid.h>
 #include <zmk/split/bluetooth/service.h>
+#include <zmk/split/transport/central.h>
 #include <zmk/event_manager.h>
 #include <zmk/events/position_state_changed.h>
 #include <zmk/events/sensor_event.h>
@@ -35,7 +37,39 @@ LOG_MODULE_DECLARE(zmk, CONFIG_ZMK_LOG_LEVEL);
 
 static int start_scanning(void);
 
-#define POSITION_STATE_DATA_LEN 16
+#define POSITION_STATE_DATA_LEN ZMK_SPLIT_POSITION_STATE_LEN
+
+// The clock offset of each peripheral is the smallest difference seen between the time a
+// timestamped notification arrives and the peripheral timestamp it carries, over the current and
+// previous windows of this length. The window bounds how long clock drift can go uncorrected.
+#define PERIPHERAL_CLOCK_WINDOW_MS 10000
+
+#define GATT_DB_HASH_LEN 16
+
+struct peripheral_clock {
+    bool valid;
+    int64_t window_start;
+    // Central uptime minus peripheral uptime, modulo 2^32, for the smallest sample in each window.
+    uint32_t window_min;
+    uint32_t prev_window_min;
+};
+
+#if IS_ENABLED(CONFIG_ZMK_SPLIT_BLE_BEHAVIOR_IDS)
+
+struct peripheral_behavior_id {
+    const struct device *behavior;
+    zmk_behavior_local_id_t id;
+};
+
+// Collects the behavior ID table entries from the parts of a long read.
+struct behavior_id_parser {
+    uint8_t entry[sizeof(struct zmk_split_behavior_id_entry) + Z_DEVICE_MAX_NAME_LEN];
+    uint8_t entry_len;
+    bool overflow;
+    uint8_t count;
+};
+
+#endif // IS_ENABLED(CONFIG_ZMK_SPLIT_BLE_BEHAVIOR_IDS)
 
 enum peripheral_slot_state {
     PERIPHERAL_SLOT_STATE_OPEN,
@@ -61,6 +95,24 @@ struct peripheral_slot {
     uint16_t selected_physical_layout_handle;
     uint8_t position_state[POSITION_STATE_DATA_LEN];
     uint8_t changed_positions[POSITION_STATE_DATA_LEN];
+    struct peripheral_clock clock;
+#if IS_ENABLED(CONFIG_ZMK_SPLIT_BLE_BEHAVIOR_IDS)
+    uint16_t behavior_ids_handle;
+    struct bt_gatt_read_params behavior_ids_read_params;
+    struct behavior_id_parser behavior_id_parser;
+    // Behaviors that can be invoked on the peripheral by ID, set once the table has been read.
+    struct peripheral_behavior_id behavior_ids[CONFIG_ZMK_SPLIT_BLE_CENTRAL_BEHAVIOR_IDS_MAX];
+    uint8_t behavior_ids_len;
+#endif // IS_ENABLED(CONFIG_ZMK_SPLIT_BLE_BEHAVIOR_IDS)
+    // Uptime the connection was made, until the first key press from it is received.
+    int64_t connected_at;
+#if IS_ENABLED(CONFIG_ZMK_SPLIT_BLE_CENTRAL_CACHE_HANDLES)
+    struct bt_gatt_read_params db_hash_read_params;
+    uint8_t db_hash[GATT_DB_HASH_LEN];
+    bool db_hash_valid;
+    uint8_t handle_cache_save_attempts;
+    struct k_work_delayable handle_cache_save_work;
+#endif // IS_ENABLED(CONFIG_ZMK_SPLIT_BLE_CENTRAL_CACHE_HANDLES)
 };
 
 #if IS_ENABLED(CONFIG_ZMK_INPUT_SPLIT)
@@ -72,6 +124,8 @@ struct peripheral_input_slot {
     struct bt_conn *conn;
     struct bt_gatt_subscribe_params sub;
     uint8_t reg;
+    /** Number of events dropped because the input event queue was full. */
+    uint32_t dropped_events;
 };
 
 #define COUNT_INPUT_SPLIT(n) +1
@@ -130,6 +184,41 @@ void release_peripheral_input_subs(struct bt_conn *conn) {
 
 static struct peripheral_slot peripherals[ZMK_SPLIT_BLE_PERIPHERAL_COUNT];
 
+#if IS_ENABLED(CONFIG_ZMK_SPLIT_BLE_CENTRAL_CACHE_HANDLES)
+
+// Handles found by the last full discovery of a bonded peripheral. They stay valid until the
+// peripheral's GATT database changes, which shows up as a different database hash.
+struct peripheral_handle_cache {
+    bt_addr_le_t addr;
+    uint8_t db_hash[GATT_DB_HASH_LEN];
+    uint16_t position_value_handle;
+    uint16_t position_ccc_handle;
+    uint16_t sensor_value_handle;
+    uint16_t sensor_ccc_handle;
+    uint16_t run_behavior_handle;
+    uint16_t behavior_ids_handle;
+    uint16_t selected_physical_layout_handle;
+    uint16_t update_hid_indicators_handle;
+    uint16_t batt_lvl_value_handle;
+    uint16_t batt_lvl_ccc_handle;
+#if IS_ENABLED(CONFIG_ZMK_INPUT_SPLIT)
+    struct {
+        uint16_t value_handle;
+        uint16_t ccc_handle;
+        uint8_t reg;
+    } inputs[ARRAY_SIZE(peripheral_input_slots)];
+#endif // IS_ENABLED(CONFIG_ZMK_INPUT_SPLIT)
+};
+
+static struct peripheral_handle_cache handle_caches[ZMK_SPLIT_BLE_PERIPHERAL_COUNT];
+
+// CCC handles are found by the subscriptions made during discovery, which finish after discovery
+// itself, so the cache is saved once they are all known.
+#define HANDLE_CACHE_SAVE_DELAY_MS 500
+#define HANDLE_CACHE_SAVE_MAX_ATTEMPTS 10
+
+#endif // IS_ENABLED(CONFIG_ZMK_SPLIT_BLE_CENTRAL_CACHE_HANDLES)
+
 static bool is_scanning = false;
 
 static const struct bt_uuid_128 split_service_uuid = BT_UUID_INIT_128(ZMK_SPLIT_BT_SERVICE_UUID);
@@ -139,10 +228,15 @@ K_MSGQ_DEFINE(peripheral_event_msgq, sizeof(struct zmk_position_state_changed),
 
 void peripheral_event_work_callback(struct k_work *work) {
     struct zmk_position_state_changed ev;
+
+    zmk_endpoints_report_transaction_begin();
+
     while (k_msgq_get(&peripheral_event_msgq, &ev, K_NO_WAIT) == 0) {
         LOG_DBG("Trigger key position state change for %d", ev.position);
         raise_zmk_position_state_changed(ev);
     }
+
+    zmk_endpoints_report_transaction_end();
 }
 
 K_WORK_DEFINE(peripheral_event_work, peripheral_event_work_callback);
@@ -206,9 +300,22 @@ int release_peripheral_slot(int index) {
         slot->changed_positions[i] = 0U;
     }
 
+    // The peripheral may have restarted by the time it reconnects.
+    slot->clock.valid = false;
+    slot->connected_at = 0;
+
+#if IS_ENABLED(CONFIG_ZMK_SPLIT_BLE_CENTRAL_CACHE_HANDLES)
+    slot->db_hash_valid = false;
+    k_work_cancel_delayable(&slot->handle_cache_save_work);
+#endif // IS_ENABLED(CONFIG_ZMK_SPLIT_BLE_CENTRAL_CACHE_HANDLES)
+
     // Clean up previously discovered handles;
     slot->subscribe_params.value_handle = 0;
     slot->run_behavior_handle = 0;
+#if IS_ENABLED(CONFIG_ZMK_SPLIT_BLE_BEHAVIOR_IDS)
+    slot->behavior_ids_handle = 0;
+    slot->behavior_ids_len = 0;
+#endif // IS_ENABLED(CONFIG_ZMK_SPLIT_BLE_BEHAVIOR_IDS)
     slot->selected_physical_layout_handle = 0;
 #if IS_ENABLED(CONFIG_ZMK_SPLIT_PERIPHERAL_HID_INDICATORS)
     slot->update_hid_indicators = 0;
@@ -247,6 +354,7 @@ int confirm_peripheral_slot_conn(struct bt_conn *conn) {
     }
 
     peripherals[idx].state = PERIPHERAL_SLOT_STATE_CONNECTED;
+    peripherals[idx].connected_at = k_uptime_get();
     return 0;
 }
 
@@ -303,8 +411,8 @@ struct zmk_input_event_msg {
     struct zmk_split_input_event_payload payload;
 };
 
-K_MSGQ_DEFINE(peripheral_input_event_msgq, sizeof(struct zmk_input_event_msg), 5, 4);
-//   CONFIG_ZMK_SPLIT_BLE_CENTRAL_INPUT_QUEUE_SIZE, 4);
+K_MSGQ_DEFINE(peripheral_input_event_msgq, sizeof(struct zmk_input_event_msg),
+              CONFIG_ZMK_SPLIT_BLE_CENTRAL_INPUT_QUEUE_SIZE, 4);
 
 void peripheral_input_event_work_callback(struct k_work *work) {
     struct zmk_input_event_msg msg;
@@ -330,31 +438,92 @@ static uint8_t peripheral_input_event_notify_cb(struct bt_conn *conn,
 
     LOG_DBG("[INPUT EVENT] data %p length %u", data, length);
 
-    if (length != sizeof(struct zmk_split_input_event_payload)) {
+    // Peripherals may pack several whole frames of events into one notification.
+    if (length == 0 || length % sizeof(struct zmk_split_input_event_payload) != 0) {
         LOG_WRN("Ignoring input event notify with incorrect data length (%d)", length);
         return BT_GATT_ITER_STOP;
     }
 
-    struct zmk_input_event_msg msg;
+    struct peripheral_input_slot *slot = NULL;
+    for (size_t i = 0; i < ARRAY_SIZE(peripheral_input_slots); i++) {
+        if (&peripheral_input_slots[i].sub == params) {
+            slot = &peripheral_input_slots[i];
+            break;
+        }
+    }
 
-    memcpy(&msg.payload, data, MIN(length, sizeof(struct zmk_split_input_event_payload)));
+    if (!slot) {
+        return BT_GATT_ITER_CONTINUE;
+    }
 
-    LOG_DBG("Got an input event with type %d, code %d, value %d, sync %d", msg.payload.type,
-            msg.payload.code, msg.payload.value, msg.payload.sync);
+    struct zmk_input_event_msg msg = {.reg = slot->reg};
 
-    for (size_t i = 0; i < ARRAY_SIZE(peripheral_input_slots); i++) {
-        if (&peripheral_input_slots[i].sub == params) {
-            msg.reg = peripheral_input_slots[i].reg;
-            k_msgq_put(&peripheral_input_event_msgq, &msg, K_NO_WAIT);
-            k_work_submit(&input_event_work);
+    for (uint16_t offset = 0; offset < length;
+         offset += sizeof(struct zmk_split_input_event_payload)) {
+        memcpy(&msg.payload, (const uint8_t *)data + offset,
+               sizeof(struct zmk_split_input_event_payload));
+
+        LOG_DBG("Got an input event with type %d, code %d, value %d, sync %d", msg.payload.type,
+                msg.payload.code, msg.payload.value, msg.payload.sync);
+
+        // This runs in the Bluetooth RX thread, which must not block waiting for room.
+        int err = k_msgq_put(&peripheral_input_event_msgq, &msg, K_NO_WAIT);
+        if (err) {
+            slot->dropped_events++;
+            LOG_WRN("Dropped peripheral input event (%d), %u dropped in total. Consider raising "
+                    "CONFIG_ZMK_SPLIT_BLE_CENTRAL_INPUT_QUEUE_SIZE",
+                    err, slot->dropped_events);
         }
     }
 
+    k_work_submit(&input_event_work);
+
     return BT_GATT_ITER_CONTINUE;
 }
 
 #endif
 
+// Convert a peripheral timestamp to central uptime, updating the clock offset estimate with it.
+// The result is the central time the event would have arrived with the lowest link latency seen,
+// so jitter from the connection interval and peripheral queueing is removed.
+static int64_t peripheral_clock_correct(struct peripheral_clock *clock, uint32_t timestamp) {
+    int64_t now = k_uptime_get();
+    uint32_t sample = (uint32_t)now - timestamp;
+
+    if (!clock->valid || now - clock->window_start >= 2 * PERIPHERAL_CLOCK_WINDOW_MS) {
+        clock->valid = true;
+        clock->window_start = now;
+        clock->window_min = sample;
+        clock->prev_window_min = sample;
+    } else if (now - clock->window_start >= PERIPHERAL_CLOCK_WINDOW_MS) {
+        clock->window_start = now;
+        clock->prev_window_min = clock->window_min;
+        clock->window_min = sample;
+    } else if ((int32_t)(sample - clock->window_min) < 0) {
+        clock->window_min = sample;
+    }
+
+    uint32_t offset = (int32_t)(clock->window_min - clock->prev_window_min) < 0
+                          ? clock->window_min
+                          : clock->prev_window_min;
+
+    return now - MAX((int32_t)(sample - offset), 0);
+}
+
+// Log how long after connecting the first key press from a peripheral arrived, which includes the
+// time taken to find and subscribe to the split service.
+static void log_first_key_press(struct peripheral_slot *slot) {
+    if (slot->connected_at == 0) {
+        return;
+    }
+
+    LOG_DBG("Peripheral %d first key press %d ms after connecting", (int)(slot - peripherals),
+            (int)(k_uptime_get() - slot->connected_at));
+    slot->connected_at = 0;
+}
+
+#if !IS_ENABLED(CONFIG_ZMK_SPLIT_BLE_POSITION_BATCHING)
+
 static uint8_t split_central_notify_func(struct bt_conn *conn,
                                          struct bt_gatt_subscribe_params *params, const void *data,
                                          uint16_t length) {
@@ -373,6 +542,18 @@ static uint8_t split_central_notify_func(struct bt_conn *conn,
 
     LOG_DBG("[NOTIFICATION] data %p length %u", data, length);
 
+    if (length < POSITION_STATE_DATA_LEN) {
+        LOG_WRN("Ignoring position state notify with insufficient data length (%d)", length);
+        return BT_GATT_ITER_CONTINUE;
+    }
+
+    // Peripherals that don't send a timestamp get the time the notification arrived.
+    int64_t timestamp = k_uptime_get();
+    if (length >= sizeof(struct zmk_split_position_state_payload)) {
+        timestamp = peripheral_clock_correct(
+            &slot->clock, ((struct zmk_split_position_state_payload *)data)->timestamp);
+    }
+
     for (int i = 0; i < POSITION_STATE_DATA_LEN; i++) {
         slot->changed_positions[i] = ((uint8_t *)data)[i] ^ slot->position_state[i];
         slot->position_state[i] = ((uint8_t *)data)[i];
@@ -384,11 +565,14 @@ static uint8_t split_central_notify_func(struct bt_conn *conn,
             if (slot->changed_positions[i] & BIT(j)) {
                 uint32_t position = (i * 8) + j;
                 bool pressed = slot->position_state[i] & BIT(j);
+                if (pressed) {
+                    log_first_key_press(slot);
+                }
                 struct zmk_position_state_changed ev = {.source =
                                                             peripheral_slot_index_for_conn(conn),
                                                         .position = position,
                                                         .state = pressed,
-                                                        .timestamp = k_uptime_get()};
+                                                        .timestamp = timestamp};
 
                 k_msgq_put(&peripheral_event_msgq, &ev, K_NO_WAIT);
                 k_work_submit(&peripheral_event_work);
@@ -399,6 +583,78 @@ static uint8_t split_central_notify_func(struct bt_conn *conn,
     return BT_GATT_ITER_CONTINUE;
 }
 
+#else
+
+static uint8_t split_central_position_batch_notify_func(struct bt_conn *conn,
+                                                        struct bt_gatt_subscribe_params *params,
+                                                        const void *data, uint16_t length) {
+    struct peripheral_slot *slot = peripheral_slot_for_conn(conn);
+
+    if (slot == NULL) {
+        LOG_ERR("No peripheral state found for connection");
+        return BT_GATT_ITER_CONTINUE;
+    }
+
+    if (!data) {
+        LOG_DBG("[UNSUBSCRIBED]");
+        params->value_handle = 0U;
+        return BT_GATT_ITER_STOP;
+    }
+
+    LOG_DBG("[NOTIFICATION] data %p length %u", data, length);
+
+    const size_t edges_offset = offsetof(struct zmk_split_position_batch, edges);
+    if (length < edges_offset ||
+        (length - edges_offset) % sizeof(struct zmk_split_position_edge) != 0) {
+        LOG_WRN("Ignoring position batch with invalid data length (%d)", length);
+        return BT_GATT_ITER_CONTINUE;
+    }
+
+    const struct zmk_split_position_batch *batch = data;
+    size_t count = MIN((length - edges_offset) / sizeof(struct zmk_split_position_edge),
+                       ZMK_SPLIT_POSITION_BATCH_MAX_EDGES);
+
+    // The batch carries the timestamp of the last edge, and each earlier edge happened delta_ms
+    // before the one that follows it.
+    int64_t timestamps[ZMK_SPLIT_POSITION_BATCH_MAX_EDGES];
+    int64_t timestamp = peripheral_clock_correct(&slot->clock, batch->timestamp);
+    for (int i = count - 1; i >= 0; i--) {
+        timestamps[i] = timestamp;
+        timestamp -= batch->edges[i].delta_ms;
+    }
+
+    for (int i = 0; i < count; i++) {
+        uint8_t position = batch->edges[i].position_state & ~ZMK_SPLIT_POSITION_EDGE_PRESSED;
+        bool pressed = batch->edges[i].position_state & ZMK_SPLIT_POSITION_EDGE_PRESSED;
+
+        if (position >= POSITION_STATE_DATA_LEN * 8) {
+            LOG_WRN("Ignoring edge for out of range position %d", position);
+            continue;
+        }
+
+        if ((bool)(slot->position_state[position / 8] & BIT(position % 8)) == pressed) {
+            continue;
+        }
+
+        WRITE_BIT(slot->position_state[position / 8], position % 8, pressed);
+        if (pressed) {
+            log_first_key_press(slot);
+        }
+
+        struct zmk_position_state_changed ev = {.source = peripheral_slot_index_for_conn(conn),
+                                                .position = position,
+                                                .state = pressed,
+                                                .timestamp = timestamps[i]};
+
+        k_msgq_put(&peripheral_event_msgq, &ev, K_NO_WAIT);
+        k_work_submit(&peripheral_event_work);
+    }
+
+    return BT_GATT_ITER_CONTINUE;
+}
+
+#endif // IS_ENABLED(CONFIG_ZMK_SPLIT_BLE_POSITION_BATCHING)
+
 #if IS_ENABLED(CONFIG_ZMK_SPLIT_BLE_CENTRAL_BATTERY_LEVEL_FETCHING)
 
 static uint8_t peripheral_battery_levels[ZMK_SPLIT_BLE_PERIPHERAL_COUNT] = {0};
@@ -561,6 +817,190 @@ static void update_peripherals_selected_physical_layout(struct k_work *_work) {
 K_WORK_DEFINE(update_peripherals_selected_layouts_work,
               update_peripherals_selected_physical_layout);
 
+static void split_central_subscribe_positions(struct peripheral_slot *slot, uint16_t value_handle) {
+#if IS_ENABLED(CONFIG_ZMK_SPLIT_BLE_POSITION_BATCHING)
+    slot->subscribe_params.notify = split_central_position_batch_notify_func;
+#else
+    slot->subscribe_params.notify = split_central_notify_func;
+#endif // IS_ENABLED(CONFIG_ZMK_SPLIT_BLE_POSITION_BATCHING)
+    slot->subscribe_params.disc_params = &slot->sub_discover_params;
+    slot->subscribe_params.end_handle = slot->discover_params.end_handle;
+    slot->subscribe_params.value_handle = value_handle;
+    slot->subscribe_params.value = BT_GATT_CCC_NOTIFY;
+    split_central_subscribe(slot->conn, &slot->subscribe_params);
+}
+
+#if ZMK_KEYMAP_HAS_SENSORS
+
+static void split_central_subscribe_sensors(struct peripheral_slot *slot, uint16_t value_handle) {
+    slot->sensor_subscribe_params.disc_params = &slot->sub_discover_params;
+    slot->sensor_subscribe_params.end_handle = slot->discover_params.end_handle;
+    slot->sensor_subscribe_params.value_handle = value_handle;
+    slot->sensor_subscribe_params.notify = split_central_sensor_notify_func;
+    slot->sensor_subscribe_params.value = BT_GATT_CCC_NOTIFY;
+    split_central_subscribe(slot->conn, &slot->sensor_subscribe_params);
+}
+
+#endif /* ZMK_KEYMAP_HAS_SENSORS */
+
+#if IS_ENABLED(CONFIG_ZMK_SPLIT_BLE_CENTRAL_BATTERY_LEVEL_FETCHING)
+
+static void split_central_subscribe_batt_lvl(struct peripheral_slot *slot, uint16_t value_handle) {
+    slot->batt_lvl_subscribe_params.disc_params = &slot->sub_discover_params;
+    slot->batt_lvl_subscribe_params.end_handle = slot->discover_params.end_handle;
+    slot->batt_lvl_subscribe_params.value_handle = value_handle;
+    slot->batt_lvl_subscribe_params.notify = split_central_battery_level_notify_func;
+    slot->batt_lvl_subscribe_params.value = BT_GATT_CCC_NOTIFY;
+    split_central_subscribe(slot->conn, &slot->batt_lvl_subscribe_params);
+
+    slot->batt_lvl_read_params.func = split_central_battery_level_read_func;
+    slot->batt_lvl_read_params.handle_count = 1;
+    slot->batt_lvl_read_params.single.handle = value_handle;
+    slot->batt_lvl_read_params.single.offset = 0;
+    bt_gatt_read(slot->conn, &slot->batt_lvl_read_params);
+}
+
+#endif /* IS_ENABLED(CONFIG_ZMK_SPLIT_BLE_CENTRAL_BATTERY_LEVEL_FETCHING) */
+
+#if IS_ENABLED(CONFIG_ZMK_INPUT_SPLIT)
+
+static void split_central_subscribe_input(struct peripheral_input_slot *input_slot) {
+    input_slot->sub.notify = peripheral_input_event_notify_cb;
+    input_slot->sub.value = BT_GATT_CCC_NOTIFY;
+    int err = split_central_subscribe(input_slot->conn, &input_slot->sub);
+    if (err < 0) {
+        LOG_WRN("Failed to subscribe to input notifications %d", err);
+    }
+}
+
+#endif // IS_ENABLED(CONFIG_ZMK_INPUT_SPLIT)
+
+#if IS_ENABLED(CONFIG_ZMK_SPLIT_BLE_BEHAVIOR_IDS)
+
+static void split_central_add_behavior_id(struct peripheral_slot *slot) {
+    struct behavior_id_parser *parser = &slot->behavior_id_parser;
+    const struct zmk_split_behavior_id_entry *entry = (const void *)parser->entry;
+    const char *name = (const char *)parser->entry + sizeof(*entry);
+
+    // Only behaviors this central also has can be invoked on the peripheral.
+    const struct device *behavior = zmk_behavior_get_binding(name);
+    if (!behavior) {
+        return;
+    }
+
+    if (parser->count >= ARRAY_SIZE(slot->behavior_ids)) {
+        LOG_WRN("No room for the ID of behavior %s, it will be invoked by name", name);
+        return;
+    }
+
+    slot->behavior_ids[parser->count++] = (struct peripheral_behavior_id){
+        .behavior = behavior,
+        .id = entry->behavior_id,
+    };
+}
+
+static uint8_t split_central_behavior_ids_read_func(struct bt_conn *conn, uint8_t err,
+                                                    struct bt_gatt_read_params *params,
+                                                    const void *data, uint16_t length) {
+    struct peripheral_slot *slot = peripheral_slot_for_conn(conn);
+    if (slot == NULL) {
+        LOG_ERR("No peripheral state found for connection");
+        return BT_GATT_ITER_STOP;
+    }
+
+    if (err) {
+        LOG_ERR("Failed to read behavior IDs (err %d)", err);
+        return BT_GATT_ITER_STOP;
+    }
+
+    struct behavior_id_parser *parser = &slot->behavior_id_parser;
+
+    if (!data) {
+        LOG_DBG("Peripheral %d runs %d behaviors by ID", (int)(slot - peripherals),
+                parser->count);
+        slot->behavior_ids_len = parser->count;
+        return BT_GATT_ITER_STOP;
+    }
+
+    for (uint16_t i = 0; i < length; i++) {
+        uint8_t byte = ((const uint8_t *)data)[i];
+
+        if (parser->entry_len < sizeof(parser->entry)) {
+            parser->entry[parser->entry_len++] = byte;
+        } else {
+            parser->overflow = true;
+        }
+
+        if (byte != '\0' || parser->entry_len <= sizeof(struct zmk_split_behavior_id_entry)) {
+            continue;
+        }
+
+        if (parser->overflow) {
+            LOG_WRN("Ignoring behavior ID entry with a name that is too long");
+        } else {
+            split_central_add_behavior_id(slot);
+        }
+
+        parser->entry_len = 0;
+        parser->overflow = false;
+    }
+
+    return BT_GATT_ITER_CONTINUE;
+}
+
+static void split_central_read_behavior_ids(struct peripheral_slot *slot, uint16_t handle) {
+    slot->behavior_ids_handle = handle;
+    slot->behavior_ids_len = 0;
+    slot->behavior_id_parser = (struct behavior_id_parser){0};
+
+    slot->behavior_ids_read_params.func = split_central_behavior_ids_read_func;
+    slot->behavior_ids_read_params.handle_count = 1;
+    slot->behavior_ids_read_params.single.handle = handle;
+    slot->behavior_ids_read_params.single.offset = 0;
+
+    int err = bt_gatt_read(slot->conn, &slot->behavior_ids_read_params);
+    if (err < 0) {
+        LOG_ERR("Failed to start reading behavior IDs (err %d)", err);
+    }
+}
+
+#endif // IS_ENABLED(CONFIG_ZMK_SPLIT_BLE_BEHAVIOR_IDS)
+
+static bool split_central_is_subscribed(struct peripheral_slot *slot) {
+    bool subscribed = slot->run_behavior_handle && slot->subscribe_params.value_handle &&
+                      slot->selected_physical_layout_handle;
+
+#if ZMK_KEYMAP_HAS_SENSORS
+    subscribed = subscribed && slot->sensor_subscribe_params.value_handle;
+#endif /* ZMK_KEYMAP_HAS_SENSORS */
+
+#if IS_ENABLED(CONFIG_ZMK_SPLIT_PERIPHERAL_HID_INDICATORS)
+    subscribed = subscribed && slot->update_hid_indicators;
+#endif // IS_ENABLED(CONFIG_ZMK_SPLIT_PERIPHERAL_HID_INDICATORS)
+#if IS_ENABLED(CONFIG_ZMK_SPLIT_BLE_CENTRAL_BATTERY_LEVEL_FETCHING)
+    subscribed = subscribed && slot->batt_lvl_subscribe_params.value_handle;
+#endif /* IS_ENABLED(CONFIG_ZMK_SPLIT_BLE_CENTRAL_BATTERY_LEVEL_FETCHING) */
+#if IS_ENABLED(CONFIG_ZMK_INPUT_SPLIT)
+    for (size_t i = 0; i < ARRAY_SIZE(peripheral_input_slots); i++) {
+        if (input_slot_is_open(i) || input_slot_is_pending(i)) {
+            subscribed = false;
+            break;
+        }
+    }
+#endif // IS_ENABLED(CONFIG_ZMK_INPUT_SPLIT)
+
+    return subscribed;
+}
+
+static void split_central_log_ready(struct peripheral_slot *slot, const char *how) {
+    if (slot->connected_at == 0) {
+        return;
+    }
+
+    LOG_DBG("Peripheral %d subscribed %d ms after connecting, using %s",
+            (int)(slot - peripherals), (int)(k_uptime_get() - slot->connected_at), how);
+}
+
 static uint8_t split_central_chrc_discovery_func(struct bt_conn *conn,
                                                  const struct bt_gatt_attr *attr,
                                                  struct bt_gatt_discover_params *params) {
@@ -585,15 +1025,16 @@ static uint8_t split_central_chrc_discovery_func(struct bt_conn *conn,
     case BT_GATT_DISCOVER_CHARACTERISTIC:
         const struct bt_uuid *chrc_uuid = ((struct bt_gatt_chrc *)attr->user_data)->uuid;
 
+#if IS_ENABLED(CONFIG_ZMK_SPLIT_BLE_POSITION_BATCHING)
+        if (bt_uuid_cmp(chrc_uuid, BT_UUID_DECLARE_128(ZMK_SPLIT_BT_CHAR_POSITION_BATCH_UUID)) ==
+            0) {
+            LOG_DBG("Found position batch characteristic");
+#else
         if (bt_uuid_cmp(chrc_uuid, BT_UUID_DECLARE_128(ZMK_SPLIT_BT_CHAR_POSITION_STATE_UUID)) ==
             0) {
             LOG_DBG("Found position state characteristic");
-            slot->subscribe_params.disc_params = &slot->sub_discover_params;
-            slot->subscribe_params.end_handle = slot->discover_params.end_handle;
-            slot->subscribe_params.value_handle = bt_gatt_attr_value_handle(attr);
-            slot->subscribe_params.notify = split_central_notify_func;
-            slot->subscribe_params.value = BT_GATT_CCC_NOTIFY;
-            split_central_subscribe(conn, &slot->subscribe_params);
+#endif // IS_ENABLED(CONFIG_ZMK_SPLIT_BLE_POSITION_BATCHING)
+            split_central_subscribe_positions(slot, bt_gatt_attr_value_handle(attr));
 #if ZMK_KEYMAP_HAS_SENSORS
         } else if (bt_uuid_cmp(chrc_uuid,
                                BT_UUID_DECLARE_128(ZMK_SPLIT_BT_CHAR_SENSOR_STATE_UUID)) == 0) {
@@ -601,12 +1042,7 @@ static uint8_t split_central_chrc_discovery_func(struct bt_conn *conn,
             slot->discover_params.start_handle = attr->handle + 2;
             slot->discover_params.type = BT_GATT_DISCOVER_CHARACTERISTIC;
 
-            slot->sensor_subscribe_params.disc_params = &slot->sub_discover_params;
-            slot->sensor_subscribe_params.end_handle = slot->discover_params.end_handle;
-            slot->sensor_subscribe_params.value_handle = bt_gatt_attr_value_handle(attr);
-            slot->sensor_subscribe_params.notify = split_central_sensor_notify_func;
-            slot->sensor_subscribe_params.value = BT_GATT_CCC_NOTIFY;
-            split_central_subscribe(conn, &slot->sensor_subscribe_params);
+            split_central_subscribe_sensors(slot, bt_gatt_attr_value_handle(attr));
 #endif /* ZMK_KEYMAP_HAS_SENSORS */
 #if IS_ENABLED(CONFIG_ZMK_INPUT_SPLIT)
         } else if (bt_uuid_cmp(chrc_uuid, BT_UUID_DECLARE_128(ZMK_SPLIT_BT_INPUT_EVENT_UUID)) ==
@@ -635,6 +1071,12 @@ static uint8_t split_central_chrc_discovery_func(struct bt_conn *conn,
             slot->discover_params.uuid = NULL;
             slot->discover_params.start_handle = attr->handle + 2;
             slot->run_behavior_handle = bt_gatt_attr_value_handle(attr);
+#if IS_ENABLED(CONFIG_ZMK_SPLIT_BLE_BEHAVIOR_IDS)
+        } else if (bt_uuid_cmp(chrc_uuid,
+                               BT_UUID_DECLARE_128(ZMK_SPLIT_BT_CHAR_BEHAVIOR_IDS_UUID)) == 0) {
+            LOG_DBG("Found behavior IDs handle");
+            split_central_read_behavior_ids(slot, bt_gatt_attr_value_handle(attr));
+#endif // IS_ENABLED(CONFIG_ZMK_SPLIT_BLE_BEHAVIOR_IDS)
         } else if (!bt_uuid_cmp(((struct bt_gatt_chrc *)attr->user_data)->uuid,
                                 BT_UUID_DECLARE_128(ZMK_SPLIT_BT_SELECT_PHYS_LAYOUT_UUID))) {
             LOG_DBG("Found select physical layout handle");
@@ -650,18 +1092,7 @@ static uint8_t split_central_chrc_discovery_func(struct bt_conn *conn,
         } else if (!bt_uuid_cmp(((struct bt_gatt_chrc *)attr->user_data)->uuid,
                                 BT_UUID_BAS_BATTERY_LEVEL)) {
             LOG_DBG("Found battery level characteristics");
-            slot->batt_lvl_subscribe_params.disc_params = &slot->sub_discover_params;
-            slot->batt_lvl_subscribe_params.end_handle = slot->discover_params.end_handle;
-            slot->batt_lvl_subscribe_params.value_handle = bt_gatt_attr_value_handle(attr);
-            slot->batt_lvl_subscribe_params.notify = split_central_battery_level_notify_func;
-            slot->batt_lvl_subscribe_params.value = BT_GATT_CCC_NOTIFY;
-            split_central_subscribe(conn, &slot->batt_lvl_subscribe_params);
-
-            slot->batt_lvl_read_params.func = split_central_battery_level_read_func;
-            slot->batt_lvl_read_params.handle_count = 1;
-            slot->batt_lvl_read_params.single.handle = bt_gatt_attr_value_handle(attr);
-            slot->batt_lvl_read_params.single.offset = 0;
-            bt_gatt_read(conn, &slot->batt_lvl_read_params);
+            split_central_subscribe_batt_lvl(slot, bt_gatt_attr_value_handle(attr));
 #endif /* IS_ENABLED(CONFIG_ZMK_SPLIT_BLE_CENTRAL_BATTERY_LEVEL_FETCHING) */
         }
         break;
@@ -694,12 +1125,7 @@ static uint8_t split_central_chrc_discovery_func(struct bt_conn *conn,
             } else {
                 LOG_DBG("Found pending input slot");
                 input_slot->reg = cpf->description;
-                input_slot->sub.notify = peripheral_input_event_notify_cb;
-                input_slot->sub.value = BT_GATT_CCC_NOTIFY;
-                int err = split_central_subscribe(conn, &input_slot->sub);
-                if (err < 0) {
-                    LOG_WRN("Failed to subscribe to input notifications %d", err);
-                }
+                split_central_subscribe_input(input_slot);
             }
 
             slot->discover_params.uuid = NULL;
@@ -710,29 +1136,17 @@ static uint8_t split_central_chrc_discovery_func(struct bt_conn *conn,
         break;
     }
 
-    bool subscribed = slot->run_behavior_handle && slot->subscribe_params.value_handle &&
-                      slot->selected_physical_layout_handle;
-
-#if ZMK_KEYMAP_HAS_SENSORS
-    subscribed = subscribed && slot->sensor_subscribe_params.value_handle;
-#endif /* ZMK_KEYMAP_HAS_SENSORS */
-
-#if IS_ENABLED(CONFIG_ZMK_SPLIT_PERIPHERAL_HID_INDICATORS)
-    subscribed = subscribed && slot->update_hid_indicators;
-#endif // IS_ENABLED(CONFIG_ZMK_SPLIT_PERIPHERAL_HID_INDICATORS)
-#if IS_ENABLED(CONFIG_ZMK_SPLIT_BLE_CENTRAL_BATTERY_LEVEL_FETCHING)
-    subscribed = subscribed && slot->batt_lvl_subscribe_params.value_handle;
-#endif /* IS_ENABLED(CONFIG_ZMK_SPLIT_BLE_CENTRAL_BATTERY_LEVEL_FETCHING) */
-#if IS_ENABLED(CONFIG_ZMK_INPUT_SPLIT)
-    for (size_t i = 0; i < ARRAY_SIZE(peripheral_input_slots); i++) {
-        if (input_slot_is_open(i) || input_slot_is_pending(i)) {
-            subscribed = false;
-            break;
-        }
+    if (!split_central_is_subscribed(slot)) {
+        return BT_GATT_ITER_CONTINUE;
     }
-#endif // IS_ENABLED(CONFIG_ZMK_INPUT_SPLIT)
 
-    return subscribed ? BT_GATT_ITER_STOP : BT_GATT_ITER_CONTINUE;
+    split_central_log_ready(slot, "discovered handles");
+#if IS_ENABLED(CONFIG_ZMK_SPLIT_BLE_CENTRAL_CACHE_HANDLES)
+    slot->handle_cache_save_attempts = 0;
+    k_work_reschedule(&slot->handle_cache_save_work, K_MSEC(HANDLE_CACHE_SAVE_DELAY_MS));
+#endif // IS_ENABLED(CONFIG_ZMK_SPLIT_BLE_CENTRAL_CACHE_HANDLES)
+
+    return BT_GATT_ITER_STOP;
 }
 
 static uint8_t split_central_service_discovery_func(struct bt_conn *conn,
@@ -770,9 +1184,239 @@ static uint8_t split_central_service_discovery_func(struct bt_conn *conn,
     return BT_GATT_ITER_STOP;
 }
 
-static void split_central_process_connection(struct bt_conn *conn) {
-    int err;
+static int split_central_start_discovery(struct peripheral_slot *slot) {
+    slot->discover_params.uuid = &split_service_uuid.uuid;
+    slot->discover_params.func = split_central_service_discovery_func;
+    slot->discover_params.start_handle = 0x0001;
+    slot->discover_params.end_handle = 0xffff;
+    slot->discover_params.type = BT_GATT_DISCOVER_PRIMARY;
+
+    int err = bt_gatt_discover(slot->conn, &slot->discover_params);
+    if (err) {
+        LOG_ERR("Discover failed(err %d)", err);
+    }
+
+    return err;
+}
+
+#if IS_ENABLED(CONFIG_ZMK_SPLIT_BLE_CENTRAL_CACHE_HANDLES)
+
+static void handle_cache_setting_name(char *name, size_t len, int index) {
+    snprintf(name, len, "ble_central/handles/%d", index);
+}
+
+static void split_central_save_handle_cache(struct k_work *work) {
+    struct k_work_delayable *d_work = k_work_delayable_from_work(work);
+    struct peripheral_slot *slot =
+        CONTAINER_OF(d_work, struct peripheral_slot, handle_cache_save_work);
+    int index = slot - peripherals;
+
+    if (slot->state != PERIPHERAL_SLOT_STATE_CONNECTED || !slot->db_hash_valid) {
+        return;
+    }
+
+    struct peripheral_handle_cache cache;
+
+    // The whole struct, padding included, is compared with the saved cache and written to
+    // settings, so clear it rather than relying on an initializer to zero the padding.
+    memset(&cache, 0, sizeof(cache));
+    cache.position_value_handle = slot->subscribe_params.value_handle;
+    cache.position_ccc_handle = slot->subscribe_params.ccc_handle;
+    cache.run_behavior_handle = slot->run_behavior_handle;
+#if IS_ENABLED(CONFIG_ZMK_SPLIT_BLE_BEHAVIOR_IDS)
+    cache.behavior_ids_handle = slot->behavior_ids_handle;
+#endif // IS_ENABLED(CONFIG_ZMK_SPLIT_BLE_BEHAVIOR_IDS)
+    cache.selected_physical_layout_handle = slot->selected_physical_layout_handle;
+
+    bool complete = cache.position_ccc_handle != 0;
+
+    bt_addr_le_copy(&cache.addr, bt_conn_get_dst(slot->conn));
+    memcpy(cache.db_hash, slot->db_hash, sizeof(cache.db_hash));
+
+#if ZMK_KEYMAP_HAS_SENSORS
+    cache.sensor_value_handle = slot->sensor_subscribe_params.value_handle;
+    cache.sensor_ccc_handle = slot->sensor_subscribe_params.ccc_handle;
+    complete = complete && cache.sensor_ccc_handle;
+#endif /* ZMK_KEYMAP_HAS_SENSORS */
+#if IS_ENABLED(CONFIG_ZMK_SPLIT_PERIPHERAL_HID_INDICATORS)
+    cache.update_hid_indicators_handle = slot->update_hid_indicators;
+#endif // IS_ENABLED(CONFIG_ZMK_SPLIT_PERIPHERAL_HID_INDICATORS)
+#if IS_ENABLED(CONFIG_ZMK_SPLIT_BLE_CENTRAL_BATTERY_LEVEL_FETCHING)
+    cache.batt_lvl_value_handle = slot->batt_lvl_subscribe_params.value_handle;
+    cache.batt_lvl_ccc_handle = slot->batt_lvl_subscribe_params.ccc_handle;
+    complete = complete && cache.batt_lvl_ccc_handle;
+#endif /* IS_ENABLED(CONFIG_ZMK_SPLIT_BLE_CENTRAL_BATTERY_LEVEL_FETCHING) */
+#if IS_ENABLED(CONFIG_ZMK_INPUT_SPLIT)
+    size_t inputs = 0;
+    for (size_t i = 0; i < ARRAY_SIZE(peripheral_input_slots); i++) {
+        if (peripheral_input_slots[i].conn != slot->conn) {
+            continue;
+        }
+
+        cache.inputs[inputs].value_handle = peripheral_input_slots[i].sub.value_handle;
+        cache.inputs[inputs].ccc_handle = peripheral_input_slots[i].sub.ccc_handle;
+        cache.inputs[inputs].reg = peripheral_input_slots[i].reg;
+        inputs++;
+    }
+#endif // IS_ENABLED(CONFIG_ZMK_INPUT_SPLIT)
+
+    if (!complete) {
+        if (++slot->handle_cache_save_attempts < HANDLE_CACHE_SAVE_MAX_ATTEMPTS) {
+            k_work_reschedule(d_work, K_MSEC(HANDLE_CACHE_SAVE_DELAY_MS));
+        } else {
+            LOG_WRN("Not caching handles for peripheral %d with undiscovered CCC handles", index);
+        }
+        return;
+    }
+
+    if (memcmp(&handle_caches[index], &cache, sizeof(cache)) == 0) {
+        return;
+    }
+
+    handle_caches[index] = cache;
+
+    char setting_name[32];
+    handle_cache_setting_name(setting_name, sizeof(setting_name), index);
+    int err = settings_save_one(setting_name, &cache, sizeof(cache));
+    if (err < 0) {
+        LOG_ERR("Failed to save handles for peripheral %d (err %d)", index, err);
+    }
+}
+
+// Set up the slot from the handles cached for the peripheral, if its GATT database hasn't changed
+// since they were discovered. Returns false if a full discovery is needed.
+static bool split_central_restore_handles(struct peripheral_slot *slot) {
+    const struct peripheral_handle_cache *cache = &handle_caches[slot - peripherals];
+
+    if (!slot->db_hash_valid || bt_addr_le_cmp(&cache->addr, bt_conn_get_dst(slot->conn)) != 0 ||
+        memcmp(cache->db_hash, slot->db_hash, sizeof(cache->db_hash)) != 0) {
+        return false;
+    }
+
+    // The cache may be from firmware built with different split features.
+    bool usable = cache->position_value_handle && cache->position_ccc_handle &&
+                  cache->run_behavior_handle && cache->selected_physical_layout_handle;
+#if ZMK_KEYMAP_HAS_SENSORS
+    usable = usable && cache->sensor_value_handle && cache->sensor_ccc_handle;
+#endif /* ZMK_KEYMAP_HAS_SENSORS */
+#if IS_ENABLED(CONFIG_ZMK_SPLIT_PERIPHERAL_HID_INDICATORS)
+    usable = usable && cache->update_hid_indicators_handle;
+#endif // IS_ENABLED(CONFIG_ZMK_SPLIT_PERIPHERAL_HID_INDICATORS)
+#if IS_ENABLED(CONFIG_ZMK_SPLIT_BLE_CENTRAL_BATTERY_LEVEL_FETCHING)
+    usable = usable && cache->batt_lvl_value_handle && cache->batt_lvl_ccc_handle;
+#endif /* IS_ENABLED(CONFIG_ZMK_SPLIT_BLE_CENTRAL_BATTERY_LEVEL_FETCHING) */
+    if (!usable) {
+        return false;
+    }
+
+    slot->discover_params.end_handle = 0xffff;
+
+    slot->subscribe_params.ccc_handle = cache->position_ccc_handle;
+    split_central_subscribe_positions(slot, cache->position_value_handle);
+#if ZMK_KEYMAP_HAS_SENSORS
+    slot->sensor_subscribe_params.ccc_handle = cache->sensor_ccc_handle;
+    split_central_subscribe_sensors(slot, cache->sensor_value_handle);
+#endif /* ZMK_KEYMAP_HAS_SENSORS */
+#if IS_ENABLED(CONFIG_ZMK_INPUT_SPLIT)
+    for (size_t i = 0; i < ARRAY_SIZE(cache->inputs) && cache->inputs[i].value_handle; i++) {
+        struct peripheral_input_slot *input_slot;
+        if (reserve_next_open_input_slot(&input_slot, slot->conn) < 0) {
+            LOG_WRN("No available slot for peripheral input subscriptions");
+            break;
+        }
+
+        input_slot->sub.value_handle = cache->inputs[i].value_handle;
+        input_slot->sub.ccc_handle = cache->inputs[i].ccc_handle;
+        input_slot->reg = cache->inputs[i].reg;
+        split_central_subscribe_input(input_slot);
+    }
+#endif // IS_ENABLED(CONFIG_ZMK_INPUT_SPLIT)
+
+    slot->run_behavior_handle = cache->run_behavior_handle;
+#if IS_ENABLED(CONFIG_ZMK_SPLIT_BLE_BEHAVIOR_IDS)
+    // The IDs may change without changing the GATT database, so the table is always read again.
+    if (cache->behavior_ids_handle) {
+        split_central_read_behavior_ids(slot, cache->behavior_ids_handle);
+    }
+#endif // IS_ENABLED(CONFIG_ZMK_SPLIT_BLE_BEHAVIOR_IDS)
+#if IS_ENABLED(CONFIG_ZMK_SPLIT_PERIPHERAL_HID_INDICATORS)
+    slot->update_hid_indicators = cache->update_hid_indicators_handle;
+#endif // IS_ENABLED(CONFIG_ZMK_SPLIT_PERIPHERAL_HID_INDICATORS)
+#if IS_ENABLED(CONFIG_ZMK_SPLIT_BLE_CENTRAL_BATTERY_LEVEL_FETCHING)
+    slot->batt_lvl_subscribe_params.ccc_handle = cache->batt_lvl_ccc_handle;
+    split_central_subscribe_batt_lvl(slot, cache->batt_lvl_value_handle);
+#endif /* IS_ENABLED(CONFIG_ZMK_SPLIT_BLE_CENTRAL_BATTERY_LEVEL_FETCHING) */
+
+    slot->selected_physical_layout_handle = cache->selected_physical_layout_handle;
+    k_work_submit(&update_peripherals_selected_layouts_work);
+
+    split_central_log_ready(slot, "cached handles");
+    return true;
+}
+
+static uint8_t split_central_db_hash_read_func(struct bt_conn *conn, uint8_t err,
+                                               struct bt_gatt_read_params *params,
+                                               const void *data, uint16_t length) {
+    struct peripheral_slot *slot = peripheral_slot_for_conn(conn);
+    if (slot == NULL) {
+        LOG_ERR("No peripheral state found for connection");
+        return BT_GATT_ITER_STOP;
+    }
+
+    // Peripherals without GATT caching have no database hash, and are always discovered.
+    if (!err && data && length == GATT_DB_HASH_LEN) {
+        memcpy(slot->db_hash, data, GATT_DB_HASH_LEN);
+        slot->db_hash_valid = true;
+    } else {
+        LOG_DBG("No GATT database hash read from peripheral (err %d)", err);
+    }
+
+    if (!split_central_restore_handles(slot)) {
+        split_central_start_discovery(slot);
+    }
+
+    return BT_GATT_ITER_STOP;
+}
+
+static int split_central_read_db_hash(struct peripheral_slot *slot) {
+    slot->db_hash_valid = false;
+    slot->db_hash_read_params = (struct bt_gatt_read_params){
+        .func = split_central_db_hash_read_func,
+        .handle_count = 0,
+        .by_uuid.uuid = BT_UUID_GATT_DB_HASH,
+        .by_uuid.start_handle = 0x0001,
+        .by_uuid.end_handle = 0xffff,
+    };
+
+    int err = bt_gatt_read(slot->conn, &slot->db_hash_read_params);
+    if (err < 0) {
+        LOG_WRN("Failed to read GATT database hash (err %d)", err);
+    }
+
+    return err;
+}
+
+static void split_central_bond_deleted(uint8_t id, const bt_addr_le_t *peer) {
+    for (int i = 0; i < ZMK_SPLIT_BLE_PERIPHERAL_COUNT; i++) {
+        if (bt_addr_le_cmp(&handle_caches[i].addr, peer) != 0) {
+            continue;
+        }
+
+        memset(&handle_caches[i], 0, sizeof(handle_caches[i]));
+
+        char setting_name[32];
+        handle_cache_setting_name(setting_name, sizeof(setting_name), i);
+        settings_delete(setting_name);
+    }
+}
 
+static struct bt_conn_auth_info_cb split_central_auth_info_cb = {
+    .bond_deleted = split_central_bond_deleted,
+};
+
+#endif // IS_ENABLED(CONFIG_ZMK_SPLIT_BLE_CENTRAL_CACHE_HANDLES)
+
+static void split_central_process_connection(struct bt_conn *conn) {
     LOG_DBG("Current security for connection: %d", bt_conn_get_security(conn));
 
     struct peripheral_slot *slot = peripheral_slot_for_conn(conn);
@@ -782,15 +1426,16 @@ static void split_central_process_connection(struct bt_conn *conn) {
     }
 
     if (!slot->subscribe_params.value_handle) {
-        slot->discover_params.uuid = &split_service_uuid.uuid;
-        slot->discover_params.func = split_central_service_discovery_func;
-        slot->discover_params.start_handle = 0x0001;
-        slot->discover_params.end_handle = 0xffff;
-        slot->discover_params.type = BT_GATT_DISCOVER_PRIMARY;
-
-        err = bt_gatt_discover(slot->conn, &slot->discover_params);
+#if IS_ENABLED(CONFIG_ZMK_SPLIT_BLE_CENTRAL_CACHE_HANDLES)
+        // Discovery starts from the hash read callback, once it's known whether it's needed.
+        int err = split_central_read_db_hash(slot);
+        if (err < 0) {
+            err = split_central_start_discovery(slot);
+        }
+#else
+        int err = split_central_start_discovery(slot);
+#endif // IS_ENABLED(CONFIG_ZMK_SPLIT_BLE_CENTRAL_CACHE_HANDLES)
         if (err) {
-            LOG_ERR("Discover failed(err %d)", err);
             return;
         }
     }
@@ -1028,7 +1673,11 @@ struct k_work_q split_central_split_run_q;
 
 struct zmk_split_run_behavior_payload_wrapper {
     uint8_t source;
-    struct zmk_split_run_behavior_payload payload;
+    bool by_id;
+    union {
+        struct zmk_split_run_behavior_payload payload;
+        struct zmk_split_run_behavior_id_payload id_payload;
+    };
 };
 
 K_MSGQ_DEFINE(zmk_split_central_split_run_msgq,
@@ -1045,15 +1694,25 @@ void split_central_split_run_callback(struct k_work *work) {
             LOG_ERR("Source not connected");
             continue;
         }
-        if (!peripherals[payload_wrapper.source].run_behavior_handle) {
+
+        uint16_t handle = peripherals[payload_wrapper.source].run_behavior_handle;
+        const void *data = &payload_wrapper.payload;
+        uint16_t len = sizeof(struct zmk_split_run_behavior_payload);
+#if IS_ENABLED(CONFIG_ZMK_SPLIT_BLE_BEHAVIOR_IDS)
+        if (payload_wrapper.by_id) {
+            handle = peripherals[payload_wrapper.source].behavior_ids_handle;
+            data = &payload_wrapper.id_payload;
+            len = sizeof(struct zmk_split_run_behavior_id_payload);
+        }
+#endif // IS_ENABLED(CONFIG_ZMK_SPLIT_BLE_BEHAVIOR_IDS)
+
+        if (!handle) {
             LOG_ERR("Run behavior handle not found");
             continue;
         }
 
-        int err = bt_gatt_write_without_response(
-            peripherals[payload_wrapper.source].conn,
-            peripherals[payload_wrapper.source].run_behavior_handle, &payload_wrapper.payload,
-            sizeof(struct zmk_split_run_behavior_payload), true);
+        int err = bt_gatt_write_without_response(peripherals[payload_wrapper.source].conn,
+                                                 handle, data, len, true);
 
         if (err) {
             LOG_ERR("Failed to write the behavior characteristic (err %d)", err);
@@ -1087,23 +1746,61 @@ split_bt_invoke_behavior_payload(struct zmk_split_run_behavior_payload_wrapper p
     return 0;
 };
 
+#if IS_ENABLED(CONFIG_ZMK_SPLIT_BLE_BEHAVIOR_IDS)
+
+static int find_peripheral_behavior_id(uint8_t source, const struct zmk_behavior_binding *binding,
+                                       zmk_behavior_local_id_t *id) {
+    if (source >= ZMK_SPLIT_BLE_PERIPHERAL_COUNT) {
+        return -EINVAL;
+    }
+
+    const struct peripheral_slot *slot = &peripherals[source];
+    const struct device *behavior = zmk_behavior_get_binding_device(binding);
+
+    for (int i = 0; i < slot->behavior_ids_len; i++) {
+        if (slot->behavior_ids[i].behavior == behavior) {
+            *id = slot->behavior_ids[i].id;
+            return 0;
+        }
+    }
+
+    return -ENODEV;
+}
+
+#endif // IS_ENABLED(CONFIG_ZMK_SPLIT_BLE_BEHAVIOR_IDS)
+
 int zmk_split_bt_invoke_behavior(uint8_t source, struct zmk_behavior_binding *binding,
                                  struct zmk_behavior_binding_event event, bool state) {
-    struct zmk_split_run_behavior_payload payload = {.data = {
-                                                         .param1 = binding->param1,
-                                                         .param2 = binding->param2,
-                                                         .position = event.position,
-                                                         .source = event.source,
-                                                         .state = state ? 1 : 0,
-                                                     }};
-    const size_t payload_dev_size = sizeof(payload.behavior_dev);
-    if (strlcpy(payload.behavior_dev, binding->behavior_dev, payload_dev_size) >=
+    struct zmk_split_run_behavior_data data = {
+        .param1 = binding->param1,
+        .param2 = binding->param2,
+        .position = event.position,
+        .source = event.source,
+        .state = state ? 1 : 0,
+    };
+    struct zmk_split_run_behavior_payload_wrapper wrapper = {.source = source};
+
+#if IS_ENABLED(CONFIG_ZMK_SPLIT_BLE_BEHAVIOR_IDS)
+    zmk_behavior_local_id_t id;
+    if (find_peripheral_behavior_id(source, binding, &id) == 0) {
+        wrapper.by_id = true;
+        wrapper.id_payload = (struct zmk_split_run_behavior_id_payload){
+            .data = data,
+            .behavior_id = id,
+        };
+        return split_bt_invoke_behavior_payload(wrapper);
+    }
+#endif // IS_ENABLED(CONFIG_ZMK_SPLIT_BLE_BEHAVIOR_IDS)
+
+    // Peripherals without a behavior ID table look the behavior up by name.
+    wrapper.payload.data = data;
+    const size_t payload_dev_size = sizeof(wrapper.payload.behavior_dev);
+    if (strlcpy(wrapper.payload.behavior_dev, binding->behavior_dev, payload_dev_size) >=
         payload_dev_size) {
         LOG_ERR("Truncated behavior label %s to %s before invoking peripheral behavior",
-                binding->behavior_dev, payload.behavior_dev);
+                binding->behavior_dev, wrapper.payload.behavior_dev);
     }
 
-    struct zmk_split_run_behavior_payload_wrapper wrapper = {.source = source, .payload = payload};
     return split_bt_invoke_behavior_payload(wrapper);
 }
 
@@ -1144,6 +1841,48 @@ int zmk_split_bt_update_hid_indicator(zmk_hid_indicators_t indicators) {
 
 #endif // IS_ENABLED(CONFIG_ZMK_SPLIT_PERIPHERAL_HID_INDICATORS)
 
+static int split_central_bt_send_command(uint8_t source,
+                                         struct zmk_split_transport_central_command cmd) {
+    if (source >= ZMK_SPLIT_BLE_PERIPHERAL_COUNT) {
+        return -EINVAL;
+    }
+
+    switch (cmd.type) {
+    case ZMK_SPLIT_TRANSPORT_CENTRAL_CMD_TYPE_INVOKE_BEHAVIOR: {
+        struct zmk_behavior_binding binding = {
+            .param1 = cmd.data.invoke_behavior.param1,
+            .param2 = cmd.data.invoke_behavior.param2,
+            .behavior_dev = cmd.data.invoke_behavior.behavior_dev,
+        };
+        struct zmk_behavior_binding_event event = {
+            .position = cmd.data.invoke_behavior.position,
+            .source = source,
+            .timestamp = k_uptime_get(),
+        };
+
+        return zmk_split_bt_invoke_behavior(source, &binding, event,
+                                            cmd.data.invoke_behavior.state > 0);
+    }
+    case ZMK_SPLIT_TRANSPORT_CENTRAL_CMD_TYPE_SET_PHYSICAL_LAYOUT:
+        return update_peripheral_selected_layout(&peripherals[source],
+                                                 cmd.data.set_physical_layout.layout_idx);
+#if IS_ENABLED(CONFIG_ZMK_SPLIT_PERIPHERAL_HID_INDICATORS)
+    case ZMK_SPLIT_TRANSPORT_CENTRAL_CMD_TYPE_SET_HID_INDICATORS:
+        // Indicators are written to every connected peripheral at once, so sending them for each
+        // source only coalesces into the pending write.
+        return zmk_split_bt_update_hid_indicator(cmd.data.set_hid_indicators.indicators);
+#endif // IS_ENABLED(CONFIG_ZMK_SPLIT_PERIPHERAL_HID_INDICATORS)
+    default:
+        return -ENOTSUP;
+    }
+}
+
+static const struct zmk_split_transport_central_api bt_central_api = {
+    .send_command = split_central_bt_send_command,
+};
+
+ZMK_SPLIT_TRANSPORT_CENTRAL_REGISTER(bt_central, &bt_central_api);
+
 static int finish_init() {
     return IS_ENABLED(CONFIG_ZMK_BLE_CLEAR_BONDS_ON_START) ? 0 : start_scanning();
 }
@@ -1152,6 +1891,29 @@ static int finish_init() {
 
 static int central_ble_handle_set(const char *name, size_t len, settings_read_cb read_cb,
                                   void *cb_arg) {
+#if IS_ENABLED(CONFIG_ZMK_SPLIT_BLE_CENTRAL_CACHE_HANDLES)
+    const char *next;
+
+    if (settings_name_steq(name, "handles", &next) && next) {
+        int i = atoi(next);
+        if (i < 0 || i >= ZMK_SPLIT_BLE_PERIPHERAL_COUNT) {
+            return -EINVAL;
+        }
+
+        // A cache saved by firmware with a different layout is dropped, and rediscovered.
+        if (len != sizeof(struct peripheral_handle_cache)) {
+            return 0;
+        }
+
+        int err = read_cb(cb_arg, &handle_caches[i], sizeof(struct peripheral_handle_cache));
+        if (err <= 0) {
+            LOG_ERR("Failed to handle peripheral handles from settings (err %d)", err);
+            memset(&handle_caches[i], 0, sizeof(struct peripheral_handle_cache));
+            return err;
+        }
+    }
+#endif // IS_ENABLED(CONFIG_ZMK_SPLIT_BLE_CENTRAL_CACHE_HANDLES)
+
     return 0;
 }
 
@@ -1166,6 +1928,14 @@ static int zmk_split_bt_central_init(void) {
                        CONFIG_ZMK_BLE_THREAD_PRIORITY, NULL);
     bt_conn_cb_register(&conn_callbacks);
 
+#if IS_ENABLED(CONFIG_ZMK_SPLIT_BLE_CENTRAL_CACHE_HANDLES)
+    for (int i = 0; i < ZMK_SPLIT_BLE_PERIPHERAL_COUNT; i++) {
+        k_work_init_delayable(&peripherals[i].handle_cache_save_work,
+                              split_central_save_handle_cache);
+    }
+    bt_conn_auth_info_cb_register(&split_central_auth_info_cb);
+#endif // IS_ENABLED(CONFIG_ZMK_SPLIT_BLE_CENTRAL_CACHE_HANDLES)
+
 #if IS_ENABLED(CONFIG_SETTINGS)
     settings_register(&ble_central_settings_handler);
     return 0;
@@ -14,6 +14,7 @@
 
 LOG_MODULE_DECLARE(zmk, CONFIG_ZMK_LOG_LEVEL);
 
+#include <zephyr/bluetooth/conn.h>
 #include <zephyr/bluetooth/gatt.h>
 #include <zephyr/bluetooth/uuid.h>
 
@@ -23,6 +24,7 @@ LOG_MODULE_DECLARE(zmk, CONFIG_ZMK_LOG_LEVEL);
 #include <zmk/physical_layouts.h>
 #include <zmk/split/bluetooth/uuid.h>
 #include <zmk/split/bluetooth/service.h>
+#include <zmk/split/transport/peripheral.h>
 
 #if IS_ENABLED(CONFIG_ZMK_SPLIT_PERIPHERAL_HID_INDICATORS)
 #include <zmk/events/hid_indicators_changed.h>
@@ -45,7 +47,7 @@ static void split_svc_sensor_state_ccc(const struct bt_gatt_attr *attr, uint16_t
 }
 #endif /* ZMK_KEYMAP_HAS_SENSORS */
 
-#define POS_STATE_LEN 16
+#define POS_STATE_LEN ZMK_SPLIT_POSITION_STATE_LEN
 
 static uint8_t num_of_positions = ZMK_KEYMAP_LEN;
 static uint8_t position_state[POS_STATE_LEN];
@@ -58,6 +60,22 @@ static ssize_t split_svc_pos_state(struct bt_conn *conn, const struct bt_gatt_at
                              sizeof(position_state));
 }
 
+static void split_svc_invoke_behavior(struct zmk_behavior_binding *binding,
+                                      const struct zmk_split_run_behavior_data *data) {
+    struct zmk_behavior_binding_event event = {.position = data->position,
+                                               .timestamp = k_uptime_get()};
+    int err;
+    if (data->state > 0) {
+        err = behavior_keymap_binding_pressed(binding, event);
+    } else {
+        err = behavior_keymap_binding_released(binding, event);
+    }
+
+    if (err) {
+        LOG_ERR("Failed to invoke behavior %s: %d", binding->behavior_dev, err);
+    }
+}
+
 static ssize_t split_svc_run_behavior(struct bt_conn *conn, const struct bt_gatt_attr *attrs,
                                       const void *buf, uint16_t len, uint16_t offset,
                                       uint8_t flags) {
@@ -86,23 +104,93 @@ static ssize_t split_svc_run_behavior(struct bt_conn *conn, const struct bt_gatt
         };
         LOG_DBG("%s with params %d %d: pressed? %d", binding.behavior_dev, binding.param1,
                 binding.param2, payload->data.state);
-        struct zmk_behavior_binding_event event = {.position = payload->data.position,
-                                                   .timestamp = k_uptime_get()};
-        int err;
-        if (payload->data.state > 0) {
-            err = behavior_keymap_binding_pressed(&binding, event);
-        } else {
-            err = behavior_keymap_binding_released(&binding, event);
-        }
+        split_svc_invoke_behavior(&binding, &payload->data);
+    }
 
-        if (err) {
-            LOG_ERR("Failed to invoke behavior %s: %d", binding.behavior_dev, err);
+    return len;
+}
+
+#if IS_ENABLED(CONFIG_ZMK_SPLIT_BLE_BEHAVIOR_IDS)
+
+static bool behavior_runs_on_peripheral(const struct device *behavior) {
+    enum behavior_locality locality = BEHAVIOR_LOCALITY_CENTRAL;
+    return behavior_get_locality(behavior, &locality) == 0 &&
+           locality != BEHAVIOR_LOCALITY_CENTRAL;
+}
+
+// Copy the part of a chunk at *pos in the attribute value that is inside the requested window.
+static uint16_t copy_read_window(void *buf, uint16_t len, uint16_t offset, size_t *pos,
+                                 const void *chunk, size_t chunk_len) {
+    size_t start = MAX(*pos, offset);
+    size_t end = MIN(*pos + chunk_len, offset + len);
+    uint16_t copied = 0;
+
+    if (start < end) {
+        memcpy((uint8_t *)buf + (start - offset), (const uint8_t *)chunk + (start - *pos),
+               end - start);
+        copied = end - start;
+    }
+
+    *pos += chunk_len;
+    return copied;
+}
+
+// Lists the local IDs of the behaviors the central may run on this peripheral, so it can invoke
+// them by ID. The table is generated on each read, and is usually long enough to be read in parts.
+static ssize_t split_svc_behavior_ids(struct bt_conn *conn, const struct bt_gatt_attr *attrs,
+                                      void *buf, uint16_t len, uint16_t offset) {
+    size_t pos = 0;
+    uint16_t copied = 0;
+
+    STRUCT_SECTION_FOREACH(zmk_behavior_local_id_map, item) {
+        if (!device_is_ready(item->device) || !behavior_runs_on_peripheral(item->device)) {
+            continue;
         }
+
+        struct zmk_split_behavior_id_entry entry = {.behavior_id = item->local_id};
+        copied += copy_read_window(buf, len, offset, &pos, &entry, sizeof(entry));
+        copied += copy_read_window(buf, len, offset, &pos, item->device->name,
+                                   strlen(item->device->name) + 1);
     }
 
+    if (offset > pos) {
+        return BT_GATT_ERR(BT_ATT_ERR_INVALID_OFFSET);
+    }
+
+    return copied;
+}
+
+static ssize_t split_svc_run_behavior_id(struct bt_conn *conn, const struct bt_gatt_attr *attrs,
+                                         const void *buf, uint16_t len, uint16_t offset,
+                                         uint8_t flags) {
+    if (offset != 0 || len != sizeof(struct zmk_split_run_behavior_id_payload)) {
+        return BT_GATT_ERR(BT_ATT_ERR_INVALID_ATTRIBUTE_LEN);
+    }
+
+    const struct zmk_split_run_behavior_id_payload *payload = buf;
+    const struct device *behavior = zmk_behavior_get_device_from_local_id(payload->behavior_id);
+    if (!behavior || !behavior_runs_on_peripheral(behavior)) {
+        LOG_ERR("No behavior to run with ID %d", payload->behavior_id);
+        return len;
+    }
+
+    struct zmk_behavior_binding binding = {
+        .param1 = payload->data.param1,
+        .param2 = payload->data.param2,
+        .behavior_dev = behavior->name,
+#if IS_ENABLED(CONFIG_ZMK_BEHAVIOR_DEVICES_IN_BINDINGS)
+        .device = behavior,
+#endif // IS_ENABLED(CONFIG_ZMK_BEHAVIOR_DEVICES_IN_BINDINGS)
+    };
+    LOG_DBG("%s with params %d %d: pressed? %d", binding.behavior_dev, binding.param1,
+            binding.param2, payload->data.state);
+    split_svc_invoke_behavior(&binding, &payload->data);
+
     return len;
 }
 
+#endif // IS_ENABLED(CONFIG_ZMK_SPLIT_BLE_BEHAVIOR_IDS)
+
 static ssize_t split_svc_num_of_positions(struct bt_conn *conn, const struct bt_gatt_attr *attrs,
                                           void *buf, uint16_t len, uint16_t offset) {
     return bt_gatt_attr_read(conn, attrs, buf, len, offset, attrs->user_data, sizeof(uint8_t));
@@ -112,6 +200,10 @@ static void split_svc_pos_state_ccc(const struct bt_gatt_attr *attr, uint16_t va
     LOG_DBG("value %d", value);
 }
 
+#if IS_ENABLED(CONFIG_ZMK_SPLIT_BLE_POSITION_BATCHING)
+static void split_svc_pos_batch_ccc(const struct bt_gatt_attr *attr, uint16_t value);
+#endif // IS_ENABLED(CONFIG_ZMK_SPLIT_BLE_POSITION_BATCHING)
+
 #if IS_ENABLED(CONFIG_ZMK_SPLIT_PERIPHERAL_HID_INDICATORS)
 
 static zmk_hid_indicators_t hid_indicators = 0;
@@ -226,6 +318,12 @@ BT_GATT_SERVICE_DEFINE(
                            split_svc_run_behavior, &behavior_run_payload),
     BT_GATT_DESCRIPTOR(BT_UUID_NUM_OF_DIGITALS, BT_GATT_PERM_READ, split_svc_num_of_positions, NULL,
                        &num_of_positions),
+#if IS_ENABLED(CONFIG_ZMK_SPLIT_BLE_BEHAVIOR_IDS)
+    BT_GATT_CHARACTERISTIC(BT_UUID_DECLARE_128(ZMK_SPLIT_BT_CHAR_BEHAVIOR_IDS_UUID),
+                           BT_GATT_CHRC_READ | BT_GATT_CHRC_WRITE_WITHOUT_RESP,
+                           BT_GATT_PERM_READ_ENCRYPT | BT_GATT_PERM_WRITE_ENCRYPT,
+                           split_svc_behavior_ids, split_svc_run_behavior_id, NULL),
+#endif // IS_ENABLED(CONFIG_ZMK_SPLIT_BLE_BEHAVIOR_IDS)
 #if ZMK_KEYMAP_HAS_SENSORS
     BT_GATT_CHARACTERISTIC(BT_UUID_DECLARE_128(ZMK_SPLIT_BT_CHAR_SENSOR_STATE_UUID),
                            BT_GATT_CHRC_READ | BT_GATT_CHRC_NOTIFY, BT_GATT_PERM_READ_ENCRYPT,
@@ -242,17 +340,206 @@ BT_GATT_SERVICE_DEFINE(
                            BT_GATT_CHRC_WRITE | BT_GATT_CHRC_READ,
                            BT_GATT_PERM_WRITE_ENCRYPT | BT_GATT_PERM_READ_ENCRYPT,
                            split_svc_get_selected_phys_layout, split_svc_select_phys_layout,
-                           NULL), );
+                           NULL),
+#if IS_ENABLED(CONFIG_ZMK_SPLIT_BLE_POSITION_BATCHING)
+    BT_GATT_CHARACTERISTIC(BT_UUID_DECLARE_128(ZMK_SPLIT_BT_CHAR_POSITION_BATCH_UUID),
+                           BT_GATT_CHRC_NOTIFY, BT_GATT_PERM_READ_ENCRYPT, NULL, NULL, NULL),
+    BT_GATT_CCC(split_svc_pos_batch_ccc, BT_GATT_PERM_READ_ENCRYPT | BT_GATT_PERM_WRITE_ENCRYPT),
+#endif // IS_ENABLED(CONFIG_ZMK_SPLIT_BLE_POSITION_BATCHING)
+);
 
 K_THREAD_STACK_DEFINE(service_q_stack, CONFIG_ZMK_SPLIT_BLE_PERIPHERAL_STACK_SIZE);
 
 struct k_work_q service_work_q;
 
-K_MSGQ_DEFINE(position_state_msgq, sizeof(char[POS_STATE_LEN]),
+#if IS_ENABLED(CONFIG_ZMK_SPLIT_BLE_POSITION_BATCHING)
+
+struct position_edge {
+    uint32_t timestamp;
+    uint8_t position_state;
+};
+
+K_MSGQ_DEFINE(position_edge_msgq, sizeof(struct position_edge),
+              CONFIG_ZMK_SPLIT_BLE_PERIPHERAL_POSITION_QUEUE_SIZE, 4);
+
+#define POSITION_RESYNC_RETRY_MS 20
+
+// Positions the central was last told are pressed. If a notification fails, the queued edges are
+// dropped and the central is instead sent the edges that differ between this and position_state.
+static uint8_t sent_position_state[POS_STATE_LEN];
+
+enum position_resync_flags {
+    // A notification failed, or the central subscribed again.
+    POSITION_RESYNC_NEEDED,
+    // The central released every position when it disconnected.
+    POSITION_RESYNC_CENTRAL_RELEASED,
+    POSITION_RESYNC_SUBSCRIBED,
+};
+
+static atomic_t position_resync_flags;
+
+void send_position_state_callback(struct k_work *work);
+
+K_WORK_DELAYABLE_DEFINE(service_position_notify_work, send_position_state_callback);
+
+static void split_svc_pos_batch_ccc(const struct bt_gatt_attr *attr, uint16_t value) {
+    LOG_DBG("value %d", value);
+
+    if (value & BT_GATT_CCC_NOTIFY) {
+        atomic_set_bit(&position_resync_flags, POSITION_RESYNC_SUBSCRIBED);
+        atomic_set_bit(&position_resync_flags, POSITION_RESYNC_NEEDED);
+        k_work_reschedule_for_queue(&service_work_q, &service_position_notify_work, K_NO_WAIT);
+    } else {
+        atomic_clear_bit(&position_resync_flags, POSITION_RESYNC_SUBSCRIBED);
+        atomic_set_bit(&position_resync_flags, POSITION_RESYNC_CENTRAL_RELEASED);
+    }
+}
+
+static int notify_position_batch(struct zmk_split_position_batch *batch, size_t count,
+                                 uint32_t last_timestamp) {
+    static const struct bt_gatt_attr *attr;
+    if (!attr) {
+        attr = bt_gatt_find_by_uuid(split_svc.attrs, split_svc.attr_count,
+                                    BT_UUID_DECLARE_128(ZMK_SPLIT_BT_CHAR_POSITION_BATCH_UUID));
+    }
+
+    batch->timestamp = last_timestamp;
+
+    int err = bt_gatt_notify(NULL, attr, batch,
+                             offsetof(struct zmk_split_position_batch, edges) +
+                                 count * sizeof(struct zmk_split_position_edge));
+    if (err) {
+        LOG_DBG("Error notifying %d", err);
+        atomic_set_bit(&position_resync_flags, POSITION_RESYNC_NEEDED);
+        return err;
+    }
+
+    for (int i = 0; i < count; i++) {
+        const uint8_t position = batch->edges[i].position_state & ~ZMK_SPLIT_POSITION_EDGE_PRESSED;
+
+        WRITE_BIT(sent_position_state[position / 8], position % 8,
+                  batch->edges[i].position_state & ZMK_SPLIT_POSITION_EDGE_PRESSED);
+    }
+
+    return 0;
+}
+
+// Sends an edge for each position whose state the central doesn't know about, all timestamped now.
+static int resync_positions(void) {
+    struct zmk_split_position_batch batch;
+    const uint32_t timestamp = (uint32_t)k_uptime_get();
+    size_t count = 0;
+
+    for (int i = 0; i < POS_STATE_LEN * 8; i++) {
+        const bool pressed = position_state[i / 8] & BIT(i % 8);
+
+        if (pressed == (bool)(sent_position_state[i / 8] & BIT(i % 8))) {
+            continue;
+        }
+
+        batch.edges[count] = (struct zmk_split_position_edge){
+            .position_state = i | (pressed ? ZMK_SPLIT_POSITION_EDGE_PRESSED : 0),
+        };
+
+        if (++count == ARRAY_SIZE(batch.edges)) {
+            int err = notify_position_batch(&batch, count, timestamp);
+            if (err) {
+                return err;
+            }
+            count = 0;
+        }
+    }
+
+    return count > 0 ? notify_position_batch(&batch, count, timestamp) : 0;
+}
+
+void send_position_state_callback(struct k_work *work) {
+    struct zmk_split_position_batch batch;
+    struct position_edge edge;
+    uint32_t last_timestamp = 0;
+    size_t count = 0;
+
+    if (atomic_test_and_clear_bit(&position_resync_flags, POSITION_RESYNC_CENTRAL_RELEASED)) {
+        memset(sent_position_state, 0, sizeof(sent_position_state));
+    }
+
+    while (!atomic_test_bit(&position_resync_flags, POSITION_RESYNC_NEEDED) &&
+           k_msgq_get(&position_edge_msgq, &edge, K_NO_WAIT) == 0) {
+        batch.edges[count] = (struct zmk_split_position_edge){
+            .position_state = edge.position_state,
+            .delta_ms = count == 0 ? 0 : MIN(edge.timestamp - last_timestamp, UINT8_MAX),
+        };
+        last_timestamp = edge.timestamp;
+
+        if (++count == ARRAY_SIZE(batch.edges)) {
+            notify_position_batch(&batch, count, last_timestamp);
+            count = 0;
+        }
+    }
+
+    if (count > 0) {
+        notify_position_batch(&batch, count, last_timestamp);
+    }
+
+    if (!atomic_test_bit(&position_resync_flags, POSITION_RESYNC_NEEDED)) {
+        return;
+    }
+
+    // position_state already includes every queued edge, so the queue can be dropped. It's drained
+    // before position_state is read, so any edge queued later is still sent on its own.
+    while (k_msgq_get(&position_edge_msgq, &edge, K_NO_WAIT) == 0) {
+    }
+
+    if (!atomic_test_bit(&position_resync_flags, POSITION_RESYNC_SUBSCRIBED)) {
+        // Resync once the central subscribes again.
+        return;
+    }
+
+    atomic_clear_bit(&position_resync_flags, POSITION_RESYNC_NEEDED);
+    if (resync_positions() < 0) {
+        LOG_WRN("Failed to resync key positions with the central, retrying");
+        k_work_reschedule_for_queue(&service_work_q, &service_position_notify_work,
+                                    K_MSEC(POSITION_RESYNC_RETRY_MS));
+    }
+};
+
+static int send_position_edge(uint8_t position, bool pressed, int64_t timestamp) {
+    struct position_edge edge = {
+        .timestamp = (uint32_t)timestamp,
+        .position_state = position | (pressed ? ZMK_SPLIT_POSITION_EDGE_PRESSED : 0),
+    };
+
+    int err = k_msgq_put(&position_edge_msgq, &edge, K_NO_WAIT);
+    if (err == -ENOMSG) {
+        // Dropping an edge would leave the central out of sync, so flush what is queued now and
+        // wait for room instead.
+        k_work_reschedule_for_queue(&service_work_q, &service_position_notify_work, K_NO_WAIT);
+        err = k_msgq_put(&position_edge_msgq, &edge, K_MSEC(100));
+    }
+
+    if (err) {
+        LOG_WRN("Failed to queue position edge to send (%d)", err);
+        return err;
+    }
+
+    // Start the batch window on the first edge, and send right away once a batch is full.
+    if (k_msgq_num_used_get(&position_edge_msgq) >= ZMK_SPLIT_POSITION_BATCH_MAX_EDGES) {
+        k_work_reschedule_for_queue(&service_work_q, &service_position_notify_work, K_NO_WAIT);
+    } else {
+        k_work_schedule_for_queue(&service_work_q, &service_position_notify_work,
+                                  K_MSEC(CONFIG_ZMK_SPLIT_BLE_POSITION_BATCH_WINDOW_MS));
+    }
+
+    return 0;
+}
+
+#else
+
+K_MSGQ_DEFINE(position_state_msgq, sizeof(struct zmk_split_position_state_payload),
               CONFIG_ZMK_SPLIT_BLE_PERIPHERAL_POSITION_QUEUE_SIZE, 4);
 
 void send_position_state_callback(struct k_work *work) {
-    uint8_t state[POS_STATE_LEN];
+    struct zmk_split_position_state_payload state;
 
     while (k_msgq_get(&position_state_msgq, &state, K_NO_WAIT) == 0) {
         int err = bt_gatt_notify(NULL, &split_svc.attrs[1], &state, sizeof(state));
@@ -264,15 +551,18 @@ void send_position_state_callback(struct k_work *work) {
 
 K_WORK_DEFINE(service_position_notify_work, send_position_state_callback);
 
-int send_position_state() {
-    int err = k_msgq_put(&position_state_msgq, position_state, K_MSEC(100));
+int send_position_state(int64_t timestamp) {
+    struct zmk_split_position_state_payload state = {.timestamp = (uint32_t)timestamp};
+    memcpy(state.position_state, position_state, sizeof(position_state));
+
+    int err = k_msgq_put(&position_state_msgq, &state, K_MSEC(100));
     if (err) {
         switch (err) {
         case -EAGAIN: {
             LOG_WRN("Position state message queue full, popping first message and queueing again");
-            uint8_t discarded_state[POS_STATE_LEN];
+            struct zmk_split_position_state_payload discarded_state;
             k_msgq_get(&position_state_msgq, &discarded_state, K_NO_WAIT);
-            return send_position_state();
+            return send_position_state(timestamp);
         }
         default:
             LOG_WRN("Failed to queue position state to send (%d)", err);
@@ -285,14 +575,24 @@ int send_position_state() {
     return 0;
 }
 
-int zmk_split_bt_position_pressed(uint8_t position) {
+#endif // IS_ENABLED(CONFIG_ZMK_SPLIT_BLE_POSITION_BATCHING)
+
+int zmk_split_bt_position_pressed(uint8_t position, int64_t timestamp) {
     WRITE_BIT(position_state[position / 8], position % 8, true);
-    return send_position_state();
+#if IS_ENABLED(CONFIG_ZMK_SPLIT_BLE_POSITION_BATCHING)
+    return send_position_edge(position, true, timestamp);
+#else
+    return send_position_state(timestamp);
+#endif
 }
 
-int zmk_split_bt_position_released(uint8_t position) {
+int zmk_split_bt_position_released(uint8_t position, int64_t timestamp) {
     WRITE_BIT(position_state[position / 8], position % 8, false);
-    return send_position_state();
+#if IS_ENABLED(CONFIG_ZMK_SPLIT_BLE_POSITION_BATCHING)
+    return send_position_edge(position, false, timestamp);
+#else
+    return send_position_state(timestamp);
+#endif
 }
 
 #if ZMK_KEYMAP_HAS_SENSORS
@@ -349,26 +649,235 @@ int zmk_split_bt_sensor_triggered(uint8_t sensor_index,
 
 #if IS_ENABLED(CONFIG_ZMK_INPUT_SPLIT)
 
-int zmk_split_bt_report_input(uint8_t reg, uint8_t type, uint16_t code, int32_t value, bool sync) {
-
+static const struct bt_gatt_attr *find_input_split_attr(uint8_t reg) {
     for (size_t i = 0; i < split_svc.attr_count; i++) {
         if (bt_uuid_cmp(split_svc.attrs[i].uuid,
                         BT_UUID_DECLARE_128(ZMK_SPLIT_BT_INPUT_EVENT_UUID)) == 0 &&
             (uint8_t)(uint32_t)split_svc.attrs[i + 2].user_data == reg) {
-            struct zmk_split_input_event_payload payload = {
-                .type = type,
-                .code = code,
-                .value = value,
-                .sync = sync ? 1 : 0,
+            return &split_svc.attrs[i];
+        }
+    }
+
+    return NULL;
+}
+
+#if IS_ENABLED(CONFIG_ZMK_SPLIT_BLE_PERIPHERAL_INPUT_FRAMES)
+
+#define INPUT_QUEUE_SIZE CONFIG_ZMK_SPLIT_BLE_PERIPHERAL_INPUT_QUEUE_SIZE
+#define INPUT_NOTIFY_MAX_EVENTS                                                                    \
+    ((CONFIG_BT_L2CAP_TX_MTU - 3) / sizeof(struct zmk_split_input_event_payload))
+
+struct input_split_queue {
+    uint8_t reg;
+    const struct bt_gatt_attr *attr;
+    struct k_spinlock lock;
+    // Ring of events waiting to be sent. The first `ready` of them make up complete frames.
+    struct zmk_split_input_event_payload events[INPUT_QUEUE_SIZE];
+    uint16_t head;
+    uint16_t len;
+    uint16_t ready;
+};
+
+#define INPUT_SPLIT_QUEUE(node_id) {.reg = DT_REG_ADDR(node_id)},
+
+static struct input_split_queue input_queues[] = {
+    DT_FOREACH_STATUS_OKAY(zmk_input_split, INPUT_SPLIT_QUEUE)};
+
+static K_SEM_DEFINE(input_queue_space_sem, 0, 1);
+
+static void send_input_events_callback(struct k_work *work);
+
+K_WORK_DEFINE(service_input_notify_work, send_input_events_callback);
+
+static void input_notify_sent(struct bt_conn *conn, void *user_data) {
+    // A notification buffer was freed, so send anything that didn't fit before.
+    k_work_submit_to_queue(&service_work_q, &service_input_notify_work);
+}
+
+static void min_mtu_cb(struct bt_conn *conn, void *user_data) {
+    uint16_t *mtu = user_data;
+    uint16_t conn_mtu = bt_gatt_get_mtu(conn);
+
+    if (conn_mtu > 0) {
+        *mtu = MIN(*mtu, conn_mtu);
+    }
+}
+
+// Returns the number of events from the front of the queue to send in one notification. Frames
+// are kept whole unless a single frame doesn't fit.
+static size_t input_queue_take_count(const struct input_split_queue *queue, size_t max_events) {
+    size_t count = MIN(queue->ready, max_events);
+
+    if (count < queue->ready) {
+        for (size_t n = count; n > 0; n--) {
+            if (queue->events[(queue->head + n - 1) % INPUT_QUEUE_SIZE].sync) {
+                return n;
+            }
+        }
+    }
+
+    return count;
+}
+
+static void send_input_events_callback(struct k_work *work) {
+    static struct zmk_split_input_event_payload buf[INPUT_NOTIFY_MAX_EVENTS];
+
+    uint16_t mtu = UINT16_MAX;
+    bt_conn_foreach(BT_CONN_TYPE_LE, min_mtu_cb, &mtu);
+
+    // If nothing is connected, the notify fails below and the queued events are discarded.
+    const size_t max_events =
+        mtu == UINT16_MAX ? ARRAY_SIZE(buf)
+                          : MIN((mtu - 3) / sizeof(struct zmk_split_input_event_payload),
+                                ARRAY_SIZE(buf));
+
+    for (size_t i = 0; i < ARRAY_SIZE(input_queues); i++) {
+        struct input_split_queue *queue = &input_queues[i];
+
+        while (true) {
+            k_spinlock_key_t key = k_spin_lock(&queue->lock);
+            const size_t count = input_queue_take_count(queue, max_events);
+            for (size_t j = 0; j < count; j++) {
+                buf[j] = queue->events[(queue->head + j) % INPUT_QUEUE_SIZE];
+            }
+            k_spin_unlock(&queue->lock, key);
+
+            if (count == 0) {
+                break;
+            }
+
+            struct bt_gatt_notify_params params = {
+                .attr = queue->attr,
+                .data = buf,
+                .len = count * sizeof(struct zmk_split_input_event_payload),
+                .func = input_notify_sent,
             };
 
-            return bt_gatt_notify(NULL, &split_svc.attrs[i], &payload, sizeof(payload));
+            int err = bt_gatt_notify_cb(NULL, &params);
+            if (err == -ENOMEM) {
+                // Out of notification buffers. Keep the events and retry once one is sent.
+                return;
+            } else if (err) {
+                LOG_DBG("Error notifying %d", err);
+            }
+
+            key = k_spin_lock(&queue->lock);
+            queue->head = (queue->head + count) % INPUT_QUEUE_SIZE;
+            queue->len -= count;
+            queue->ready -= count;
+            k_spin_unlock(&queue->lock, key);
+
+            k_sem_give(&input_queue_space_sem);
+        }
+    }
+}
+
+int zmk_split_bt_report_input(uint8_t reg, uint8_t type, uint16_t code, int32_t value, bool sync) {
+    struct input_split_queue *queue = NULL;
+    for (size_t i = 0; i < ARRAY_SIZE(input_queues); i++) {
+        if (input_queues[i].reg == reg) {
+            queue = &input_queues[i];
+            break;
         }
     }
-    return -ENODEV;
+
+    if (!queue || !queue->attr) {
+        return -ENODEV;
+    }
+
+    struct zmk_split_input_event_payload payload = {
+        .type = type,
+        .code = code,
+        .value = value,
+        .sync = sync ? 1 : 0,
+    };
+
+    k_spinlock_key_t key = k_spin_lock(&queue->lock);
+
+    while (queue->len == INPUT_QUEUE_SIZE) {
+        // Dropping an event would lose motion on the central, so wait for room instead.
+        k_spin_unlock(&queue->lock, key);
+
+        if (k_sem_take(&input_queue_space_sem, K_MSEC(100)) != 0) {
+            LOG_WRN("Input event queue full, dropping event");
+            return -EAGAIN;
+        }
+
+        key = k_spin_lock(&queue->lock);
+    }
+
+    queue->events[(queue->head + queue->len) % INPUT_QUEUE_SIZE] = payload;
+    queue->len++;
+
+    // Send once the frame is complete, or once the queue can't hold any more of it.
+    const bool send = sync || queue->len == INPUT_QUEUE_SIZE;
+    if (send) {
+        queue->ready = queue->len;
+    }
+
+    k_spin_unlock(&queue->lock, key);
+
+    if (send) {
+        k_work_submit_to_queue(&service_work_q, &service_input_notify_work);
+    }
+
+    return 0;
 }
 
+#else
+
+int zmk_split_bt_report_input(uint8_t reg, uint8_t type, uint16_t code, int32_t value, bool sync) {
+    const struct bt_gatt_attr *attr = find_input_split_attr(reg);
+    if (!attr) {
+        return -ENODEV;
+    }
+
+    struct zmk_split_input_event_payload payload = {
+        .type = type,
+        .code = code,
+        .value = value,
+        .sync = sync ? 1 : 0,
+    };
+
+    return bt_gatt_notify(NULL, attr, &payload, sizeof(payload));
+}
+
+#endif // IS_ENABLED(CONFIG_ZMK_SPLIT_BLE_PERIPHERAL_INPUT_FRAMES)
+
+#endif /* IS_ENABLED(CONFIG_ZMK_INPUT_SPLIT) */
+
+static int split_peripheral_bt_report_event(const struct zmk_split_transport_peripheral_event *ev) {
+    switch (ev->type) {
+    case ZMK_SPLIT_TRANSPORT_PERIPHERAL_EVENT_TYPE_KEY_POSITION_EVENT:
+        if (ev->data.key_position_event.pressed) {
+            return zmk_split_bt_position_pressed(ev->data.key_position_event.position,
+                                                 ev->data.key_position_event.timestamp);
+        } else {
+            return zmk_split_bt_position_released(ev->data.key_position_event.position,
+                                                  ev->data.key_position_event.timestamp);
+        }
+#if ZMK_KEYMAP_HAS_SENSORS
+    case ZMK_SPLIT_TRANSPORT_PERIPHERAL_EVENT_TYPE_SENSOR_EVENT:
+        return zmk_split_bt_sensor_triggered(ev->data.sensor_event.sensor_index,
+                                             ev->data.sensor_event.channel_data,
+                                             ev->data.sensor_event.channel_data_size);
+#endif /* ZMK_KEYMAP_HAS_SENSORS */
+#if IS_ENABLED(CONFIG_ZMK_INPUT_SPLIT)
+    case ZMK_SPLIT_TRANSPORT_PERIPHERAL_EVENT_TYPE_INPUT_EVENT:
+        return zmk_split_bt_report_input(ev->data.input_event.reg, ev->data.input_event.type,
+                                         ev->data.input_event.code, ev->data.input_event.value,
+                                         ev->data.input_event.sync);
 #endif /* IS_ENABLED(CONFIG_ZMK_INPUT_SPLIT) */
+    default:
+        return -ENOTSUP;
+    }
+}
+
+static const struct zmk_split_transport_peripheral_api bt_peripheral_api = {
+    .report_event = split_peripheral_bt_report_event,
+};
+
+ZMK_SPLIT_TRANSPORT_PERIPHERAL_REGISTER(bt_peripheral, &bt_peripheral_api);
 
 static int service_init(void) {
     static const struct k_work_queue_config queue_config = {
@@ -376,6 +885,12 @@ static int service_init(void) {
     k_work_queue_start(&service_work_q, service_q_stack, K_THREAD_STACK_SIZEOF(service_q_stack),
                        CONFIG_ZMK_SPLIT_BLE_PERIPHERAL_PRIORITY, &queue_config);
 
+#if IS_ENABLED(CONFIG_ZMK_SPLIT_BLE_PERIPHERAL_INPUT_FRAMES)
+    for (size_t i = 0; i < ARRAY_SIZE(input_queues); i++) {
+        input_queues[i].attr = find_input_split_attr(input_queues[i].reg);
+    }
+#endif // IS_ENABLED(CONFIG_ZMK_SPLIT_BLE_PERIPHERAL_INPUT_FRAMES)
+
     return 0;
 }
 
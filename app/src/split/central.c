@@ -0,0 +1,158 @@
+/*
+ * Copyright (c) 2024 The ZMK Contributors
+ *
+ * SPDX-License-Identifier: MIT
+ */
+
+#include <zephyr/kernel.h>
+#include <zephyr/sys/iterable_sections.h>
+
+#include <zephyr/logging/log.h>
+
+LOG_MODULE_DECLARE(zmk, CONFIG_ZMK_LOG_LEVEL);
+
+#include <zmk/behavior.h>
+#include <zmk/endpoints.h>
+#include <zmk/event_manager.h>
+#include <zmk/events/position_state_changed.h>
+#include <zmk/events/sensor_event.h>
+#include <zmk/pointing/input_split.h>
+#include <zmk/split/central.h>
+#include <zmk/split/transport/central.h>
+
+struct peripheral_event_msg {
+    uint8_t source;
+    struct zmk_split_transport_peripheral_event ev;
+};
+
+K_MSGQ_DEFINE(peripheral_event_msgq, sizeof(struct peripheral_event_msg),
+              CONFIG_ZMK_SPLIT_CENTRAL_EVENT_QUEUE_SIZE, 4);
+
+static void raise_peripheral_event(const struct peripheral_event_msg *msg) {
+    const struct zmk_split_transport_peripheral_event *ev = &msg->ev;
+
+    switch (ev->type) {
+    case ZMK_SPLIT_TRANSPORT_PERIPHERAL_EVENT_TYPE_KEY_POSITION_EVENT:
+        LOG_DBG("Trigger key position state change for %d", ev->data.key_position_event.position);
+        raise_zmk_position_state_changed((struct zmk_position_state_changed){
+            .source = msg->source,
+            .position = ev->data.key_position_event.position,
+            .state = ev->data.key_position_event.pressed != 0,
+            .timestamp = k_uptime_get(),
+        });
+        break;
+#if ZMK_KEYMAP_HAS_SENSORS
+    case ZMK_SPLIT_TRANSPORT_PERIPHERAL_EVENT_TYPE_SENSOR_EVENT: {
+        struct zmk_sensor_event sensor_ev = {
+            .sensor_index = ev->data.sensor_event.sensor_index,
+            .channel_data_size =
+                MIN(ev->data.sensor_event.channel_data_size, ZMK_SENSOR_EVENT_MAX_CHANNELS),
+            .timestamp = k_uptime_get(),
+        };
+
+        memcpy(sensor_ev.channel_data, ev->data.sensor_event.channel_data,
+               sizeof(struct zmk_sensor_channel_data) * sensor_ev.channel_data_size);
+        LOG_DBG("Trigger sensor change for %d", sensor_ev.sensor_index);
+        raise_zmk_sensor_event(sensor_ev);
+        break;
+    }
+#endif // ZMK_KEYMAP_HAS_SENSORS
+#if IS_ENABLED(CONFIG_ZMK_INPUT_SPLIT)
+    case ZMK_SPLIT_TRANSPORT_PERIPHERAL_EVENT_TYPE_INPUT_EVENT: {
+        int ret = zmk_input_split_report_peripheral_event(
+            ev->data.input_event.reg, ev->data.input_event.type, ev->data.input_event.code,
+            ev->data.input_event.value, ev->data.input_event.sync);
+        if (ret < 0) {
+            LOG_WRN("Failed to report peripheral event %d", ret);
+        }
+        break;
+    }
+#endif // IS_ENABLED(CONFIG_ZMK_INPUT_SPLIT)
+    default:
+        LOG_WRN("Unsupported peripheral event type %d", ev->type);
+        break;
+    }
+}
+
+static void peripheral_event_work_callback(struct k_work *work) {
+    struct peripheral_event_msg msg;
+
+    zmk_endpoints_report_transaction_begin();
+
+    while (k_msgq_get(&peripheral_event_msgq, &msg, K_NO_WAIT) == 0) {
+        raise_peripheral_event(&msg);
+    }
+
+    zmk_endpoints_report_transaction_end();
+}
+
+static K_WORK_DEFINE(peripheral_event_work, peripheral_event_work_callback);
+
+int zmk_split_transport_central_peripheral_event_handler(
+    const struct zmk_split_transport_central *transport, uint8_t source,
+    struct zmk_split_transport_peripheral_event ev) {
+    struct peripheral_event_msg msg = {.source = source, .ev = ev};
+
+    int err = k_msgq_put(&peripheral_event_msgq, &msg, K_NO_WAIT);
+    if (err < 0) {
+        LOG_WRN("Dropping event from peripheral %d, queue is full", source);
+        return err;
+    }
+
+    k_work_submit(&peripheral_event_work);
+
+    return 0;
+}
+
+static int send_command(uint8_t source, struct zmk_split_transport_central_command cmd) {
+    int ret = -ENODEV;
+
+    STRUCT_SECTION_FOREACH(zmk_split_transport_central, transport) {
+        ret = transport->api->send_command(source, cmd);
+        if (ret >= 0) {
+            break;
+        }
+    }
+
+    return ret;
+}
+
+int zmk_split_central_invoke_behavior(uint8_t source, struct zmk_behavior_binding *binding,
+                                      struct zmk_behavior_binding_event event, bool state) {
+    struct zmk_split_transport_central_command cmd = {
+        .type = ZMK_SPLIT_TRANSPORT_CENTRAL_CMD_TYPE_INVOKE_BEHAVIOR,
+        .data.invoke_behavior =
+            {
+                .param1 = binding->param1,
+                .param2 = binding->param2,
+                .position = event.position,
+                .state = state ? 1 : 0,
+            },
+    };
+
+    const size_t dev_size = sizeof(cmd.data.invoke_behavior.behavior_dev);
+    if (strlcpy(cmd.data.invoke_behavior.behavior_dev, binding->behavior_dev, dev_size) >=
+        dev_size) {
+        LOG_ERR("Truncated behavior label %s to %s before invoking peripheral behavior",
+                binding->behavior_dev, cmd.data.invoke_behavior.behavior_dev);
+    }
+
+    return send_command(source, cmd);
+}
+
+int zmk_split_central_update_hid_indicator(zmk_hid_indicators_t indicators) {
+    struct zmk_split_transport_central_command cmd = {
+        .type = ZMK_SPLIT_TRANSPORT_CENTRAL_CMD_TYPE_SET_HID_INDICATORS,
+        .data.set_hid_indicators = {.indicators = indicators},
+    };
+    int ret = 0;
+
+    for (uint8_t source = 0; source < ZMK_SPLIT_CENTRAL_PERIPHERAL_COUNT; source++) {
+        int err = send_command(source, cmd);
+        if (err < 0) {
+            ret = err;
+        }
+    }
+
+    return ret;
+}
@@ -0,0 +1,153 @@
+/*
+ * Copyright (c) 2024 The ZMK Contributors
+ *
+ * SPDX-License-Identifier: MIT
+ */
+
+#include <zephyr/kernel.h>
+#include <zephyr/sys/iterable_sections.h>
+
+#include <zephyr/logging/log.h>
+
+LOG_MODULE_DECLARE(zmk, CONFIG_ZMK_LOG_LEVEL);
+
+#include <drivers/behavior.h>
+#include <zmk/behavior.h>
+#include <zmk/event_manager.h>
+#include <zmk/events/position_state_changed.h>
+#include <zmk/events/sensor_event.h>
+#include <zmk/physical_layouts.h>
+#include <zmk/sensors.h>
+#include <zmk/split/peripheral.h>
+#include <zmk/split/transport/peripheral.h>
+
+#if IS_ENABLED(CONFIG_ZMK_SPLIT_PERIPHERAL_HID_INDICATORS)
+#include <zmk/events/hid_indicators_changed.h>
+#endif // IS_ENABLED(CONFIG_ZMK_SPLIT_PERIPHERAL_HID_INDICATORS)
+
+static int report_event(const struct zmk_split_transport_peripheral_event *ev) {
+    int ret = -ENODEV;
+
+    STRUCT_SECTION_FOREACH(zmk_split_transport_peripheral, transport) {
+        ret = transport->api->report_event(ev);
+        if (ret >= 0) {
+            break;
+        }
+    }
+
+    return ret;
+}
+
+int zmk_split_peripheral_report_input(uint8_t reg, uint8_t type, uint16_t code, int32_t value,
+                                      bool sync) {
+    struct zmk_split_transport_peripheral_event ev = {
+        .type = ZMK_SPLIT_TRANSPORT_PERIPHERAL_EVENT_TYPE_INPUT_EVENT,
+        .data.input_event =
+            {
+                .reg = reg,
+                .type = type,
+                .code = code,
+                .value = value,
+                .sync = sync ? 1 : 0,
+            },
+    };
+
+    return report_event(&ev);
+}
+
+static int invoke_behavior(struct zmk_split_transport_central_command *cmd) {
+    struct zmk_behavior_binding binding = {
+        .param1 = cmd->data.invoke_behavior.param1,
+        .param2 = cmd->data.invoke_behavior.param2,
+        .behavior_dev = cmd->data.invoke_behavior.behavior_dev,
+    };
+    struct zmk_behavior_binding_event event = {
+        .position = cmd->data.invoke_behavior.position,
+        .timestamp = k_uptime_get(),
+    };
+
+    // The name may fill the whole field, so make sure it is terminated.
+    cmd->data.invoke_behavior.behavior_dev[ZMK_SPLIT_TRANSPORT_BEHAVIOR_DEV_LEN - 1] = '\0';
+
+    LOG_DBG("%s with params %d %d: pressed? %d", binding.behavior_dev, binding.param1,
+            binding.param2, cmd->data.invoke_behavior.state);
+
+    int err;
+    if (cmd->data.invoke_behavior.state > 0) {
+        err = behavior_keymap_binding_pressed(&binding, event);
+    } else {
+        err = behavior_keymap_binding_released(&binding, event);
+    }
+
+    if (err) {
+        LOG_ERR("Failed to invoke behavior %s: %d", binding.behavior_dev, err);
+    }
+
+    return err;
+}
+
+int zmk_split_transport_peripheral_command_handler(
+    const struct zmk_split_transport_peripheral *transport,
+    struct zmk_split_transport_central_command cmd) {
+    switch (cmd.type) {
+    case ZMK_SPLIT_TRANSPORT_CENTRAL_CMD_TYPE_INVOKE_BEHAVIOR:
+        return invoke_behavior(&cmd);
+    case ZMK_SPLIT_TRANSPORT_CENTRAL_CMD_TYPE_SET_PHYSICAL_LAYOUT:
+        LOG_DBG("Selecting physical layout %d", cmd.data.set_physical_layout.layout_idx);
+        return zmk_physical_layouts_select(cmd.data.set_physical_layout.layout_idx);
+#if IS_ENABLED(CONFIG_ZMK_SPLIT_PERIPHERAL_HID_INDICATORS)
+    case ZMK_SPLIT_TRANSPORT_CENTRAL_CMD_TYPE_SET_HID_INDICATORS:
+        LOG_DBG("Raising HID indicators changed event: %x",
+                cmd.data.set_hid_indicators.indicators);
+        return raise_zmk_hid_indicators_changed((struct zmk_hid_indicators_changed){
+            .indicators = cmd.data.set_hid_indicators.indicators});
+#endif // IS_ENABLED(CONFIG_ZMK_SPLIT_PERIPHERAL_HID_INDICATORS)
+    default:
+        LOG_WRN("Unsupported central command type %d", cmd.type);
+        return -ENOTSUP;
+    }
+}
+
+static int split_listener(const zmk_event_t *eh) {
+    LOG_DBG("");
+    const struct zmk_position_state_changed *pos_ev;
+    if ((pos_ev = as_zmk_position_state_changed(eh)) != NULL) {
+        struct zmk_split_transport_peripheral_event ev = {
+            .type = ZMK_SPLIT_TRANSPORT_PERIPHERAL_EVENT_TYPE_KEY_POSITION_EVENT,
+            .data.key_position_event =
+                {
+                    .position = pos_ev->position,
+                    .pressed = pos_ev->state ? 1 : 0,
+                    .timestamp = (uint32_t)pos_ev->timestamp,
+                },
+        };
+        return report_event(&ev);
+    }
+
+#if ZMK_KEYMAP_HAS_SENSORS
+    const struct zmk_sensor_event *sensor_ev;
+    if ((sensor_ev = as_zmk_sensor_event(eh)) != NULL) {
+        struct zmk_split_transport_peripheral_event ev = {
+            .type = ZMK_SPLIT_TRANSPORT_PERIPHERAL_EVENT_TYPE_SENSOR_EVENT,
+            .data.sensor_event =
+                {
+                    .sensor_index = sensor_ev->sensor_index,
+                    .channel_data_size =
+                        MIN(sensor_ev->channel_data_size, ZMK_SENSOR_EVENT_MAX_CHANNELS),
+                },
+        };
+
+        memcpy(ev.data.sensor_event.channel_data, sensor_ev->channel_data,
+               sizeof(struct zmk_sensor_channel_data) * ev.data.sensor_event.channel_data_size);
+        return report_event(&ev);
+    }
+#endif /* ZMK_KEYMAP_HAS_SENSORS */
+    return ZMK_EV_EVENT_BUBBLE;
+}
+
+ZMK_LISTENER(split_listener, split_listener);
+ZMK_SUBSCRIPTION(split_listener, zmk_position_state_changed);
+
+#if ZMK_KEYMAP_HAS_SENSORS
+ZMK_SUBSCRIPTION(split_listener, zmk_sensor_event);
+#endif /* ZMK_KEYMAP_HAS_SENSORS */
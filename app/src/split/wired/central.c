@@ -0,0 +1,293 @@
+/*
+ * Copyright (c) 2024 The ZMK Contributors
+ *
+ * SPDX-License-Identifier: MIT
+ */
+
+#include <string.h>
+
+#include <zephyr/init.h>
+#include <zephyr/kernel.h>
+
+#include <zephyr/logging/log.h>
+
+LOG_MODULE_DECLARE(zmk, CONFIG_ZMK_LOG_LEVEL);
+
+#include <zmk/behavior.h>
+#include <zmk/event_manager.h>
+#include <zmk/physical_layouts.h>
+#include <zmk/split/transport/central.h>
+
+#if IS_ENABLED(CONFIG_ZMK_SPLIT_PERIPHERAL_HID_INDICATORS)
+#include <zmk/hid_indicators.h>
+#endif // IS_ENABLED(CONFIG_ZMK_SPLIT_PERIPHERAL_HID_INDICATORS)
+
+#include "wired.h"
+
+static size_t command_size(const struct zmk_split_transport_central_command *cmd) {
+    const size_t header = offsetof(struct zmk_split_transport_central_command, data);
+
+    switch (cmd->type) {
+    case ZMK_SPLIT_TRANSPORT_CENTRAL_CMD_TYPE_INVOKE_BEHAVIOR:
+        return header + sizeof(cmd->data.invoke_behavior);
+    case ZMK_SPLIT_TRANSPORT_CENTRAL_CMD_TYPE_SET_PHYSICAL_LAYOUT:
+        return header + sizeof(cmd->data.set_physical_layout);
+    case ZMK_SPLIT_TRANSPORT_CENTRAL_CMD_TYPE_SET_HID_INDICATORS:
+        return header + sizeof(cmd->data.set_hid_indicators);
+    default:
+        return sizeof(*cmd);
+    }
+}
+
+#if IS_ENABLED(CONFIG_ZMK_SPLIT_WIRED_BEHAVIOR_IDS)
+
+struct peripheral_behavior_id {
+    const struct device *behavior;
+    zmk_behavior_local_id_t id;
+};
+
+// Behaviors that can be invoked on the peripheral by ID. Entries are filled in as the peripheral
+// sends them, and only used once the whole list has arrived.
+static struct peripheral_behavior_id behavior_ids[CONFIG_ZMK_SPLIT_WIRED_CENTRAL_BEHAVIOR_IDS_MAX];
+static uint8_t behavior_ids_len;
+static uint8_t behavior_ids_received;
+// Set when the peripheral may have (re)started, so the next sync asks for its behavior IDs.
+static bool behavior_ids_stale = true;
+
+static void handle_behavior_id(const uint8_t *payload, uint8_t len) {
+    if (len == 0) {
+        LOG_DBG("Peripheral runs %d behaviors by ID", behavior_ids_received);
+        behavior_ids_len = behavior_ids_received;
+        return;
+    }
+
+    struct zmk_split_wired_behavior_id entry;
+    char name[ZMK_SPLIT_WIRED_MAX_PAYLOAD + 1];
+
+    if (len <= sizeof(entry)) {
+        return;
+    }
+
+    const uint8_t name_len = len - sizeof(entry);
+
+    memcpy(&entry, payload, sizeof(entry));
+    memcpy(name, payload + sizeof(entry), name_len);
+    name[name_len] = '\0';
+
+    // Only behaviors this central also has can be invoked on the peripheral.
+    const struct device *behavior = zmk_behavior_get_binding(name);
+    if (!behavior) {
+        return;
+    }
+
+    if (behavior_ids_received >= ARRAY_SIZE(behavior_ids)) {
+        LOG_WRN("No room for the ID of behavior %s, it will be invoked by name", name);
+        return;
+    }
+
+    behavior_ids[behavior_ids_received++] = (struct peripheral_behavior_id){
+        .behavior = behavior,
+        .id = entry.behavior_id,
+    };
+}
+
+static void request_behavior_ids(void) {
+    behavior_ids_len = 0;
+    behavior_ids_received = 0;
+    zmk_split_wired_send(ZMK_SPLIT_WIRED_FRAME_KIND_BEHAVIOR_IDS_REQUEST, NULL, 0);
+}
+
+static int invoke_behavior_by_id(const struct zmk_split_transport_central_command *cmd) {
+    const struct zmk_behavior_binding binding = {
+        .behavior_dev = cmd->data.invoke_behavior.behavior_dev,
+    };
+    const struct device *behavior = zmk_behavior_get_binding_device(&binding);
+
+    for (int i = 0; i < behavior_ids_len; i++) {
+        if (behavior_ids[i].behavior != behavior) {
+            continue;
+        }
+
+        struct zmk_split_wired_invoke_behavior_id invoke = {
+            .param1 = cmd->data.invoke_behavior.param1,
+            .param2 = cmd->data.invoke_behavior.param2,
+            .position = cmd->data.invoke_behavior.position,
+            .state = cmd->data.invoke_behavior.state,
+            .behavior_id = behavior_ids[i].id,
+        };
+
+        return zmk_split_wired_send(ZMK_SPLIT_WIRED_FRAME_KIND_INVOKE_BEHAVIOR_ID, &invoke,
+                                    sizeof(invoke));
+    }
+
+    return -ENODEV;
+}
+
+#endif // IS_ENABLED(CONFIG_ZMK_SPLIT_WIRED_BEHAVIOR_IDS)
+
+// There is only one peripheral on the other end of the UART, with source index 0.
+static int wired_central_send_command(uint8_t source,
+                                      struct zmk_split_transport_central_command cmd) {
+    if (source != 0) {
+        return -EINVAL;
+    }
+
+#if IS_ENABLED(CONFIG_ZMK_SPLIT_WIRED_BEHAVIOR_IDS)
+    if (cmd.type == ZMK_SPLIT_TRANSPORT_CENTRAL_CMD_TYPE_INVOKE_BEHAVIOR) {
+        int err = invoke_behavior_by_id(&cmd);
+        if (err != -ENODEV) {
+            return err;
+        }
+    }
+#endif // IS_ENABLED(CONFIG_ZMK_SPLIT_WIRED_BEHAVIOR_IDS)
+
+    return zmk_split_wired_send(ZMK_SPLIT_WIRED_FRAME_KIND_COMMAND, &cmd, command_size(&cmd));
+}
+
+static const struct zmk_split_transport_central_api wired_central_api = {
+    .send_command = wired_central_send_command,
+};
+
+ZMK_SPLIT_TRANSPORT_CENTRAL_REGISTER(wired_central, &wired_central_api);
+
+// Sends the state a peripheral needs to process key presses correctly. Runs at boot, whenever the
+// peripheral says it has (re)started or the link comes back up, and whenever the selected physical
+// layout changes.
+static void sync_peripheral_work_cb(struct k_work *work) {
+    int layout = zmk_physical_layouts_get_selected();
+    if (layout >= 0) {
+        wired_central_send_command(
+            0, (struct zmk_split_transport_central_command){
+                   .type = ZMK_SPLIT_TRANSPORT_CENTRAL_CMD_TYPE_SET_PHYSICAL_LAYOUT,
+                   .data.set_physical_layout = {.layout_idx = (uint8_t)layout},
+               });
+    }
+
+#if IS_ENABLED(CONFIG_ZMK_SPLIT_PERIPHERAL_HID_INDICATORS)
+    wired_central_send_command(
+        0, (struct zmk_split_transport_central_command){
+               .type = ZMK_SPLIT_TRANSPORT_CENTRAL_CMD_TYPE_SET_HID_INDICATORS,
+               .data.set_hid_indicators = {.indicators = zmk_hid_indicators_get_current_profile()},
+           });
+#endif // IS_ENABLED(CONFIG_ZMK_SPLIT_PERIPHERAL_HID_INDICATORS)
+
+#if IS_ENABLED(CONFIG_ZMK_SPLIT_WIRED_BEHAVIOR_IDS)
+    if (behavior_ids_stale) {
+        behavior_ids_stale = false;
+        request_behavior_ids();
+    }
+#endif // IS_ENABLED(CONFIG_ZMK_SPLIT_WIRED_BEHAVIOR_IDS)
+}
+
+static K_WORK_DEFINE(sync_peripheral_work, sync_peripheral_work_cb);
+
+// Positions the peripheral has reported pressed, so they can be released if it restarts or the
+// link goes down before it reports them released.
+static uint8_t held_positions[DIV_ROUND_UP(UINT8_MAX + 1, 8)];
+static bool link_up;
+
+static void release_held_positions(void) {
+    for (int i = 0; i < sizeof(held_positions) * 8; i++) {
+        if (!(held_positions[i / 8] & BIT(i % 8))) {
+            continue;
+        }
+
+        struct zmk_split_transport_peripheral_event ev = {
+            .type = ZMK_SPLIT_TRANSPORT_PERIPHERAL_EVENT_TYPE_KEY_POSITION_EVENT,
+            .data.key_position_event = {.position = i, .pressed = 0},
+        };
+        zmk_split_transport_central_peripheral_event_handler(&wired_central, 0, ev);
+    }
+
+    memset(held_positions, 0, sizeof(held_positions));
+}
+
+static void link_timeout_work_cb(struct k_work *work) {
+    LOG_WRN("No frames from the peripheral for %d ms, releasing its keys",
+            CONFIG_ZMK_SPLIT_WIRED_CENTRAL_LINK_TIMEOUT_MS);
+
+    link_up = false;
+    release_held_positions();
+#if IS_ENABLED(CONFIG_ZMK_SPLIT_WIRED_BEHAVIOR_IDS)
+    // The peripheral may come back with different firmware.
+    behavior_ids_len = 0;
+    behavior_ids_stale = true;
+#endif // IS_ENABLED(CONFIG_ZMK_SPLIT_WIRED_BEHAVIOR_IDS)
+}
+
+static K_WORK_DELAYABLE_DEFINE(link_timeout_work, link_timeout_work_cb);
+
+void zmk_split_wired_handle_frame(enum zmk_split_wired_frame_kind kind, const uint8_t *payload,
+                                  uint8_t len) {
+    const bool was_up = link_up;
+
+    // The peripheral sends heartbeats, so any frame shows the link is up.
+    link_up = true;
+    k_work_reschedule(&link_timeout_work, K_MSEC(CONFIG_ZMK_SPLIT_WIRED_CENTRAL_LINK_TIMEOUT_MS));
+
+    if (!was_up && kind != ZMK_SPLIT_WIRED_FRAME_KIND_HELLO) {
+        LOG_DBG("Peripheral link is up, sending it the current state");
+#if IS_ENABLED(CONFIG_ZMK_SPLIT_WIRED_BEHAVIOR_IDS)
+        behavior_ids_stale = true;
+#endif // IS_ENABLED(CONFIG_ZMK_SPLIT_WIRED_BEHAVIOR_IDS)
+        k_work_submit(&sync_peripheral_work);
+    }
+
+    switch (kind) {
+    case ZMK_SPLIT_WIRED_FRAME_KIND_EVENT: {
+        struct zmk_split_transport_peripheral_event ev = {0};
+        memcpy(&ev, payload, MIN(len, sizeof(ev)));
+
+        if (ev.type == ZMK_SPLIT_TRANSPORT_PERIPHERAL_EVENT_TYPE_KEY_POSITION_EVENT) {
+            const uint8_t position = ev.data.key_position_event.position;
+            WRITE_BIT(held_positions[position / 8], position % 8,
+                      ev.data.key_position_event.pressed);
+        }
+
+        zmk_split_transport_central_peripheral_event_handler(&wired_central, 0, ev);
+        break;
+    }
+    case ZMK_SPLIT_WIRED_FRAME_KIND_HELLO:
+        LOG_DBG("Peripheral started, sending it the current state");
+        // Keys held on the peripheral before it restarted won't be reported released.
+        release_held_positions();
+#if IS_ENABLED(CONFIG_ZMK_SPLIT_WIRED_BEHAVIOR_IDS)
+        behavior_ids_stale = true;
+#endif // IS_ENABLED(CONFIG_ZMK_SPLIT_WIRED_BEHAVIOR_IDS)
+        k_work_submit(&sync_peripheral_work);
+        break;
+    case ZMK_SPLIT_WIRED_FRAME_KIND_HEARTBEAT:
+        break;
+#if IS_ENABLED(CONFIG_ZMK_SPLIT_WIRED_BEHAVIOR_IDS)
+    case ZMK_SPLIT_WIRED_FRAME_KIND_BEHAVIOR_ID:
+        handle_behavior_id(payload, len);
+        break;
+#endif // IS_ENABLED(CONFIG_ZMK_SPLIT_WIRED_BEHAVIOR_IDS)
+#if IS_ENABLED(CONFIG_ZMK_SPLIT_WIRED_BENCHMARK)
+    case ZMK_SPLIT_WIRED_FRAME_KIND_PONG:
+        zmk_split_wired_benchmark_handle_pong(payload, len);
+        break;
+#endif // IS_ENABLED(CONFIG_ZMK_SPLIT_WIRED_BENCHMARK)
+    default:
+        LOG_WRN("Unexpected split frame of kind %d", kind);
+        break;
+    }
+}
+
+static int wired_central_listener_cb(const zmk_event_t *eh) {
+    if (as_zmk_physical_layout_selection_changed(eh)) {
+        k_work_submit(&sync_peripheral_work);
+    }
+    return ZMK_EV_EVENT_BUBBLE;
+}
+
+ZMK_LISTENER(wired_central, wired_central_listener_cb);
+ZMK_SUBSCRIPTION(wired_central, zmk_physical_layout_selection_changed);
+
+static int wired_central_init(void) {
+    // The peripheral may have started first, so don't wait for it to say hello.
+    k_work_submit(&sync_peripheral_work);
+    return 0;
+}
+
+SYS_INIT(wired_central_init, APPLICATION, CONFIG_APPLICATION_INIT_PRIORITY);
@@ -0,0 +1,198 @@
+/*
+ * Copyright (c) 2024 The ZMK Contributors
+ *
+ * SPDX-License-Identifier: MIT
+ */
+
+#include <string.h>
+
+#include <zephyr/init.h>
+#include <zephyr/kernel.h>
+
+#include <zephyr/logging/log.h>
+
+LOG_MODULE_DECLARE(zmk, CONFIG_ZMK_LOG_LEVEL);
+
+#include <drivers/behavior.h>
+#include <zmk/behavior.h>
+#include <zmk/split/transport/peripheral.h>
+
+#include "wired.h"
+
+static size_t event_size(const struct zmk_split_transport_peripheral_event *ev) {
+    const size_t header = offsetof(struct zmk_split_transport_peripheral_event, data);
+
+    switch (ev->type) {
+    case ZMK_SPLIT_TRANSPORT_PERIPHERAL_EVENT_TYPE_KEY_POSITION_EVENT:
+        return header + sizeof(ev->data.key_position_event);
+    case ZMK_SPLIT_TRANSPORT_PERIPHERAL_EVENT_TYPE_SENSOR_EVENT:
+        return header + offsetof(typeof(ev->data.sensor_event), channel_data) +
+               ev->data.sensor_event.channel_data_size * sizeof(struct zmk_sensor_channel_data);
+    case ZMK_SPLIT_TRANSPORT_PERIPHERAL_EVENT_TYPE_INPUT_EVENT:
+        return header + sizeof(ev->data.input_event);
+    default:
+        return sizeof(*ev);
+    }
+}
+
+static int wired_peripheral_report_event(const struct zmk_split_transport_peripheral_event *ev) {
+    return zmk_split_wired_send(ZMK_SPLIT_WIRED_FRAME_KIND_EVENT, ev, event_size(ev));
+}
+
+static const struct zmk_split_transport_peripheral_api wired_peripheral_api = {
+    .report_event = wired_peripheral_report_event,
+};
+
+ZMK_SPLIT_TRANSPORT_PERIPHERAL_REGISTER(wired_peripheral, &wired_peripheral_api);
+
+#if IS_ENABLED(CONFIG_ZMK_SPLIT_WIRED_BEHAVIOR_IDS)
+
+static bool behavior_runs_on_peripheral(const struct device *behavior) {
+    enum behavior_locality locality = BEHAVIOR_LOCALITY_CENTRAL;
+    return behavior_get_locality(behavior, &locality) == 0 &&
+           locality != BEHAVIOR_LOCALITY_CENTRAL;
+}
+
+// Index of the next zmk_behavior_local_id_map entry to send, or -1 if no list is being sent.
+static int next_behavior_id = -1;
+
+static void send_behavior_ids_work_cb(struct k_work *work);
+
+static K_WORK_DELAYABLE_DEFINE(send_behavior_ids_work, send_behavior_ids_work_cb);
+
+// Sends the behavior ID list a frame at a time, waiting for room in the transmit buffer whenever
+// it fills up.
+static void send_behavior_ids_work_cb(struct k_work *work) {
+    uint8_t buf[ZMK_SPLIT_WIRED_MAX_PAYLOAD];
+    struct zmk_split_wired_behavior_id *entry = (struct zmk_split_wired_behavior_id *)buf;
+    int index = 0;
+
+    STRUCT_SECTION_FOREACH(zmk_behavior_local_id_map, item) {
+        if (index++ < next_behavior_id) {
+            continue;
+        }
+
+        const size_t name_len = strlen(item->device->name);
+        if (!device_is_ready(item->device) || !behavior_runs_on_peripheral(item->device) ||
+            sizeof(*entry) + name_len > sizeof(buf)) {
+            next_behavior_id = index;
+            continue;
+        }
+
+        entry->behavior_id = item->local_id;
+        memcpy(entry->name, item->device->name, name_len);
+        if (zmk_split_wired_send(ZMK_SPLIT_WIRED_FRAME_KIND_BEHAVIOR_ID, entry,
+                                 sizeof(*entry) + name_len) < 0) {
+            k_work_reschedule(&send_behavior_ids_work, K_MSEC(1));
+            return;
+        }
+
+        next_behavior_id = index;
+    }
+
+    if (zmk_split_wired_send(ZMK_SPLIT_WIRED_FRAME_KIND_BEHAVIOR_ID, NULL, 0) < 0) {
+        k_work_reschedule(&send_behavior_ids_work, K_MSEC(1));
+        return;
+    }
+
+    next_behavior_id = -1;
+}
+
+static void invoke_behavior_id(const uint8_t *payload, uint8_t len) {
+    struct zmk_split_wired_invoke_behavior_id invoke;
+
+    if (len != sizeof(invoke)) {
+        LOG_WRN("Invoke behavior frame has the wrong length %d", len);
+        return;
+    }
+
+    memcpy(&invoke, payload, sizeof(invoke));
+
+    const struct device *behavior = zmk_behavior_get_device_from_local_id(invoke.behavior_id);
+    if (!behavior || !behavior_runs_on_peripheral(behavior)) {
+        LOG_ERR("No behavior to run with ID %d", invoke.behavior_id);
+        return;
+    }
+
+    struct zmk_behavior_binding binding = {
+        .param1 = invoke.param1,
+        .param2 = invoke.param2,
+        .behavior_dev = behavior->name,
+#if IS_ENABLED(CONFIG_ZMK_BEHAVIOR_DEVICES_IN_BINDINGS)
+        .device = behavior,
+#endif // IS_ENABLED(CONFIG_ZMK_BEHAVIOR_DEVICES_IN_BINDINGS)
+    };
+    struct zmk_behavior_binding_event event = {
+        .position = invoke.position,
+        .timestamp = k_uptime_get(),
+    };
+
+    LOG_DBG("%s with params %d %d: pressed? %d", binding.behavior_dev, binding.param1,
+            binding.param2, invoke.state);
+
+    int err;
+    if (invoke.state > 0) {
+        err = behavior_keymap_binding_pressed(&binding, event);
+    } else {
+        err = behavior_keymap_binding_released(&binding, event);
+    }
+
+    if (err) {
+        LOG_ERR("Failed to invoke behavior %s: %d", binding.behavior_dev, err);
+    }
+}
+
+#endif // IS_ENABLED(CONFIG_ZMK_SPLIT_WIRED_BEHAVIOR_IDS)
+
+void zmk_split_wired_handle_frame(enum zmk_split_wired_frame_kind kind, const uint8_t *payload,
+                                  uint8_t len) {
+    switch (kind) {
+    case ZMK_SPLIT_WIRED_FRAME_KIND_COMMAND: {
+        struct zmk_split_transport_central_command cmd = {0};
+        memcpy(&cmd, payload, MIN(len, sizeof(cmd)));
+        zmk_split_transport_peripheral_command_handler(&wired_peripheral, cmd);
+        break;
+    }
+#if IS_ENABLED(CONFIG_ZMK_SPLIT_WIRED_BEHAVIOR_IDS)
+    case ZMK_SPLIT_WIRED_FRAME_KIND_BEHAVIOR_IDS_REQUEST:
+        // A list that is being sent starts over, since the central has dropped what it received.
+        next_behavior_id = 0;
+        k_work_reschedule(&send_behavior_ids_work, K_NO_WAIT);
+        break;
+    case ZMK_SPLIT_WIRED_FRAME_KIND_INVOKE_BEHAVIOR_ID:
+        invoke_behavior_id(payload, len);
+        break;
+#endif // IS_ENABLED(CONFIG_ZMK_SPLIT_WIRED_BEHAVIOR_IDS)
+    default:
+        LOG_WRN("Unexpected split frame of kind %d", kind);
+        break;
+    }
+}
+
+// Asks the central for the selected physical layout and other state it may have sent before this
+// half was listening.
+static void send_hello_work_cb(struct k_work *work) {
+    zmk_split_wired_send(ZMK_SPLIT_WIRED_FRAME_KIND_HELLO, NULL, 0);
+}
+
+static K_WORK_DEFINE(send_hello_work, send_hello_work_cb);
+
+static void heartbeat_work_cb(struct k_work *work);
+
+static K_WORK_DELAYABLE_DEFINE(heartbeat_work, heartbeat_work_cb);
+
+// Lets the central tell a quiet link from a broken one, so it can release keys held on this half
+// if the cable is unplugged.
+static void heartbeat_work_cb(struct k_work *work) {
+    zmk_split_wired_send(ZMK_SPLIT_WIRED_FRAME_KIND_HEARTBEAT, NULL, 0);
+    k_work_schedule(&heartbeat_work, K_MSEC(CONFIG_ZMK_SPLIT_WIRED_HEARTBEAT_PERIOD_MS));
+}
+
+static int wired_peripheral_init(void) {
+    // Sent from the work queue so it goes out after the UART is set up.
+    k_work_submit(&send_hello_work);
+    k_work_schedule(&heartbeat_work, K_MSEC(CONFIG_ZMK_SPLIT_WIRED_HEARTBEAT_PERIOD_MS));
+    return 0;
+}
+
+SYS_INIT(wired_peripheral_init, APPLICATION, CONFIG_APPLICATION_INIT_PRIORITY);
@@ -0,0 +1,295 @@
+/*
+ * Copyright (c) 2024 The ZMK Contributors
+ *
+ * SPDX-License-Identifier: MIT
+ */
+
+#include <string.h>
+
+#include <zephyr/init.h>
+#include <zephyr/kernel.h>
+#include <zephyr/device.h>
+#include <zephyr/drivers/uart.h>
+#include <zephyr/sys/byteorder.h>
+#include <zephyr/sys/crc.h>
+#include <zephyr/sys/ring_buffer.h>
+
+#include <zephyr/logging/log.h>
+
+LOG_MODULE_DECLARE(zmk, CONFIG_ZMK_LOG_LEVEL);
+
+#include "wired.h"
+
+static const struct device *const uart = DEVICE_DT_GET(DT_CHOSEN(zmk_split_uart));
+
+RING_BUF_DECLARE(rx_buf, CONFIG_ZMK_SPLIT_WIRED_RX_BUF_SIZE);
+
+// Received bytes that may hold the start of a frame, always starting at a start byte once parsed.
+static uint8_t rx_frame[ZMK_SPLIT_WIRED_MAX_FRAME];
+static size_t rx_frame_len;
+
+static uint16_t frame_crc(const uint8_t *header_and_payload, size_t len) {
+    return crc16_ccitt(0, header_and_payload, len);
+}
+
+static size_t encode_frame(uint8_t *frame, enum zmk_split_wired_frame_kind kind,
+                           const void *payload, uint8_t len) {
+    struct zmk_split_wired_frame_header header = {.kind = kind, .len = len};
+    size_t pos = 0;
+
+    frame[pos++] = ZMK_SPLIT_WIRED_SOF;
+    memcpy(&frame[pos], &header, sizeof(header));
+    pos += sizeof(header);
+    if (len > 0) {
+        memcpy(&frame[pos], payload, len);
+        pos += len;
+    }
+    sys_put_le16(frame_crc(&frame[1], pos - 1), &frame[pos]);
+
+    return pos + sizeof(uint16_t);
+}
+
+#if IS_ENABLED(CONFIG_ZMK_SPLIT_WIRED_UART_MODE_ASYNC)
+
+RING_BUF_DECLARE(tx_buf, CONFIG_ZMK_SPLIT_WIRED_TX_BUF_SIZE);
+
+static struct k_spinlock tx_lock;
+static bool tx_busy;
+
+static uint8_t async_rx_bufs[2][CONFIG_ZMK_SPLIT_WIRED_ASYNC_RX_BUF_SIZE];
+static uint8_t next_async_rx_buf;
+
+// Must be called with tx_lock held. Hands the longest contiguous run of queued bytes to the UART,
+// which sends it with DMA where available.
+static void start_tx(void) {
+    if (tx_busy) {
+        return;
+    }
+
+    uint8_t *data;
+    uint32_t len = ring_buf_get_claim(&tx_buf, &data, CONFIG_ZMK_SPLIT_WIRED_TX_BUF_SIZE);
+    if (len == 0) {
+        return;
+    }
+
+    int err = uart_tx(uart, data, len, SYS_FOREVER_US);
+    if (err < 0) {
+        LOG_ERR("Failed to start UART transmit (err %d)", err);
+        ring_buf_get_finish(&tx_buf, 0);
+        return;
+    }
+
+    tx_busy = true;
+}
+
+static int send_frame(const uint8_t *frame, size_t len) {
+    k_spinlock_key_t key = k_spin_lock(&tx_lock);
+
+    if (ring_buf_space_get(&tx_buf) < len) {
+        k_spin_unlock(&tx_lock, key);
+        return -ENOMEM;
+    }
+
+    ring_buf_put(&tx_buf, frame, len);
+    start_tx();
+
+    k_spin_unlock(&tx_lock, key);
+
+    return 0;
+}
+
+#else
+
+static K_MUTEX_DEFINE(tx_mutex);
+
+static int send_frame(const uint8_t *frame, size_t len) {
+    k_mutex_lock(&tx_mutex, K_FOREVER);
+
+    for (size_t i = 0; i < len; i++) {
+        uart_poll_out(uart, frame[i]);
+    }
+
+    k_mutex_unlock(&tx_mutex);
+
+    return 0;
+}
+
+#endif // IS_ENABLED(CONFIG_ZMK_SPLIT_WIRED_UART_MODE_ASYNC)
+
+int zmk_split_wired_send(enum zmk_split_wired_frame_kind kind, const void *payload, uint8_t len) {
+    uint8_t frame[ZMK_SPLIT_WIRED_MAX_FRAME];
+
+    if (len > ZMK_SPLIT_WIRED_MAX_PAYLOAD) {
+        return -EINVAL;
+    }
+
+    int err = send_frame(frame, encode_frame(frame, kind, payload, len));
+    if (err < 0) {
+        LOG_WRN("Dropping split frame of kind %d (err %d)", kind, err);
+    }
+
+    return err;
+}
+
+static void drop_rx_bytes(size_t count) {
+    memmove(rx_frame, &rx_frame[count], rx_frame_len - count);
+    rx_frame_len -= count;
+}
+
+// Handles the frame at the start of the receive buffer, if it's complete. Returns true if the
+// buffer changed and may hold another frame.
+static bool parse_rx_frame(void) {
+    uint8_t *sof = memchr(rx_frame, ZMK_SPLIT_WIRED_SOF, rx_frame_len);
+    if (!sof) {
+        rx_frame_len = 0;
+        return false;
+    }
+
+    drop_rx_bytes(sof - rx_frame);
+
+    if (rx_frame_len < 1 + sizeof(struct zmk_split_wired_frame_header)) {
+        return false;
+    }
+
+    struct zmk_split_wired_frame_header header;
+    memcpy(&header, &rx_frame[1], sizeof(header));
+
+    if (header.len > ZMK_SPLIT_WIRED_MAX_PAYLOAD) {
+        LOG_WRN("Dropping split frame with bad length %d", header.len);
+        drop_rx_bytes(1);
+        return true;
+    }
+
+    const size_t crc_pos = 1 + sizeof(header) + header.len;
+    if (rx_frame_len < crc_pos + sizeof(uint16_t)) {
+        return false;
+    }
+
+    if (sys_get_le16(&rx_frame[crc_pos]) != frame_crc(&rx_frame[1], crc_pos - 1)) {
+        LOG_WRN("Dropping split frame with bad CRC");
+        drop_rx_bytes(1);
+        return true;
+    }
+
+    const uint8_t *payload = &rx_frame[1 + sizeof(header)];
+    if (header.kind == ZMK_SPLIT_WIRED_FRAME_KIND_PING) {
+        zmk_split_wired_send(ZMK_SPLIT_WIRED_FRAME_KIND_PONG, payload, header.len);
+    } else {
+        zmk_split_wired_handle_frame(header.kind, payload, header.len);
+    }
+
+    drop_rx_bytes(crc_pos + sizeof(uint16_t));
+    return true;
+}
+
+static void process_rx(void) {
+    do {
+        rx_frame_len += ring_buf_get(&rx_buf, &rx_frame[rx_frame_len],
+                                     sizeof(rx_frame) - rx_frame_len);
+
+        while (parse_rx_frame()) {
+        }
+    } while (!ring_buf_is_empty(&rx_buf));
+}
+
+#if IS_ENABLED(CONFIG_ZMK_SPLIT_WIRED_UART_MODE_ASYNC)
+
+static void rx_work_cb(struct k_work *work) { process_rx(); }
+
+static K_WORK_DEFINE(rx_work, rx_work_cb);
+
+static int enable_async_rx(void) {
+    int err = uart_rx_enable(uart, async_rx_bufs[next_async_rx_buf], sizeof(async_rx_bufs[0]),
+                             CONFIG_ZMK_SPLIT_WIRED_ASYNC_RX_TIMEOUT_US);
+    next_async_rx_buf ^= 1;
+    return err;
+}
+
+static void uart_callback(const struct device *dev, struct uart_event *evt, void *user_data) {
+    switch (evt->type) {
+    case UART_TX_DONE:
+    case UART_TX_ABORTED: {
+        k_spinlock_key_t key = k_spin_lock(&tx_lock);
+        ring_buf_get_finish(&tx_buf, evt->data.tx.len);
+        tx_busy = false;
+        start_tx();
+        k_spin_unlock(&tx_lock, key);
+        break;
+    }
+    case UART_RX_RDY:
+        if (ring_buf_put(&rx_buf, &evt->data.rx.buf[evt->data.rx.offset], evt->data.rx.len) <
+            evt->data.rx.len) {
+            LOG_WRN("Dropped received split bytes, bump CONFIG_ZMK_SPLIT_WIRED_RX_BUF_SIZE");
+        }
+        k_work_submit(&rx_work);
+        break;
+    case UART_RX_BUF_REQUEST:
+        uart_rx_buf_rsp(uart, async_rx_bufs[next_async_rx_buf], sizeof(async_rx_bufs[0]));
+        next_async_rx_buf ^= 1;
+        break;
+    case UART_RX_STOPPED:
+        LOG_WRN("Split UART receive stopped (reason %d)", evt->data.rx_stop.reason);
+        break;
+    case UART_RX_DISABLED:
+        // Receiving stops after errors such as a framing error from a half that is resetting.
+        enable_async_rx();
+        break;
+    default:
+        break;
+    }
+}
+
+static int start_rx(void) {
+    int err = uart_callback_set(uart, uart_callback, NULL);
+    if (err < 0) {
+        LOG_ERR("Failed to set the split UART callback (err %d)", err);
+        return err;
+    }
+
+    return enable_async_rx();
+}
+
+#else
+
+static void rx_poll_work_cb(struct k_work *work);
+
+static K_WORK_DELAYABLE_DEFINE(rx_poll_work, rx_poll_work_cb);
+
+static void rx_poll_work_cb(struct k_work *work) {
+    uint8_t *data;
+    uint32_t claimed = ring_buf_put_claim(&rx_buf, &data, CONFIG_ZMK_SPLIT_WIRED_RX_BUF_SIZE);
+    uint32_t len = 0;
+
+    while (len < claimed && uart_poll_in(uart, &data[len]) == 0) {
+        len++;
+    }
+
+    ring_buf_put_finish(&rx_buf, len);
+
+    if (len > 0) {
+        process_rx();
+    }
+
+    // Check again right away if the claim was filled, since more bytes may be waiting.
+    k_work_schedule(&rx_poll_work, len == claimed && claimed > 0
+                                       ? K_NO_WAIT
+                                       : K_MSEC(CONFIG_ZMK_SPLIT_WIRED_POLLING_RX_PERIOD_MS));
+}
+
+static int start_rx(void) {
+    k_work_schedule(&rx_poll_work, K_NO_WAIT);
+    return 0;
+}
+
+#endif // IS_ENABLED(CONFIG_ZMK_SPLIT_WIRED_UART_MODE_ASYNC)
+
+static int zmk_split_wired_init(void) {
+    if (!device_is_ready(uart)) {
+        LOG_ERR("Split UART device is not ready");
+        return -ENODEV;
+    }
+
+    return start_rx();
+}
+
+SYS_INIT(zmk_split_wired_init, APPLICATION, CONFIG_APPLICATION_INIT_PRIORITY);
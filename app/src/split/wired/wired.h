@@ -0,0 +1,90 @@
+/*
+ * Copyright (c) 2024 The ZMK Contributors
+ *
+ * SPDX-License-Identifier: MIT
+ */
+
+#pragma once
+
+#include <zephyr/sys/util.h>
+
+#include <zmk/split/transport/types.h>
+
+/*
+ * Every frame is a start byte, the frame header, up to ZMK_SPLIT_WIRED_MAX_PAYLOAD bytes of payload
+ * and a little-endian CRC-16/CCITT of the header and payload. A receiver that sees a bad length or
+ * CRC drops the start byte and looks for the next one, so it resynchronizes after line noise or a
+ * half received frame. Payloads are the packed transport structs, truncated to the part that is
+ * used by their type, in the byte order of the two halves, which is little-endian on all supported
+ * SoCs.
+ */
+#define ZMK_SPLIT_WIRED_SOF 0xF5
+
+enum zmk_split_wired_frame_kind {
+    // A zmk_split_transport_peripheral_event, sent by the peripheral.
+    ZMK_SPLIT_WIRED_FRAME_KIND_EVENT,
+    // A zmk_split_transport_central_command, sent by the central.
+    ZMK_SPLIT_WIRED_FRAME_KIND_COMMAND,
+    // Sent by the peripheral when it starts, so the central can send it the current state.
+    ZMK_SPLIT_WIRED_FRAME_KIND_HELLO,
+    // Answered by a PONG frame with the same payload.
+    ZMK_SPLIT_WIRED_FRAME_KIND_PING,
+    ZMK_SPLIT_WIRED_FRAME_KIND_PONG,
+    // Sent by the peripheral every CONFIG_ZMK_SPLIT_WIRED_HEARTBEAT_PERIOD_MS, so the central can
+    // tell when the link is down.
+    ZMK_SPLIT_WIRED_FRAME_KIND_HEARTBEAT,
+    // Sent by the central to ask for the peripheral's behavior IDs.
+    ZMK_SPLIT_WIRED_FRAME_KIND_BEHAVIOR_IDS_REQUEST,
+    // A zmk_split_wired_behavior_id, sent by the peripheral for each behavior the central may run
+    // on it. An empty frame ends the list.
+    ZMK_SPLIT_WIRED_FRAME_KIND_BEHAVIOR_ID,
+    // A zmk_split_wired_invoke_behavior_id, sent by the central.
+    ZMK_SPLIT_WIRED_FRAME_KIND_INVOKE_BEHAVIOR_ID,
+};
+
+struct zmk_split_wired_frame_header {
+    uint8_t kind;
+    uint8_t len;
+} __packed;
+
+// The name is not NUL terminated, and fills the rest of the frame.
+struct zmk_split_wired_behavior_id {
+    uint16_t behavior_id;
+    char name[];
+} __packed;
+
+struct zmk_split_wired_invoke_behavior_id {
+    uint32_t param1;
+    uint32_t param2;
+    uint8_t position;
+    uint8_t state;
+    uint16_t behavior_id;
+} __packed;
+
+#define ZMK_SPLIT_WIRED_MAX_PAYLOAD                                                                \
+    MAX(sizeof(struct zmk_split_transport_peripheral_event),                                       \
+        sizeof(struct zmk_split_transport_central_command))
+
+#define ZMK_SPLIT_WIRED_MAX_FRAME                                                                  \
+    (1 + sizeof(struct zmk_split_wired_frame_header) + ZMK_SPLIT_WIRED_MAX_PAYLOAD + 2)
+
+/**
+ * @brief Queue a frame to send to the other half.
+ *
+ * @retval -ENOMEM if the transmit buffer doesn't have room for the frame.
+ */
+int zmk_split_wired_send(enum zmk_split_wired_frame_kind kind, const void *payload, uint8_t len);
+
+/**
+ * @brief Handle a received frame with a valid CRC. Implemented by the central or peripheral half
+ * of the transport, and called from the system work queue. PING frames are answered before this is
+ * called.
+ */
+void zmk_split_wired_handle_frame(enum zmk_split_wired_frame_kind kind, const uint8_t *payload,
+                                  uint8_t len);
+
+#if IS_ENABLED(CONFIG_ZMK_SPLIT_WIRED_BENCHMARK)
+
+void zmk_split_wired_benchmark_handle_pong(const uint8_t *payload, uint8_t len);
+
+#endif // IS_ENABLED(CONFIG_ZMK_SPLIT_WIRED_BENCHMARK)
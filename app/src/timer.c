@@ -0,0 +1,191 @@
+/*
+ * Copyright (c) 2024 The ZMK Contributors
+ *
+ * SPDX-License-Identifier: MIT
+ */
+
+#include <zephyr/kernel.h>
+#include <zephyr/spinlock.h>
+#include <zephyr/sys/dlist.h>
+#include <zephyr/sys/util.h>
+
+#include <zmk/endpoints.h>
+#include <zmk/timer.h>
+
+#define WHEEL_SLOTS CONFIG_ZMK_TIMER_WHEEL_SLOTS
+
+BUILD_ASSERT(IS_POWER_OF_TWO(WHEEL_SLOTS), "CONFIG_ZMK_TIMER_WHEEL_SLOTS must be a power of two");
+
+// Each slot holds the timers whose deadline in milliseconds maps to it. A slot may also hold
+// timers that are one or more turns of the wheel away, which are skipped until they are due.
+static sys_dlist_t wheel[WHEEL_SLOTS];
+
+static struct k_spinlock lock;
+static uint32_t pending_count;
+// Deadline the work item is scheduled for, or INT64_MAX if it isn't scheduled.
+static int64_t armed_deadline = INT64_MAX;
+// Uptime at which the wheel was last serviced. Slots up to and including this time are empty of
+// expired timers.
+static int64_t serviced_until;
+
+static void timer_wheel_work_cb(struct k_work *work);
+
+static K_WORK_DELAYABLE_DEFINE(wheel_work, timer_wheel_work_cb);
+
+static inline sys_dlist_t *slot_for(int64_t deadline) {
+    return &wheel[deadline & (WHEEL_SLOTS - 1)];
+}
+
+// Must be called with the lock held.
+static int64_t next_deadline(void) {
+    if (pending_count == 0) {
+        return INT64_MAX;
+    }
+
+    // No deadline is earlier than the first slot that hasn't been serviced, including overdue ones
+    // restarted by a handler while the clock moved on. Most timers are less than one turn of the
+    // wheel past that, so look for the first slot with a timer due in this turn before falling back
+    // to checking every timer.
+    for (int64_t tick = serviced_until + 1; tick <= serviced_until + WHEEL_SLOTS; tick++) {
+        struct zmk_timer *timer;
+        SYS_DLIST_FOR_EACH_CONTAINER(slot_for(tick), timer, node) {
+            if (timer->deadline == tick) {
+                return tick;
+            }
+        }
+    }
+
+    int64_t deadline = INT64_MAX;
+    for (int i = 0; i < WHEEL_SLOTS; i++) {
+        struct zmk_timer *timer;
+        SYS_DLIST_FOR_EACH_CONTAINER(&wheel[i], timer, node) {
+            deadline = MIN(deadline, timer->deadline);
+        }
+    }
+
+    return deadline;
+}
+
+// Must be called with the lock held.
+static void arm(int64_t deadline, int64_t now) {
+    if (deadline == armed_deadline) {
+        return;
+    }
+
+    if (deadline == INT64_MAX) {
+        k_work_cancel_delayable(&wheel_work);
+    } else {
+        k_work_reschedule(&wheel_work, K_MSEC(MAX(deadline - now, 0)));
+    }
+
+    armed_deadline = deadline;
+}
+
+static void timer_wheel_work_cb(struct k_work *work) {
+    int64_t now = k_uptime_get();
+    sys_dlist_t expired;
+
+    sys_dlist_init(&expired);
+
+    // Timers that expire together are handled as one report transaction.
+    zmk_endpoints_report_transaction_begin();
+
+    k_spinlock_key_t key = k_spin_lock(&lock);
+
+    armed_deadline = INT64_MAX;
+
+    // Collect the expired timers in deadline order. If the wheel wasn't serviced for a full turn,
+    // every slot needs to be checked.
+    int64_t start = MAX(serviced_until + 1, now - WHEEL_SLOTS + 1);
+    for (int64_t tick = start; tick <= now; tick++) {
+        struct zmk_timer *timer, *tmp;
+        SYS_DLIST_FOR_EACH_CONTAINER_SAFE(slot_for(tick), timer, tmp, node) {
+            if (timer->deadline <= now) {
+                sys_dlist_remove(&timer->node);
+                sys_dlist_append(&expired, &timer->node);
+            }
+        }
+    }
+
+    serviced_until = now;
+
+    // Timers are removed one at a time so a handler can stop or restart any other expired timer.
+    sys_dnode_t *node;
+    while ((node = sys_dlist_get(&expired)) != NULL) {
+        struct zmk_timer *timer = CONTAINER_OF(node, struct zmk_timer, node);
+        pending_count--;
+
+        k_spin_unlock(&lock, key);
+        timer->handler(timer);
+        key = k_spin_lock(&lock);
+    }
+
+    arm(next_deadline(), k_uptime_get());
+
+    k_spin_unlock(&lock, key);
+
+    zmk_endpoints_report_transaction_end();
+}
+
+void zmk_timer_init(struct zmk_timer *timer, zmk_timer_handler_t handler) {
+    sys_dnode_init(&timer->node);
+    timer->deadline = 0;
+    timer->handler = handler;
+}
+
+void zmk_timer_start_at(struct zmk_timer *timer, int64_t deadline) {
+    k_spinlock_key_t key = k_spin_lock(&lock);
+
+    if (sys_dnode_is_linked(&timer->node)) {
+        sys_dlist_remove(&timer->node);
+    } else {
+        pending_count++;
+    }
+
+    // Expired deadlines go in the next slot to be serviced.
+    timer->deadline = MAX(deadline, serviced_until + 1);
+    sys_dlist_append(slot_for(timer->deadline), &timer->node);
+
+    if (timer->deadline < armed_deadline) {
+        arm(timer->deadline, k_uptime_get());
+    }
+
+    k_spin_unlock(&lock, key);
+}
+
+bool zmk_timer_stop(struct zmk_timer *timer) {
+    k_spinlock_key_t key = k_spin_lock(&lock);
+    bool pending = sys_dnode_is_linked(&timer->node);
+
+    if (pending) {
+        sys_dlist_remove(&timer->node);
+        pending_count--;
+    }
+
+    // The work item is left scheduled if other timers are pending, and re-arms itself for the next
+    // deadline when it runs. That saves rescheduling it every time a key is released before its
+    // hold-tap or combo timeout.
+    if (pending_count == 0) {
+        arm(INT64_MAX, 0);
+    }
+
+    k_spin_unlock(&lock, key);
+
+    return pending;
+}
+
+bool zmk_timer_is_pending(const struct zmk_timer *timer) {
+    return sys_dnode_is_linked(&timer->node);
+}
+
+static int zmk_timer_wheel_init(void) {
+    for (int i = 0; i < WHEEL_SLOTS; i++) {
+        sys_dlist_init(&wheel[i]);
+    }
+
+    serviced_until = k_uptime_get();
+
+    return 0;
+}
+
+SYS_INIT(zmk_timer_wheel_init, PRE_KERNEL_1, CONFIG_KERNEL_INIT_PRIORITY_DEFAULT);
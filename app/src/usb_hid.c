@@ -6,13 +6,14 @@
 
 #include <zephyr/device.h>
 #include <zephyr/init.h>
-
 #include <zephyr/usb/usb_device.h>
 #include <zephyr/usb/class/usb_hid.h>
 
 #include <zmk/usb.h>
+#include <zmk/usb_hid_queue.h>
 #include <zmk/hid.h>
 #include <zmk/keymap.h>
+#include <zmk/latency_trace.h>
 
 #if IS_ENABLED(CONFIG_ZMK_POINTING_SMOOTH_SCROLLING)
 #include <zmk/pointing/resolution_multipliers.h>
@@ -28,9 +29,11 @@ LOG_MODULE_DECLARE(zmk, CONFIG_ZMK_LOG_LEVEL);
 
 static const struct device *hid_dev;
 
-static K_SEM_DEFINE(hid_sem, 1, 1);
+static int write_report(const uint8_t *report, size_t len) {
+    return hid_int_ep_write(hid_dev, report, len, NULL);
+}
 
-static void in_ready_cb(const struct device *dev) { k_sem_give(&hid_sem); }
+static void in_ready_cb(const struct device *dev) { zmk_usb_hid_queue_transfer_done(); }
 
 #define HID_GET_REPORT_TYPE_MASK 0xff00
 #define HID_GET_REPORT_ID_MASK 0x00ff
@@ -182,7 +185,7 @@ static const struct hid_ops ops = {
     .set_report = set_report_cb,
 };
 
-static int zmk_usb_hid_send_report(const uint8_t *report, size_t len) {
+static int zmk_usb_hid_send_report(uint8_t report_id, const uint8_t *report, size_t len) {
     switch (zmk_usb_get_status()) {
     case USB_DC_SUSPEND:
         return usb_wakeup_request();
@@ -190,23 +193,24 @@ static int zmk_usb_hid_send_report(const uint8_t *report, size_t len) {
     case USB_DC_RESET:
     case USB_DC_DISCONNECTED:
     case USB_DC_UNKNOWN:
+        // Transfers in progress won't complete, and the host starts from a clean state.
+        zmk_usb_hid_queue_reset();
         return -ENODEV;
     default:
-        k_sem_take(&hid_sem, K_MSEC(30));
-        int err = hid_int_ep_write(hid_dev, report, len, NULL);
-
-        if (err) {
-            k_sem_give(&hid_sem);
-        }
-
-        return err;
+        zmk_latency_trace_record(ZMK_LATENCY_TRACE_STAGE_TRANSPORT, "usb");
+        return zmk_usb_hid_queue_add(report_id, report, len);
     }
 }
 
 int zmk_usb_hid_send_keyboard_report(void) {
     size_t len;
     uint8_t *report = get_keyboard_report(&len);
-    return zmk_usb_hid_send_report(report, len);
+#if IS_ENABLED(CONFIG_ZMK_USB_BOOT)
+    if (hid_protocol != HID_PROTOCOL_REPORT) {
+        return zmk_usb_hid_send_report(0, report, len);
+    }
+#endif /* IS_ENABLED(CONFIG_ZMK_USB_BOOT) */
+    return zmk_usb_hid_send_report(ZMK_HID_REPORT_ID_KEYBOARD, report, len);
 }
 
 int zmk_usb_hid_send_consumer_report(void) {
@@ -217,7 +221,7 @@ int zmk_usb_hid_send_consumer_report(void) {
 #endif /* IS_ENABLED(CONFIG_ZMK_USB_BOOT) */
 
     struct zmk_hid_consumer_report *report = zmk_hid_get_consumer_report();
-    return zmk_usb_hid_send_report((uint8_t *)report, sizeof(*report));
+    return zmk_usb_hid_send_report(ZMK_HID_REPORT_ID_CONSUMER, (uint8_t *)report, sizeof(*report));
 }
 
 #if IS_ENABLED(CONFIG_ZMK_POINTING)
@@ -229,7 +233,7 @@ int zmk_usb_hid_send_mouse_report() {
 #endif /* IS_ENABLED(CONFIG_ZMK_USB_BOOT) */
 
     struct zmk_hid_mouse_report *report = zmk_hid_get_mouse_report();
-    return zmk_usb_hid_send_report((uint8_t *)report, sizeof(*report));
+    return zmk_usb_hid_send_report(ZMK_HID_REPORT_ID_MOUSE, (uint8_t *)report, sizeof(*report));
 }
 #endif // IS_ENABLED(CONFIG_ZMK_POINTING)
 
@@ -240,6 +244,8 @@ static int zmk_usb_hid_init(void) {
         return -EINVAL;
     }
 
+    zmk_usb_hid_queue_init(write_report);
+
     usb_hid_register_device(hid_dev, zmk_hid_report_desc, sizeof(zmk_hid_report_desc), &ops);
 
 #if IS_ENABLED(CONFIG_ZMK_USB_BOOT)
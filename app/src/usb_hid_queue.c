@@ -0,0 +1,214 @@
+/*
+ * Copyright (c) 2024 The ZMK Contributors
+ *
+ * SPDX-License-Identifier: MIT
+ */
+
+#include <zephyr/kernel.h>
+#include <zephyr/logging/log.h>
+#include <zephyr/spinlock.h>
+
+#include <string.h>
+
+#include <zmk/hid.h>
+#include <zmk/usb_hid_queue.h>
+
+LOG_MODULE_DECLARE(zmk, CONFIG_ZMK_LOG_LEVEL);
+
+// Reports are sent from a queue so callers never wait for the host to poll. The head of the queue
+// is the report being transferred, and zmk_usb_hid_queue_transfer_done() starts the next one.
+//
+// The head stays in the queue until the host acknowledges it, since the controller may still be
+// sending it. If the host stops polling, the queue fills up and new reports are dropped until the
+// USB state changes and the queue is reset.
+#define REPORT_QUEUE_SIZE CONFIG_ZMK_USB_HID_REPORT_QUEUE_SIZE
+
+// How long to wait before trying again when the endpoint is busy.
+#define RETRY_DELAY_MS 1
+
+union queued_report_data {
+    struct zmk_hid_keyboard_report keyboard;
+    struct zmk_hid_consumer_report consumer;
+#if IS_ENABLED(CONFIG_ZMK_POINTING)
+    struct zmk_hid_mouse_report mouse;
+#endif // IS_ENABLED(CONFIG_ZMK_POINTING)
+#if IS_ENABLED(CONFIG_ZMK_USB_BOOT)
+    zmk_hid_boot_report_t boot;
+#endif // IS_ENABLED(CONFIG_ZMK_USB_BOOT)
+};
+
+struct queued_report {
+    // Report ID, or 0 for a boot protocol keyboard report, which has no ID.
+    uint8_t report_id;
+    uint8_t len;
+    union queued_report_data data;
+};
+
+static zmk_usb_hid_queue_write_t queue_write;
+
+static struct k_spinlock queue_lock;
+static struct queued_report queue[REPORT_QUEUE_SIZE];
+static uint8_t queue_head;
+static uint8_t queue_len;
+static bool in_flight;
+
+// The last two keyboard and consumer states added to the queue. When the newest report in the queue
+// hasn't been sent yet, a following report of the same type replaces it if the host would see the
+// same transitions from the merged report.
+static struct zmk_hid_keyboard_report_body keyboard_prev, keyboard_last;
+static struct zmk_hid_consumer_report_body consumer_prev, consumer_last;
+
+static int start_next_transfer(void);
+
+static void retry_work_cb(struct k_work *work) { start_next_transfer(); }
+
+static K_WORK_DELAYABLE_DEFINE(retry_work, retry_work_cb);
+
+// Must be called with the queue lock held.
+static void queue_drop_head(void) {
+    queue_head = (queue_head + 1) % REPORT_QUEUE_SIZE;
+    queue_len--;
+    in_flight = false;
+}
+
+static int start_next_transfer(void) {
+    int err = 0;
+
+    while (true) {
+        k_spinlock_key_t key = k_spin_lock(&queue_lock);
+
+        if (in_flight || queue_len == 0) {
+            k_spin_unlock(&queue_lock, key);
+            return err;
+        }
+
+        struct queued_report *report = &queue[queue_head];
+        in_flight = true;
+
+        k_spin_unlock(&queue_lock, key);
+
+        // The head isn't modified while it is in flight, so it can be written without the lock.
+        err = queue_write((const uint8_t *)&report->data, report->len);
+        if (err == 0) {
+            return 0;
+        }
+
+        key = k_spin_lock(&queue_lock);
+
+        if (err == -EAGAIN || err == -EBUSY) {
+            // The report is still queued, so it isn't lost. Leave it at the head and try again
+            // once the endpoint has had time to free up.
+            in_flight = false;
+            k_spin_unlock(&queue_lock, key);
+            k_work_reschedule(&retry_work, K_MSEC(RETRY_DELAY_MS));
+            return 0;
+        }
+
+        LOG_WRN("Dropping USB HID report %d that failed to send (%d)", report->report_id, err);
+        queue_drop_head();
+
+        k_spin_unlock(&queue_lock, key);
+    }
+}
+
+// Must be called with the queue lock held.
+static bool can_replace_tail(const struct queued_report *tail, uint8_t report_id,
+                             const uint8_t *report) {
+    if (tail->report_id != report_id || (in_flight && queue_len == 1)) {
+        return false;
+    }
+
+    switch (report_id) {
+    case ZMK_HID_REPORT_ID_KEYBOARD:
+        return zmk_hid_keyboard_report_can_merge(
+            &keyboard_prev, &keyboard_last,
+            &((const struct zmk_hid_keyboard_report *)report)->body);
+    case ZMK_HID_REPORT_ID_CONSUMER:
+        return zmk_hid_consumer_report_can_merge(
+            &consumer_prev, &consumer_last,
+            &((const struct zmk_hid_consumer_report *)report)->body);
+    default:
+        // Mouse movement is relative, and boot reports are rare enough not to bother.
+        return false;
+    }
+}
+
+// Must be called with the queue lock held.
+static void track_last_queued(uint8_t report_id, const uint8_t *report, bool replaced) {
+    switch (report_id) {
+    case ZMK_HID_REPORT_ID_KEYBOARD:
+        if (!replaced) {
+            keyboard_prev = keyboard_last;
+        }
+        keyboard_last = ((const struct zmk_hid_keyboard_report *)report)->body;
+        break;
+    case ZMK_HID_REPORT_ID_CONSUMER:
+        if (!replaced) {
+            consumer_prev = consumer_last;
+        }
+        consumer_last = ((const struct zmk_hid_consumer_report *)report)->body;
+        break;
+    }
+}
+
+void zmk_usb_hid_queue_init(zmk_usb_hid_queue_write_t write) { queue_write = write; }
+
+int zmk_usb_hid_queue_add(uint8_t report_id, const uint8_t *report, size_t len) {
+    if (len > sizeof(union queued_report_data)) {
+        return -EINVAL;
+    }
+
+    k_spinlock_key_t key = k_spin_lock(&queue_lock);
+
+    struct queued_report *tail =
+        queue_len > 0 ? &queue[(queue_head + queue_len - 1) % REPORT_QUEUE_SIZE] : NULL;
+    bool replace = tail != NULL && can_replace_tail(tail, report_id, report);
+
+    if (!replace) {
+        if (queue_len == REPORT_QUEUE_SIZE) {
+            k_spin_unlock(&queue_lock, key);
+            LOG_WRN("USB HID report queue is full, dropping report %d", report_id);
+            return -ENOMEM;
+        }
+
+        tail = &queue[(queue_head + queue_len) % REPORT_QUEUE_SIZE];
+        queue_len++;
+    }
+
+    tail->report_id = report_id;
+    tail->len = len;
+    memcpy(&tail->data, report, len);
+    track_last_queued(report_id, report, replace);
+
+    k_spin_unlock(&queue_lock, key);
+
+    return start_next_transfer();
+}
+
+void zmk_usb_hid_queue_transfer_done(void) {
+    k_spinlock_key_t key = k_spin_lock(&queue_lock);
+
+    if (in_flight) {
+        queue_drop_head();
+    }
+
+    k_spin_unlock(&queue_lock, key);
+
+    start_next_transfer();
+}
+
+void zmk_usb_hid_queue_reset(void) {
+    k_work_cancel_delayable(&retry_work);
+
+    k_spinlock_key_t key = k_spin_lock(&queue_lock);
+
+    queue_head = 0;
+    queue_len = 0;
+    in_flight = false;
+    memset(&keyboard_prev, 0, sizeof(keyboard_prev));
+    memset(&keyboard_last, 0, sizeof(keyboard_last));
+    memset(&consumer_prev, 0, sizeof(consumer_prev));
+    memset(&consumer_last, 0, sizeof(consumer_last));
+
+    k_spin_unlock(&queue_lock, key);
+}
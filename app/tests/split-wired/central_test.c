@@ -0,0 +1,80 @@
+/*
+ * Copyright (c) 2024 The ZMK Contributors
+ *
+ * SPDX-License-Identifier: MIT
+ */
+
+#include <zephyr/init.h>
+#include <zephyr/kernel.h>
+#include <zephyr/logging/log.h>
+
+#include "wired.h"
+
+LOG_MODULE_DECLARE(zmk, CONFIG_ZMK_LOG_LEVEL);
+
+#define TEST_HEARTBEATS 6
+
+enum test_step {
+    TEST_STEP_PRESS_BEFORE_RESTART,
+    TEST_STEP_HELLO,
+    TEST_STEP_PRESS_BEFORE_UNPLUG,
+    TEST_STEP_HEARTBEAT,
+    TEST_STEP_UNPLUG,
+};
+
+static enum test_step step;
+static int heartbeats;
+
+static void test_step_work_cb(struct k_work *work);
+
+static K_WORK_DELAYABLE_DEFINE(test_step_work, test_step_work_cb);
+
+static void send_key_position(uint8_t position, bool pressed) {
+    struct zmk_split_transport_peripheral_event ev = {
+        .type = ZMK_SPLIT_TRANSPORT_PERIPHERAL_EVENT_TYPE_KEY_POSITION_EVENT,
+        .data.key_position_event = {.position = position, .pressed = pressed ? 1 : 0},
+    };
+
+    zmk_split_wired_handle_frame(ZMK_SPLIT_WIRED_FRAME_KIND_EVENT, (const uint8_t *)&ev,
+                                 sizeof(ev));
+}
+
+// Each step hands the central the frames a peripheral would send, as if they came over the UART.
+static void test_step_work_cb(struct k_work *work) {
+    switch (step) {
+    case TEST_STEP_PRESS_BEFORE_RESTART:
+        LOG_DBG("press position 0, then restart the peripheral");
+        send_key_position(0, true);
+        step = TEST_STEP_HELLO;
+        break;
+    case TEST_STEP_HELLO:
+        zmk_split_wired_handle_frame(ZMK_SPLIT_WIRED_FRAME_KIND_HELLO, NULL, 0);
+        step = TEST_STEP_PRESS_BEFORE_UNPLUG;
+        break;
+    case TEST_STEP_PRESS_BEFORE_UNPLUG:
+        LOG_DBG("press position 1, hold it with heartbeats, then unplug the peripheral");
+        send_key_position(1, true);
+        step = TEST_STEP_HEARTBEAT;
+        break;
+    case TEST_STEP_HEARTBEAT:
+        zmk_split_wired_handle_frame(ZMK_SPLIT_WIRED_FRAME_KIND_HEARTBEAT, NULL, 0);
+        if (++heartbeats < TEST_HEARTBEATS) {
+            break;
+        }
+
+        LOG_DBG("unplugged after %d heartbeats", heartbeats);
+        step = TEST_STEP_UNPLUG;
+        return;
+    default:
+        return;
+    }
+
+    k_work_reschedule(&test_step_work, K_MSEC(CONFIG_ZMK_SPLIT_WIRED_HEARTBEAT_PERIOD_MS));
+}
+
+static int split_wired_central_test_init(void) {
+    k_work_reschedule(&test_step_work, K_MSEC(100));
+    return 0;
+}
+
+SYS_INIT(split_wired_central_test_init, APPLICATION, CONFIG_APPLICATION_INIT_PRIORITY);
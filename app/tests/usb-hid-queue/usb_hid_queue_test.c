@@ -0,0 +1,118 @@
+/*
+ * Copyright (c) 2024 The ZMK Contributors
+ *
+ * SPDX-License-Identifier: MIT
+ */
+
+#include <zephyr/init.h>
+#include <zephyr/kernel.h>
+#include <zephyr/logging/log.h>
+
+#include <zmk/hid.h>
+#include <zmk/usb_hid_queue.h>
+
+LOG_MODULE_DECLARE(zmk, CONFIG_ZMK_LOG_LEVEL);
+
+BUILD_ASSERT(IS_ENABLED(CONFIG_ZMK_HID_REPORT_TYPE_HKRO),
+             "The USB HID queue test writes keys as HKRO reports");
+
+// Errors for the mock endpoint to return from its next writes, after which writes succeed.
+static int write_errors[2];
+static size_t write_errors_len;
+static size_t write_errors_used;
+
+static int test_write(const uint8_t *data, size_t len) {
+    const int err = write_errors_used < write_errors_len ? write_errors[write_errors_used++] : 0;
+
+    switch (data[0]) {
+    case ZMK_HID_REPORT_ID_KEYBOARD: {
+        const struct zmk_hid_keyboard_report *report = (const struct zmk_hid_keyboard_report *)data;
+        LOG_DBG("keyboard 0x%02X 0x%02X returns %d", report->body.keys[0], report->body.keys[1],
+                err);
+        break;
+    }
+    case ZMK_HID_REPORT_ID_CONSUMER: {
+        const struct zmk_hid_consumer_report *report = (const struct zmk_hid_consumer_report *)data;
+        LOG_DBG("consumer 0x%02X returns %d", report->body.keys[0], err);
+        break;
+    }
+    default:
+        LOG_DBG("report %d returns %d", data[0], err);
+        break;
+    }
+
+    return err;
+}
+
+static void fail_next_write(int err) { write_errors[write_errors_len++] = err; }
+
+static void test_begin(const char *name) {
+    zmk_usb_hid_queue_reset();
+    write_errors_len = 0;
+    write_errors_used = 0;
+
+    LOG_DBG("%s", name);
+}
+
+static void add_keyboard(uint8_t key0, uint8_t key1) {
+    struct zmk_hid_keyboard_report report = {.report_id = ZMK_HID_REPORT_ID_KEYBOARD};
+
+    report.body.keys[0] = key0;
+    report.body.keys[1] = key1;
+    zmk_usb_hid_queue_add(report.report_id, (const uint8_t *)&report, sizeof(report));
+}
+
+static void add_consumer(uint8_t key) {
+    struct zmk_hid_consumer_report report = {.report_id = ZMK_HID_REPORT_ID_CONSUMER};
+
+    report.body.keys[0] = key;
+    zmk_usb_hid_queue_add(report.report_id, (const uint8_t *)&report, sizeof(report));
+}
+
+static int usb_hid_queue_test(void) {
+    zmk_usb_hid_queue_init(test_write);
+
+    // Reports wait for the one in flight, and are sent in order.
+    test_begin("in order");
+    add_keyboard(0x04, 0x00);
+    add_consumer(0xE9);
+    zmk_usb_hid_queue_transfer_done();
+    zmk_usb_hid_queue_transfer_done();
+
+    // A queued release is replaced by a following release, but the report in flight isn't.
+    test_begin("merged releases");
+    add_keyboard(0x04, 0x05);
+    add_keyboard(0x00, 0x05);
+    add_keyboard(0x00, 0x00);
+    zmk_usb_hid_queue_transfer_done();
+    zmk_usb_hid_queue_transfer_done();
+
+    // A busy endpoint keeps the report at the head and tries it again.
+    test_begin("busy endpoint");
+    fail_next_write(-EAGAIN);
+    add_keyboard(0x04, 0x00);
+    k_sleep(K_MSEC(5));
+    zmk_usb_hid_queue_transfer_done();
+
+    // Any other error drops the report, and the queue carries on with the next.
+    test_begin("failed write");
+    add_keyboard(0x04, 0x00);
+    add_consumer(0xE9);
+    fail_next_write(-EIO);
+    zmk_usb_hid_queue_transfer_done();
+    add_keyboard(0x00, 0x00);
+    zmk_usb_hid_queue_transfer_done();
+
+    // A report the host takes a long time to acknowledge is never dropped while in flight.
+    test_begin("slow host");
+    add_keyboard(0x04, 0x00);
+    k_sleep(K_MSEC(50));
+    add_consumer(0xE9);
+    zmk_usb_hid_queue_transfer_done();
+    zmk_usb_hid_queue_transfer_done();
+
+    test_begin("done");
+    return 0;
+}
+
+SYS_INIT(usb_hid_queue_test, APPLICATION, CONFIG_APPLICATION_INIT_PRIORITY);